@@ -100,6 +100,10 @@ void Surge::Debug::stackTraceToStdout(int depth)
 #endif
 }
 
+#if SURGE_RT_SAFETY_CHECKS
+thread_local int Surge::Debug::audioThreadScopeDepth{0};
+#endif
+
 static std::atomic<int> lcdepth(0);
 Surge::Debug::LifeCycleToConsole::LifeCycleToConsole(const std::string &st) : s(st)
 {
@@ -55,6 +55,34 @@ struct TimeBlock
     std::chrono::time_point<std::chrono::high_resolution_clock> start;
 };
 
+#if SURGE_RT_SAFETY_CHECKS
+/*
+ * In builds with SURGE_RT_SAFETY_CHECKS, everything a host calls from its audio thread holds an
+ * AudioThreadScope: SurgeSynthesizer::process(), the note, controller and expression entry
+ * points, externally driven parameter and macro changes, and the WorkerPool tasks a block fans
+ * out to. The test runner's real time safety detector reads the depth from its allocation and
+ * lock hooks to tell audio thread work from everything else.
+ */
+extern thread_local int audioThreadScopeDepth;
+struct AudioThreadScope
+{
+    explicit AudioThreadScope(bool active = true) : active(active)
+    {
+        if (active)
+            audioThreadScopeDepth++;
+    }
+    ~AudioThreadScope()
+    {
+        if (active)
+            audioThreadScopeDepth--;
+    }
+    bool active;
+};
+#define SURGE_AUDIO_THREAD_SCOPE(active) Surge::Debug::AudioThreadScope audioThreadScope(active)
+#else
+#define SURGE_AUDIO_THREAD_SCOPE(active)
+#endif
+
 } // namespace Debug
 } // namespace Surge
 
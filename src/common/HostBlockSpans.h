@@ -0,0 +1,73 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_HOSTBLOCKSPANS_H
+#define SURGE_SRC_COMMON_HOSTBLOCKSPANS_H
+
+#include "globals.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Surge
+{
+/*
+ * Hosts hand us buffers of any length but the synth renders fixed BLOCK_SIZE blocks, so a
+ * host buffer is a run of spans, each the rest of the current synth block or the rest of the
+ * host buffer, whichever is shorter. Since events are all applied when a block starts (see
+ * SurgeSynthesizer::setBlockEventOffset) nothing needs looking at per sample.
+ *
+ * startBlock(frame) is called at each block boundary, with the host frame the block starts
+ * on, and should apply the block's events and run process(). copySpan(frame, blockPos, n)
+ * then moves n samples starting at blockPos of the synth block to the host at frame. When
+ * the host buffer length is a multiple of BLOCK_SIZE and we're block aligned, every span is
+ * a whole block.
+ */
+template <typename StartBlock, typename CopySpan>
+inline void forEachHostBlockSpan(int &blockPos, int nFrames, StartBlock &&startBlock,
+                                 CopySpan &&copySpan)
+{
+    int frame = 0;
+    while (frame < nFrames)
+    {
+        if (blockPos == 0)
+            startBlock(frame);
+
+        auto n = std::min(BLOCK_SIZE - blockPos, nFrames - frame);
+        copySpan(frame, blockPos, n);
+
+        blockPos = (blockPos + n) & (BLOCK_SIZE - 1);
+        frame += n;
+    }
+}
+
+// whole blocks, the common case, get a fixed size copy the compiler can unroll into vector moves
+inline void copyHostSpan(float *to, const float *from, int n)
+{
+    if (n == BLOCK_SIZE)
+        std::memcpy(to, from, BLOCK_SIZE * sizeof(float));
+    else
+        std::memcpy(to, from, n * sizeof(float));
+}
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_HOSTBLOCKSPANS_H
@@ -23,25 +23,57 @@
 #ifndef SURGE_SRC_COMMON_MEMORYPOOL_H
 #define SURGE_SRC_COMMON_MEMORYPOOL_H
 
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <functional>
+
+#include "SPSCQueue.h"
+
 namespace Surge
 {
 namespace Memory
 {
+/*
+ * A MemoryPool hands out preallocated objects to the audio thread. The pool itself (getItem,
+ * returnItem and the resize calls) belongs to the audio thread.
+ *
+ * Optionally a pool can be kept topped up from another thread. Once enableBackgroundRefill
+ * has been called, the pool calls wake whenever it drops below the low watermark or has
+ * items to give back, and the woken thread calls backgroundRefill(). That allocates new items
+ * and hands them over through a lock free queue, and returnItem sends items beyond the high
+ * watermark back through a second queue to be deleted there. The audio thread then only
+ * allocates if a burst drains the pool faster than the refill keeps up, and
+ * audioThreadAllocations counts those times.
+ */
 // pre-alloc must be at least one
 template <typename T, size_t preAlloc, size_t growBy, size_t capacity = 16384> struct MemoryPool
 {
+    static constexpr size_t handoffSize = 1024;
+
     template <typename... Args> MemoryPool(Args &&...args)
     {
-        while (position < preAlloc)
-            refreshPool(std::forward<Args>(args)...);
+        setupPoolToSize(preAlloc, std::forward<Args>(args)...);
     }
     ~MemoryPool()
     {
         for (size_t i = 0; i < position; ++i)
             delete pool[i];
+
+        // whoever drives backgroundRefill must have stopped by now
+        T *t;
+        while (refilled.pop(t))
+            delete t;
+        while (released.pop(t))
+            delete t;
     }
     template <typename... Args> T *getItem(Args &&...args)
     {
+        // take what the refill thread has ready before deciding whether to ask for more
+        if (position == 0 || position < lowWatermark)
+        {
+            collectRefills();
+        }
         if (position == 0)
         {
             refreshPool(std::forward<Args>(args)...);
@@ -49,23 +81,36 @@ template <typename T, size_t preAlloc, size_t growBy, size_t capacity = 16384> s
         auto q = pool[position - 1];
         pool[position - 1] = nullptr; // just to flag bugs
         position--;
+        available.store(position, std::memory_order_relaxed);
+
+        if (position < lowWatermark)
+            requestRefill();
         return q;
     }
     void returnItem(T *t)
     {
+        if (highWatermark > 0 && position >= highWatermark && released.push(t))
+        {
+            requestRefill();
+            return;
+        }
+
         pool[position] = t;
         position++;
+        available.store(position, std::memory_order_relaxed);
     }
     template <typename... Args> void refreshPool(Args &&...args)
     {
-        // In an ideal world, this grow would be off thread.
-        // For XT 1 leave it here and have a reasonable prealloc
+        // We only get here if the pool ran dry on the audio thread, which a background
+        // refill is there to prevent, so count it.
         assert(position < (growBy + capacity));
         for (size_t i = 0; i < growBy; ++i)
         {
             pool[position] = new T(std::forward<Args>(args)...);
             position++;
         }
+        audioThreadAllocations.fetch_add(growBy, std::memory_order_relaxed);
+        available.store(position, std::memory_order_relaxed);
     }
 
     template <typename... Args> void setupPoolToSize(size_t upTo, Args &&...args)
@@ -75,6 +120,7 @@ template <typename T, size_t preAlloc, size_t growBy, size_t capacity = 16384> s
             pool[position] = new T(std::forward<Args>(args)...);
             position++;
         }
+        available.store(position, std::memory_order_relaxed);
     }
 
     void returnToPreAllocSize()
@@ -85,6 +131,73 @@ template <typename T, size_t preAlloc, size_t growBy, size_t capacity = 16384> s
             pool[position - 1] = nullptr;
             position--;
         }
+        available.store(position, std::memory_order_relaxed);
+    }
+
+    /*
+     * Set up the background refill. make constructs one item and is only ever called from
+     * backgroundRefill. wake is called from the audio thread, at most once between calls to
+     * backgroundRefill, so it should just signal the refilling thread. Call this before that
+     * thread starts; setRefillWatermarks can be called at any time from the audio thread.
+     */
+    void enableBackgroundRefill(size_t low, size_t high, std::function<T *()> make,
+                                std::function<void()> wake)
+    {
+        makeItem = std::move(make);
+        wakeRefill = std::move(wake);
+        setRefillWatermarks(low, high);
+    }
+    void setRefillWatermarks(size_t low, size_t high)
+    {
+        assert(low <= high && high < capacity);
+        lowWatermark = low;
+        highWatermark = high;
+        lowWatermarkShared.store(low, std::memory_order_relaxed);
+        highWatermarkShared.store(high, std::memory_order_relaxed);
+
+        if (position < lowWatermark)
+            requestRefill();
+    }
+
+    // Called from the refill thread, never the audio thread
+    void backgroundRefill()
+    {
+        // cleared before we look, so a drop from here on asks again
+        refillRequested.store(false, std::memory_order_release);
+
+        T *t;
+        while (released.pop(t))
+            delete t;
+
+        if (!makeItem)
+            return;
+
+        auto low = lowWatermarkShared.load(std::memory_order_relaxed);
+        auto high = highWatermarkShared.load(std::memory_order_relaxed);
+        auto have = available.load(std::memory_order_relaxed) + refilled.size();
+        if (have >= low)
+            return;
+
+        // refill to halfway between the watermarks so returns don't immediately bounce
+        auto target = low + (high - low) / 2;
+        while (have < target)
+        {
+            if (!refilled.push(makeItem()))
+                break;
+            have++;
+        }
+    }
+
+    // move anything the refill thread has prepared into the pool
+    void collectRefills()
+    {
+        T *t;
+        while (position < capacity && refilled.pop(t))
+        {
+            pool[position] = t;
+            position++;
+        }
+        available.store(position, std::memory_order_relaxed);
     }
 
     std::array<T *, capacity> pool;
@@ -95,6 +208,27 @@ template <typename T, size_t preAlloc, size_t growBy, size_t capacity = 16384> s
      * position -1. position == 0 is a sentinel to rebuild.
      */
     size_t position{0};
+
+    // How many items getItem had to allocate itself since the pool was made
+    std::atomic<size_t> audioThreadAllocations{0};
+
+  private:
+    void requestRefill()
+    {
+        if (wakeRefill && !refillRequested.exchange(true, std::memory_order_acq_rel))
+            wakeRefill();
+    }
+
+    // position, published for the refill thread
+    std::atomic<size_t> available{0};
+    std::atomic<bool> refillRequested{false};
+
+    size_t lowWatermark{0}, highWatermark{0};
+    std::atomic<size_t> lowWatermarkShared{0}, highWatermarkShared{0};
+    std::function<T *()> makeItem;
+    std::function<void()> wakeRefill;
+
+    Surge::Threading::SPSCQueue<T *, handoffSize> refilled, released;
 };
 } // namespace Memory
 } // namespace Surge
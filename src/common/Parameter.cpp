@@ -23,6 +23,7 @@
 #include "SurgeStorage.h"
 #include "Parameter.h"
 #include "DSPUtils.h"
+#include "FFTVocoder.h"
 #include <cstring>
 #include <iomanip>
 #include <sstream>
@@ -369,6 +370,7 @@ bool Parameter::has_deformoptions() const
     case ct_amplitude_ringmod:
     case ct_bonsai_bass_boost:
     case ct_osc_feedback_negative:
+    case ct_vocoder_bandcount:
         return true;
     default:
         break;
@@ -3817,7 +3819,8 @@ std::string Parameter::get_display(bool external, float ef) const
                 txt = "Same as FM2/3";
             break;
         case ct_vocoder_bandcount:
-            txt = fmt::format("{:d} bands", i);
+            // deform type 1 is the FFT vocoder, which stretches the same steps over more bands
+            txt = fmt::format("{:d} bands", deform_type == 1 ? FFTVocoder::bandsForParam(i) : i);
             break;
         case ct_distortion_waveshape:
             txt = sst::waveshapers::wst_names[(int)FXWaveShapers[i]];
@@ -22,6 +22,7 @@
 
 #include "PatchDB.h"
 
+#include <cctype>
 #include <sstream>
 #include <iterator>
 #include <chrono>
@@ -239,10 +240,11 @@ struct TxnGuard
 
 struct PatchDB::WriterWorker
 {
-    static constexpr const char *schema_version = "14"; // I will rebuild if this is not my version
+    static constexpr const char *schema_version = "16"; // I will rebuild if this is not my version
 
     static constexpr const char *setup_sql = R"SQL(
 DROP TABLE IF EXISTS "Patches";
+DROP TABLE IF EXISTS "PatchSearch";
 DROP TABLE IF EXISTS "PatchFeature";
 DROP TABLE IF EXISTS "Version";
 DROP TABLE IF EXISTS "Category";
@@ -255,11 +257,23 @@ CREATE TABLE "Patches" (
       id integer primary key,
       path varchar(2048),
       name varchar(256),
-      search_over varchar(1024),
       category varchar(2048),
       category_type int,
       last_write_time big int
 );
+-- One row per patch, keyed by the patch id. The prefix indices keep type-ahead searches quick,
+-- and the rank weights a hit on the name above one on the tags, author or category. Fragments
+-- holds the tails of the name and tag words, so that "bass" still finds "SubBass".
+CREATE VIRTUAL TABLE PatchSearch USING fts5(
+      name,
+      tags,
+      author,
+      category,
+      fragments,
+      tokenize = 'unicode61 remove_diacritics 2',
+      prefix = '2 3'
+);
+INSERT INTO PatchSearch (PatchSearch, rank) VALUES ('rank', 'bm25(10.0, 5.0, 2.0, 1.0, 0.5)');
 CREATE TABLE PatchFeature (
       id integer primary key,
       patch_id integer,
@@ -736,6 +750,44 @@ CREATE TABLE IF NOT EXISTS Favorites (
         }
     }
 
+    /*
+     * Every tail of every word past its first character, so "SubBass" gives "ubBass bBass Bass
+     * ass". FTS5 only matches from the start of a token; indexing these lets a term found in
+     * the middle of a word still hit. Cuts land on UTF-8 character boundaries.
+     */
+    static std::string wordFragments(const std::string &s)
+    {
+        auto isWordByte = [](char c) {
+            return std::isalnum((unsigned char)c) || (unsigned char)c >= 0x80;
+        };
+        auto isContinuation = [](char c) { return ((unsigned char)c & 0xC0) == 0x80; };
+
+        std::string res;
+        size_t i = 0;
+        while (i < s.size())
+        {
+            if (!isWordByte(s[i]))
+            {
+                i++;
+                continue;
+            }
+
+            auto end = i;
+            while (end < s.size() && isWordByte(s[end]))
+                end++;
+
+            for (auto st = i + 1; st + 1 < end; ++st)
+            {
+                if (isContinuation(s[st]))
+                    continue;
+                res += s.substr(st, end - st);
+                res += " ";
+            }
+            i = end;
+        }
+        return res;
+    }
+
     void parseFXPIntoDB(const EnQPatch &p)
     {
         sqlite3_stmt *insertStmt = nullptr, *insfeatureStmt = nullptr, *dropIdStmt = nullptr;
@@ -798,6 +850,19 @@ CREATE TABLE IF NOT EXISTS Favorites (
                 }
 
                 dropF.finalize();
+
+                auto dropS = SQL::Statement(dbh, "DELETE FROM PatchSearch WHERE rowid=?1;");
+                for (auto did : dropIds)
+                {
+                    dropS.bind(1, did);
+                    while (dropS.step())
+                    {
+                    }
+                    dropS.clearBindings();
+                    dropS.reset();
+                }
+
+                dropS.finalize();
             }
         }
         catch (const SQL::Exception &e)
@@ -835,8 +900,8 @@ CREATE TABLE IF NOT EXISTS Favorites (
             return;
         }
 
-        std::ostringstream searchName;
-        searchName << p.name << " ";
+        std::ostringstream searchTags;
+        std::string searchAuthor;
 
         std::ifstream stream(p.path, std::ios::in | std::ios::binary);
         std::vector<uint8_t> contents((std::istreambuf_iterator<char>(stream)),
@@ -913,7 +978,11 @@ CREATE TABLE IF NOT EXISTS Favorites (
                 ins.reset();
                 if (ftype == "TAG")
                 {
-                    searchName << " " << std::get<3>(f);
+                    searchTags << " " << std::get<3>(f);
+                }
+                else if (ftype == "AUTHOR")
+                {
+                    searchAuthor = std::get<3>(f);
                 }
             }
 
@@ -925,19 +994,26 @@ CREATE TABLE IF NOT EXISTS Favorites (
             return;
         }
 
-        auto sns = searchName.str();
+        auto tags = searchTags.str();
         try
         {
-            auto ins = SQL::Statement(dbh, "UPDATE PATCHES SET search_over=?1 WHERE id=?2");
-            ins.bind(1, sns);
-            ins.bind(2, patchid);
+            auto ins = SQL::Statement(dbh, "INSERT INTO PatchSearch ( \"rowid\", \"name\", "
+                                           "\"tags\", \"author\", \"category\", "
+                                           "\"fragments\" ) "
+                                           "VALUES ( ?1, ?2, ?3, ?4, ?5, ?6 )");
+            ins.bindi64(1, patchid);
+            ins.bind(2, p.name);
+            ins.bind(3, tags);
+            ins.bind(4, searchAuthor);
+            ins.bind(5, p.catname);
+            ins.bind(6, wordFragments(p.name + " " + tags));
 
             ins.step();
             ins.finalize();
         }
         catch (const SQL::Exception &e)
         {
-            storage->reportError(e.what(), "PatchDB - FXP Features");
+            storage->reportError(e.what(), "PatchDB - FXP Search Index");
             return;
         }
     }
@@ -980,6 +1056,11 @@ CREATE TABLE IF NOT EXISTS Favorites (
             feat.bind(1, id);
             feat.step();
             feat.finalize();
+
+            auto search = SQL::Statement(dbh, "DELETE FROM PatchSearch where rowid=?");
+            search.bind(1, id);
+            search.step();
+            search.finalize();
         }
         catch (const SQL::Exception &e)
         {
@@ -1456,66 +1537,75 @@ int PatchDB::waitForJobsOutstandingComplete(int maxWaitInMS)
     return numberOfJobsOutstanding();
 }
 
-std::string PatchDB::sqlWhereClauseFor(const std::unique_ptr<PatchDBQueryParser::Token> &t)
+std::string PatchDB::ftsMatchExpressionFor(const std::unique_ptr<PatchDBQueryParser::Token> &t)
 {
-    auto protect = [](const std::string &s) -> std::string {
-        std::vector<std::pair<std::string, std::string>> replacements{{"'", "''"}, {"%", "%%"}};
-        auto res = s;
-        for (const auto &[search, replace] : replacements)
-        {
-            size_t pos = res.find(search);
-            // Repeat till end is reached
-            while (pos != std::string::npos)
-            {
-                // Replace this occurrence of Sub String
-                res.replace(pos, search.size(), replace);
-                // Get the next occurrence from the current position
-                pos = res.find(search, pos + replace.size());
-            }
+    // An FTS5 string, prefix matched so the results narrow as you type. A term with nothing
+    // in it the tokenizer would keep doesn't narrow anything, so it comes back empty.
+    auto phrase = [](const std::string &columns, const std::string &s) -> std::string {
+        bool searchable = false;
+        for (auto c : s)
+            searchable = searchable || std::isalnum((unsigned char)c) || (unsigned char)c >= 0x80;
+
+        if (!searchable)
+            return "";
+
+        std::string res = columns + " : \"";
+        for (auto c : s)
+        {
+            if (c == '"')
+                res += "\"\"";
+            else
+                res += c;
         }
-        return res;
+        return res + "\"*";
     };
-    std::ostringstream oss;
+
     switch (t->type)
     {
     case PatchDBQueryParser::INVALID:
-        oss << "(1 == 0)";
-        break;
+        // the empty phrase, which matches nothing
+        return "\"\"";
     case PatchDBQueryParser::KEYWORD_EQUALS:
-        if ((t->content == "AUTHOR" || t->content == "AUTH") && !t->children[0]->content.empty())
-        {
-            oss << "(author LIKE '%" << protect(t->children[0]->content) << "%' )";
-        }
-        else if ((t->content == "CATEGORY" || t->content == "CAT") &&
-                 !t->children[0]->content.empty())
-        {
-            oss << "(category LIKE '%" << protect(t->children[0]->content) << "%' )";
-        }
-        else
-        {
-            oss << "(1 == 1)";
-        }
-        break;
+        if (t->content == "AUTHOR" || t->content == "AUTH")
+            return phrase("author", t->children[0]->content);
+        if (t->content == "CATEGORY" || t->content == "CAT")
+            return phrase("category", t->children[0]->content);
+        return "";
     case PatchDBQueryParser::LITERAL:
-        oss << "( p.search_over LIKE '%" << protect(t->content) << "%' )";
-        break;
+        return phrase("{name tags fragments}", t->content);
     case PatchDBQueryParser::AND:
     case PatchDBQueryParser::OR:
     {
-        oss << "( ";
-        std::string inter = "";
+        std::vector<std::string> terms;
         for (auto &c : t->children)
         {
-            oss << inter;
-            oss << sqlWhereClauseFor(c);
+            auto e = ftsMatchExpressionFor(c);
+
+            // an empty term matches everything, so it drops out of an AND and fills an OR
+            if (e.empty())
+            {
+                if (t->type == PatchDBQueryParser::OR)
+                    return "";
+                continue;
+            }
+            terms.push_back(e);
+        }
+
+        if (terms.size() == 1)
+            return terms[0];
+
+        std::ostringstream oss;
+        std::string inter = "";
+        for (auto &e : terms)
+        {
+            oss << inter << "( " << e << " )";
             inter = t->type == PatchDBQueryParser::AND ? " AND " : " OR ";
         }
-        oss << " )";
-        break;
+        return oss.str();
     }
     }
 
-    return oss.str();
+    return "";
 }
 
 std::vector<PatchDB::patchRecord>
@@ -1523,14 +1613,17 @@ PatchDB::queryFromQueryString(const std::unique_ptr<PatchDBQueryParser::Token> &
 {
     std::vector<PatchDB::patchRecord> res;
 
+    auto match = ftsMatchExpressionFor(t);
+
     // FIXME - cache this by pushing it to the worker
-    std::string query = "select p.id, p.path, p.category as category, p.name, pf.feature_svalue as "
-                        "author, p.search_over from Patches "
-                        "as p, PatchFeature as pf where pf.patch_id == p.id and pf.feature LIKE "
-                        "'AUTHOR' and " +
-                        sqlWhereClauseFor(t) + " ORDER BY p.category_type, p.category, p.name";
+    std::string query = "select p.id, p.path, p.category, p.name, PatchSearch.author from "
+                        "PatchSearch, Patches as p where p.id == PatchSearch.rowid";
+    if (match.empty())
+        query += " ORDER BY p.category_type, p.category, p.name";
+    else
+        query += " and PatchSearch MATCH ?1 ORDER BY PatchSearch.rank, p.category_type, "
+                 "p.category, p.name";
 
-    // std::cout << "QUERY IS \n" << query << "\n";
     try
     {
         auto conn = worker->getReadOnlyConn(false);
@@ -1538,6 +1631,8 @@ PatchDB::queryFromQueryString(const std::unique_ptr<PatchDBQueryParser::Token> &
             return res;
 
         auto q = SQL::Statement(conn, query);
+        if (!match.empty())
+            q.bind(1, match);
 
         while (q.step())
         {
@@ -1559,7 +1654,7 @@ PatchDB::queryFromQueryString(const std::unique_ptr<PatchDBQueryParser::Token> &
         }
         else
         {
-            storage->reportError(e.what(), "PatchDB - rawQueryForNameLike");
+            storage->reportError(e.what(), "PatchDB - queryFromQueryString");
         }
     }
 
@@ -139,8 +139,13 @@ struct PatchDB
 
     std::unordered_map<std::string, std::pair<int, int64_t>> readAllPatchPathsWithIdAndModTime();
 
-    // How the query string works
-    static std::string sqlWhereClauseFor(const std::unique_ptr<PatchDBQueryParser::Token> &t);
+    /*
+     * How the query string works. The parsed query becomes an FTS5 MATCH expression over the
+     * PatchSearch index, with each term matching words which start with it, and the results
+     * come back best match first. A query which doesn't narrow anything down comes back as an
+     * empty expression, and finds every patch.
+     */
+    static std::string ftsMatchExpressionFor(const std::unique_ptr<PatchDBQueryParser::Token> &t);
     std::vector<patchRecord> queryFromQueryString(const std::string &query)
     {
         return queryFromQueryString(PatchDBQueryParser::parseQuery(query));
@@ -0,0 +1,118 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "SurgeStorage.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace Surge
+{
+namespace Profiling
+{
+namespace
+{
+std::vector<std::string> makeStageNames()
+{
+    std::vector<std::string> res(n_process_stages);
+
+    auto sceneName = [](int s) { return std::string("scene_") + (char)('a' + s); };
+
+    res[pst_processControl] = "process_control";
+    for (int s = 0; s < n_scenes; ++s)
+    {
+        res[voiceStage(s)] = sceneName(s) + "_voices";
+        for (int o = 0; o < n_oscs; ++o)
+            res[oscStage(s, o)] = sceneName(s) + "_osc_" + std::to_string(o + 1);
+        res[filterChainStage(s)] = sceneName(s) + "_filter_chain";
+        res[halfbandStage(s)] = sceneName(s) + "_halfband";
+    }
+    for (int f = 0; f < n_fx_slots; ++f)
+        res[fxStage(f)] = "fx_" + std::to_string(f);
+    res[pst_total] = "total";
+
+    return res;
+}
+} // namespace
+
+const char *processStageName(int stage)
+{
+    static const auto names = makeStageNames();
+
+    if (stage < 0 || stage >= n_process_stages)
+        return "";
+    return names[stage].c_str();
+}
+
+size_t ProcessProfiler::latest(ProcessProfile *into, size_t maxEntries) const
+{
+    auto w = written.load(std::memory_order_acquire);
+    auto n = std::min({(uint64_t)maxEntries, (uint64_t)ringSize, w});
+
+    for (uint64_t i = 0; i < n; ++i)
+        into[i] = ring[(w - 1 - i) % ringSize];
+
+    // anything the writer could have started overwriting while we copied is suspect
+    std::atomic_thread_fence(std::memory_order_acquire);
+    auto w2 = written.load(std::memory_order_relaxed);
+
+    size_t kept = 0;
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        auto idx = w - 1 - i;
+        if (idx + ringSize > w2)
+            kept++;
+        else
+            break;
+    }
+    return kept;
+}
+
+ProcessProfile ProcessProfiler::average(size_t nBlocks) const
+{
+    std::vector<ProcessProfile> entries(std::min(nBlocks, ringSize));
+    auto n = latest(entries.data(), entries.size());
+
+    ProcessProfile res;
+    for (size_t i = 0; i < n; ++i)
+    {
+        for (int s = 0; s < n_process_stages; ++s)
+            res.usec[s] += entries[i].usec[s];
+        for (int f = 0; f < n_fx_slots; ++f)
+            res.fxAsleep[f] += entries[i].fxAsleep[f];
+    }
+
+    if (n > 0)
+    {
+        for (auto &u : res.usec)
+            u /= n;
+        for (auto &a : res.fxAsleep)
+            a /= n;
+    }
+
+    res.block = n;
+    return res;
+}
+
+} // namespace Profiling
+} // namespace Surge
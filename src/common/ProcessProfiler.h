@@ -0,0 +1,181 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_PROCESSPROFILER_H
+#define SURGE_SRC_COMMON_PROCESSPROFILER_H
+
+/*
+ * This header is pulled in part way through SurgeStorage.h, once n_scenes, n_oscs and
+ * n_fx_slots exist, so include SurgeStorage.h rather than this directly.
+ */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Surge
+{
+namespace Profiling
+{
+/*
+ * The stages of SurgeSynthesizer::process() we time. The voice stage of a scene includes its
+ * oscillators, so the oscillator stages are a breakdown of it rather than an addition to it.
+ * total is the whole of process(), including everything we don't time separately.
+ */
+enum ProcessStage
+{
+    pst_processControl = 0,
+    pst_voices_first = pst_processControl + 1,
+    pst_osc_first = pst_voices_first + n_scenes,
+    pst_filterchain_first = pst_osc_first + n_scenes * n_oscs,
+    pst_halfband_first = pst_filterchain_first + n_scenes,
+    pst_fx_first = pst_halfband_first + n_scenes,
+    pst_total = pst_fx_first + n_fx_slots,
+
+    n_process_stages
+};
+
+inline int voiceStage(int scene) { return pst_voices_first + scene; }
+inline int oscStage(int scene, int osc) { return pst_osc_first + scene * n_oscs + osc; }
+inline int filterChainStage(int scene) { return pst_filterchain_first + scene; }
+inline int halfbandStage(int scene) { return pst_halfband_first + scene; }
+inline int fxStage(int slot) { return pst_fx_first + slot; }
+
+/*
+ * A lower case name with no spaces, like "scene_a_osc_2" or "fx_5", so it can be used as is
+ * in an OSC address or a python dict key. FX are named by slot index in the patch fx array.
+ */
+const char *processStageName(int stage);
+
+struct ProcessProfile
+{
+    uint64_t block{0};
+    std::array<float, n_process_stages> usec{};
+    // 1 if the fx slot didn't run (empty, disabled or asleep) so averages are the time asleep
+    std::array<float, n_fx_slots> fxAsleep{};
+};
+
+/*
+ * ProcessProfiler collects the per-stage timings of each process() block into a fixed ring of
+ * ProcessProfile entries. It costs nothing but a relaxed load per stage unless someone has
+ * registered as a client (the GUI, OSC, surgepy...), in the same style as otherscene_clients.
+ *
+ * The audio thread is the only writer and never waits. It writes the entry for the block
+ * then bumps the written count with release ordering. A reader copies entries, then re-reads
+ * the count and throws away anything the writer could have lapped while it was copying, so
+ * readers never block the audio thread and never see a torn entry they keep.
+ *
+ * Voices of different scenes may run on different threads (see setParallelSceneRendering)
+ * but each thread only ever adds into its own scene's stages, so accumulating is unguarded.
+ */
+struct ProcessProfiler
+{
+    typedef std::chrono::high_resolution_clock clock_t;
+    static constexpr size_t ringSize = 1024;
+
+    void addClient() { clients++; }
+    void removeClient() { clients--; }
+    bool isActive() const { return active; }
+
+    // audio thread
+    void beginBlock()
+    {
+        active = clients.load(std::memory_order_relaxed) > 0;
+        if (active)
+        {
+            current.usec.fill(0.f);
+            blockStart = clock_t::now();
+        }
+    }
+    void add(int stage, float usec) { current.usec[stage] += usec; }
+    void setFXAsleep(int slot, bool asleep) { current.fxAsleep[slot] = asleep ? 1.f : 0.f; }
+    void endBlock()
+    {
+        if (!active)
+            return;
+
+        auto w = written.load(std::memory_order_relaxed);
+        current.usec[pst_total] = usecSince(blockStart);
+        current.block = w;
+        ring[w % ringSize] = current;
+        written.store(w + 1, std::memory_order_release);
+    }
+
+    static float usecSince(clock_t::time_point start)
+    {
+        return std::chrono::duration<float, std::micro>(clock_t::now() - start).count();
+    }
+
+    /*
+     * Any thread. Copies up to maxEntries of the most recent blocks, newest first, and
+     * returns how many it copied.
+     */
+    size_t latest(ProcessProfile *into, size_t maxEntries) const;
+
+    /*
+     * Any thread. The per-stage mean over the last nBlocks blocks. block holds the number of
+     * blocks actually averaged, which is zero if nothing has been profiled yet.
+     */
+    ProcessProfile average(size_t nBlocks) const;
+
+    uint64_t blocksProfiled() const { return written.load(std::memory_order_acquire); }
+
+  private:
+    std::atomic<int> clients{0};
+    bool active{false};
+    clock_t::time_point blockStart;
+    ProcessProfile current;
+
+    std::array<ProcessProfile, ringSize> ring;
+    std::atomic<uint64_t> written{0};
+};
+
+/*
+ * Adds the time from construction to destruction to a stage, if the profiler is active for
+ * this block.
+ */
+struct StageTimer
+{
+    StageTimer(ProcessProfiler &p, int stage) : profiler(p), stage(stage)
+    {
+        if (profiler.isActive())
+            start = ProcessProfiler::clock_t::now();
+    }
+    ~StageTimer()
+    {
+        if (profiler.isActive())
+            profiler.add(stage, ProcessProfiler::usecSince(start));
+    }
+
+    StageTimer(const StageTimer &) = delete;
+    StageTimer &operator=(const StageTimer &) = delete;
+
+  private:
+    ProcessProfiler &profiler;
+    int stage;
+    ProcessProfiler::clock_t::time_point start;
+};
+} // namespace Profiling
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_PROCESSPROFILER_H
@@ -0,0 +1,87 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_SPSCQUEUE_H
+#define SURGE_SRC_COMMON_SPSCQUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace Surge
+{
+namespace Threading
+{
+/*
+ * A bounded, wait-free, single producer single consumer queue. One thread may push and one
+ * (other) thread may pop; neither side ever blocks or allocates, so either end can be the
+ * audio thread. The indices run freely and are masked on access, which is why the capacity
+ * has to be a power of two.
+ */
+template <typename T, size_t capacity> struct SPSCQueue
+{
+    static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0,
+                  "SPSCQueue capacity must be a power of two");
+
+    // producer side. Returns false, and leaves the queue alone, if the queue is full
+    bool push(const T &t)
+    {
+        auto w = writePos.load(std::memory_order_relaxed);
+        if (w - readPos.load(std::memory_order_acquire) == capacity)
+            return false;
+
+        items[w & mask] = t;
+        writePos.store(w + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side. Returns false if there was nothing to pop
+    bool pop(T &t)
+    {
+        auto r = readPos.load(std::memory_order_relaxed);
+        if (r == writePos.load(std::memory_order_acquire))
+            return false;
+
+        t = items[r & mask];
+        readPos.store(r + 1, std::memory_order_release);
+        return true;
+    }
+
+    // only a snapshot when read from a third thread, but exact from either end
+    size_t size() const
+    {
+        return writePos.load(std::memory_order_acquire) - readPos.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+
+  private:
+    static constexpr size_t mask = capacity - 1;
+
+    // keep the two ends on separate cache lines so the threads don't false share
+    alignas(64) std::atomic<size_t> writePos{0};
+    alignas(64) std::atomic<size_t> readPos{0};
+    std::array<T, capacity> items{};
+};
+} // namespace Threading
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_SPSCQUEUE_H
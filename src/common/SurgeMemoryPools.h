@@ -26,6 +26,12 @@
 #include "SurgeStorage.h"
 #include "MemoryPool.h"
 #include "SSESincDelayLine.h"
+#include "TwistOscillator.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 namespace Surge
 {
@@ -33,7 +39,27 @@ namespace Memory
 {
 struct SurgeMemoryPools
 {
-    SurgeMemoryPools(SurgeStorage *s) : stringDelayLines(s->sinctable) {}
+    SurgeMemoryPools(SurgeStorage *s) : stringDelayLines(s->sinctable)
+    {
+        auto st = s->sinctable;
+        stringDelayLines.enableBackgroundRefill(
+            stringLowWatermark, stringHighWatermark,
+            [st]() { return new SSESincDelayLine<16384>(st); }, [this]() { wakeRefill(); });
+        twistEngines.enableBackgroundRefill(
+            twistLowWatermark, twistHighWatermark, []() { return new TwistEngineState(); },
+            [this]() { wakeRefill(); });
+
+        refillThread = std::thread([this]() { refillLoop(); });
+    }
+    ~SurgeMemoryPools()
+    {
+        {
+            std::lock_guard<std::mutex> g(refillMutex);
+            keepRefilling = false;
+        }
+        refillCV.notify_all();
+        refillThread.join();
+    }
 
     /*
      * The largest number of oscillator instances of a particular
@@ -45,11 +71,29 @@ struct SurgeMemoryPools
      * The string needs 2 delay lines per oscillator
      */
     MemoryPool<SSESincDelayLine<16384>, 8, 4, 2 * maxosc + 100> stringDelayLines;
+    static constexpr size_t stringLowWatermark = 8, stringHighWatermark = 32;
+
+    /*
+     * The twist needs a plaits voice and its resamplers per oscillator
+     */
+    MemoryPool<TwistEngineState, 4, 2, maxosc + 100> twistEngines;
+    static constexpr size_t twistLowWatermark = 4, twistHighWatermark = 16;
+
+    // the voices softkilled past the polyphony limit which playVoice lets linger, and the new one
+    static constexpr int stolenVoiceMargin = 3 + 1;
+
+    // total allocations the audio thread had to make because a pool ran dry
+    size_t audioThreadAllocations() const
+    {
+        return stringDelayLines.audioThreadAllocations.load(std::memory_order_relaxed) +
+               twistEngines.audioThreadAllocations.load(std::memory_order_relaxed);
+    }
+
     void resetAllPools(SurgeStorage *storage) { resetOscillatorPools(storage); }
     void resetOscillatorPools(SurgeStorage *storage)
     {
         bool hasString{false}, hasTwist{false};
-        int nString{0};
+        int nString{0}, nTwist{0};
         for (int s = 0; s < n_scenes; ++s)
         {
             for (int os = 0; os < n_oscs; ++os)
@@ -61,7 +105,11 @@ struct SurgeMemoryPools
                     hasString = true;
                     nString++;
                 }
-                hasTwist |= (ot == ot_twist);
+                if (ot == ot_twist)
+                {
+                    hasTwist = true;
+                    nTwist++;
+                }
             }
         }
 
@@ -69,12 +117,86 @@ struct SurgeMemoryPools
         {
             int maxUsed = nString * 2 * storage->getPatch().polylimit.val.i;
             stringDelayLines.setupPoolToSize((int)(maxUsed * 0.5), storage->sinctable);
+
+            // keep a quarter of the possible lines ready, and don't free any on the way back
+            // down until we're holding more than all of them
+            auto low = std::max((size_t)(maxUsed / 4), stringLowWatermark);
+            auto high = std::max((size_t)maxUsed, stringHighWatermark);
+            stringDelayLines.setRefillWatermarks(low, std::min(high, (size_t)(2 * maxosc)));
         }
         else
         {
             stringDelayLines.returnToPreAllocSize();
+            stringDelayLines.setRefillWatermarks(stringLowWatermark, stringHighWatermark);
+        }
+
+        if (hasTwist)
+        {
+            /*
+             * A Twist oscillator holds its engine for the life of the voice, releases and
+             * steals included: a scene can have polylimit voices playing or releasing plus
+             * the ones enforcePolyphonyLimit lets fade out as they're stolen. Engines are big
+             * enough that the refill thread can't be relied on to build them between notes,
+             * so hold that many up front, and as the high watermark keeps them all, returned
+             * engines stay in the pool for the next note.
+             */
+            int voicesPerScene =
+                std::min(storage->getPatch().polylimit.val.i + stolenVoiceMargin, MAX_VOICES);
+            int maxUsed = nTwist * voicesPerScene;
+            twistEngines.setupPoolToSize(maxUsed);
+
+            auto low = std::max((size_t)(maxUsed / 4), twistLowWatermark);
+            auto high = std::max((size_t)maxUsed, twistHighWatermark);
+            twistEngines.setRefillWatermarks(low, std::min(high, (size_t)maxosc));
+        }
+        else
+        {
+            twistEngines.returnToPreAllocSize();
+            twistEngines.setRefillWatermarks(twistLowWatermark, twistHighWatermark);
         }
     }
+
+  private:
+    /*
+     * Pool growth happens here rather than on the audio thread. A String oscillator voice
+     * needs two 64k delay lines and a Twist one a whole plaits voice, so a chord can
+     * otherwise mean a megabyte of allocation inside process().
+     *
+     * The thread sleeps until a pool wakes it. The audio thread signals without taking
+     * refillMutex, so a wake can land just before we start waiting and be missed; the pool
+     * won't ask again until it has been refilled, so the long timeout is there to catch that.
+     */
+    void wakeRefill()
+    {
+        refillWanted.store(true, std::memory_order_release);
+        refillCV.notify_one();
+    }
+
+    void refillLoop()
+    {
+        std::unique_lock<std::mutex> lock(refillMutex);
+        while (keepRefilling)
+        {
+            refillCV.wait_for(lock, std::chrono::milliseconds(500), [this] {
+                return !keepRefilling || refillWanted.load(std::memory_order_acquire);
+            });
+
+            if (!keepRefilling)
+                break;
+            refillWanted.store(false, std::memory_order_release);
+
+            lock.unlock();
+            stringDelayLines.backgroundRefill();
+            twistEngines.backgroundRefill();
+            lock.lock();
+        }
+    }
+
+    std::thread refillThread;
+    std::mutex refillMutex;
+    std::condition_variable refillCV;
+    std::atomic<bool> refillWanted{false};
+    bool keepRefilling{true};
 };
 
 } // namespace Memory
@@ -2362,6 +2362,32 @@ void SurgePatch::load_xml(const void *data, int datasize, bool is_preset)
         }
     }
 
+    {
+        std::lock_guard<std::mutex> filePathLock(storage->fxFilePathMutex);
+
+        for (auto &f : fx)
+        {
+            f.file_path.clear();
+        }
+
+        TiXmlElement *efd = TINYXML_SAFE_TO_ELEMENT(patch->FirstChild("extrafxdata"));
+
+        if (efd)
+        {
+            for (auto child = efd->FirstChild(); child; child = child->NextSibling())
+            {
+                auto *lkid = TINYXML_SAFE_TO_ELEMENT(child);
+                int slot;
+
+                if (lkid && lkid->QueryIntAttribute("slot", &slot) == TIXML_SUCCESS && slot >= 0 &&
+                    slot < n_fx_slots && lkid->Attribute("file_path"))
+                {
+                    fx[slot].file_path = lkid->Attribute("file_path");
+                }
+            }
+        }
+    }
+
     // reset stepsequences first
     for (auto &stepsequence : stepsequences)
     {
@@ -3397,6 +3423,21 @@ unsigned int SurgePatch::save_xml(void **data) // allocates mem, must be freed b
     }
     patch.InsertEndChild(eod);
 
+    TiXmlElement efd("extrafxdata");
+    for (int sl = 0; sl < n_fx_slots; ++sl)
+    {
+        if (fx[sl].type.val.i != fxt_off && !fx[sl].file_path.empty())
+        {
+            TiXmlElement fn("fx_extra_" + std::to_string(sl));
+
+            fn.SetAttribute("slot", sl);
+            fn.SetAttribute("file_path", fx[sl].file_path);
+
+            efd.InsertEndChild(fn);
+        }
+    }
+    patch.InsertEndChild(efd);
+
     TiXmlElement ss("stepsequences");
     for (int sc = 0; sc < n_scenes; sc++)
     {
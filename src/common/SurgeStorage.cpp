@@ -50,6 +50,7 @@
 #include "FxPresetAndClipboardManager.h"
 #include "ModulatorPresetManager.h"
 #include "SurgeMemoryPools.h"
+#include "ImpulseResponseLoader.h"
 #include "sst/basic-blocks/tables/SincTableProvider.h"
 
 // FIXME probably remove this when we remove the hardcoded hack below
@@ -536,6 +537,10 @@ SurgeStorage::SurgeStorage(const SurgeStorage::SurgeStorageConfig &config) : oth
         reportError(e.what(), "Error Scnning Modulator Presets");
     }
     memoryPools = std::make_unique<Surge::Memory::SurgeMemoryPools>(this);
+    impulseResponses = std::make_unique<Surge::DSP::ImpulseResponseLoader>(this);
+
+    publishModulationRouting();
+    acquireModulationRoutingForBlock();
 }
 
 void SurgeStorage::createUserDirectory()
@@ -1960,6 +1965,7 @@ void SurgeStorage::clipboard_paste(int type, int scene, int entry, modsources ms
         }
     }
 
+    publishModulationRouting();
     modRoutingMutex.unlock();
 }
 
@@ -2141,12 +2147,87 @@ void SurgeStorage::load_midi_controllers()
 
 SurgeStorage::~SurgeStorage()
 {
+    // the loader reads file paths out of the patch, so stop it before anything goes
+    impulseResponses.reset();
+
 #ifndef SURGE_SKIP_ODDSOUND_MTS
     if (oddsound_mts_active_as_main)
         disconnect_as_oddsound_main();
 
     deinitialize_oddsound();
 #endif
+
+    delete publishedModRouting.load();
+    for (auto *r : retiredModRouting)
+        delete r;
+}
+
+void SurgeStorage::publishModulationRouting()
+{
+    std::lock_guard<std::recursive_mutex> mg(modRoutingMutex);
+
+    if (modRoutingBatchDepth > 0)
+    {
+        modRoutingPublishPending = true;
+        return;
+    }
+    modRoutingPublishPending = false;
+
+    auto *snap = new ModulationRoutingSnapshot;
+    snap->global = getPatch().modulation_global;
+    for (int sc = 0; sc < n_scenes; ++sc)
+    {
+        snap->scene[sc] = getPatch().scene[sc].modulation_scene;
+        snap->voice[sc] = getPatch().scene[sc].modulation_voice;
+    }
+
+    auto *old = publishedModRouting.exchange(snap);
+    if (old)
+        retiredModRouting.push_back(old);
+
+    // the seq_cst exchange above and load here pair with the store then reload in acquire
+    auto *inUse = modRoutingInUse.load();
+    size_t kept = 0;
+    for (auto *r : retiredModRouting)
+    {
+        if (r == inUse)
+            retiredModRouting[kept++] = r;
+        else
+            delete r;
+    }
+    retiredModRouting.resize(kept);
+}
+
+SurgeStorage::ModulationRoutingBatch::ModulationRoutingBatch(SurgeStorage &s) : storage(s)
+{
+    storage.modRoutingMutex.lock();
+    storage.modRoutingBatchDepth++;
+}
+
+SurgeStorage::ModulationRoutingBatch::~ModulationRoutingBatch()
+{
+    storage.modRoutingBatchDepth--;
+    if (storage.modRoutingBatchDepth == 0 && storage.modRoutingPublishPending)
+        storage.publishModulationRouting();
+    storage.modRoutingMutex.unlock();
+}
+
+void SurgeStorage::acquireModulationRoutingForBlock()
+{
+    /*
+     * Advertise the snapshot we are about to use, then check it is still the current one. If
+     * a publisher swapped in between it may not have seen our claim, so go around again.
+     */
+    auto *snap = publishedModRouting.load();
+    while (true)
+    {
+        modRoutingInUse.store(snap);
+        auto *check = publishedModRouting.load();
+        if (check == snap)
+            break;
+        snap = check;
+    }
+    audioModRouting = snap;
 }
 
 double shafted_tanh(double x) { return (exp(x) - exp(-x * 1.2)) / (exp(x) + exp(-x)); }
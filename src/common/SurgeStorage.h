@@ -31,6 +31,7 @@
 #include "filesystem/import.h"
 #include "sst/cpputils.h"
 
+#include <array>
 #include <vector>
 #include <memory>
 #include <mutex>
@@ -404,6 +405,7 @@ enum fx_type
     fxt_spring_reverb,
     fxt_bonsai,
     fxt_audio_input,
+    fxt_convolution,
 
     n_fx_types,
 };
@@ -437,19 +439,22 @@ const char fx_type_names[n_fx_types][32] = {"Off",
                                             "Mid-Side Tool",
                                             "Spring Reverb",
                                             "Bonsai",
-                                            "Audio Input"};
+                                            "Audio Input",
+                                            "Convolution"};
 
 const char fx_type_shortnames[n_fx_types][16] = {
     "Off",         "Delay",      "Reverb 1",      "Phaser",        "Rotary",     "Distortion",
     "EQ",          "Freq Shift", "Conditioner",   "Chorus",        "Vocoder",    "Reverb 2",
     "Flanger",     "Ring Mod",   "Airwindows",    "Neuron",        "Graphic EQ", "Resonator",
     "CHOW",        "Exciter",    "Ensemble",      "Combulator",    "Nimbus",     "Tape",
-    "Treemonster", "Waveshaper", "Mid-Side Tool", "Spring Reverb", "Bonsai",     "Audio In"};
+    "Treemonster", "Waveshaper", "Mid-Side Tool", "Spring Reverb", "Bonsai",     "Audio In",
+    "Convolution"};
 
 const char fx_type_acronyms[n_fx_types][8] = {
     "OFF", "DLY", "RV1", "PH",   "ROT", "DIST", "EQ",  "FRQ", "DYN", "CH",
     "VOC", "RV2", "FL",  "RM",   "AW",  "NEU",  "GEQ", "RES", "CHW", "XCT",
-    "ENS", "CMB", "NIM", "TAPE", "TM",  "WS",   "M-S", "SRV", "BON", "IN"};
+    "ENS", "CMB", "NIM", "TAPE", "TM",  "WS",   "M-S", "SRV", "BON", "IN",
+    "CNV"};
 
 enum fx_bypass
 {
@@ -542,6 +547,11 @@ const int lt_num_deforms[n_lfo_types] = {
  */
 #include "FilterConfiguration.h"
 
+/*
+ * The per-stage process() profiler is sized from the constants above, so it comes in here too
+ */
+#include "ProcessProfiler.h"
+
 enum env_mode
 {
     emt_digital = 0,
@@ -702,6 +712,9 @@ struct FxStorage
 
     // like this one!
     fxslot_positions fxslot;
+
+    // a file the effect reads besides its parameters, such as the convolution's impulse response
+    std::string file_path;
 };
 
 struct SurgeSceneStorage
@@ -830,6 +843,15 @@ struct MSEGStorage
     float durationLoopStartToLoopEnd;
     float envelopeModeDuration = -1, envelopeModeNV1 = -2; // -2 as sentinel since NV1 is -1/1
 
+    // The curve shape terms which depend only on a segment's control point, with the cpv they
+    // were worked out for, and a uniform grid over totalDuration holding the first segment each
+    // cell can land in. So valueAt neither searches for its segment nor re-derives its curve
+    static constexpr int timeIndexSize = 2 * max_msegs;
+    std::array<float, max_msegs> segmentCurveCpv, segmentCurveExponent;
+    std::array<int, max_msegs> segmentWaveSteps, segmentStairSteps;
+    std::array<uint8_t, timeIndexSize> timeIndex;
+    float timeIndexScale = 0;
+
     /*
      * These "UI" type things we decided, late in 1.8, are actually a critical part of
      * the modelling experience, so even if they aren't required to actually evaluate
@@ -1164,6 +1186,10 @@ namespace Memory
 {
 struct SurgeMemoryPools;
 }
+namespace DSP
+{
+class ImpulseResponseLoader;
+}
 namespace Formula
 {
 struct GlobalData;
@@ -1337,6 +1363,13 @@ class alignas(16) SurgeStorage
     bool load_wt_wt_mem(const char *data, const size_t dataSize, Wavetable *wt);
     bool load_wt_wav_portable(std::string filename, Wavetable *wt);
     std::string export_wt_wav_portable(std::string fbase, Wavetable *wt);
+    /*
+     * Read a whole WAV file as float, one vector per channel, for things like impulse
+     * responses which want the audio rather than a wavetable. Safe to call off the UI thread;
+     * problems go to reportError under uitag.
+     */
+    bool load_wav_channels(const fs::path &path, std::vector<std::vector<float>> &channels,
+                           int &sampleRate, const std::string &uitag);
     void clipboard_copy(int type, int scene, int entry, modsources ms = ms_original);
     // this function is a bit of a hack to stop me having a reference to SurgeSynth here
     // and also to stop me having to move all of isValidModulation and its buddies onto SurgeStorage
@@ -1392,6 +1425,44 @@ class alignas(16) SurgeStorage
 
     std::mutex waveTableDataMutex;
     std::recursive_mutex modRoutingMutex;
+
+    // held to write an FxStorage::file_path in the patch, and by the IR loader to read one
+    std::mutex fxFilePathMutex;
+
+    /*
+     * The audio thread never takes modRoutingMutex. Code which edits the routing vectors in the
+     * patch does so holding the mutex and then calls publishModulationRouting, which copies them
+     * into a new immutable snapshot and swaps it in atomically. At the top of each block the
+     * audio thread picks up the latest snapshot with acquireModulationRoutingForBlock and reads
+     * routings only from audioModRouting until the next one. The snapshot the audio thread holds
+     * is advertised in modRoutingInUse, and publishers only delete retired snapshots it has
+     * moved past, so a snapshot is never freed under the audio thread.
+     */
+    struct ModulationRoutingSnapshot
+    {
+        std::vector<ModulationRouting> global;
+        std::array<std::vector<ModulationRouting>, n_scenes> scene, voice;
+    };
+    void publishModulationRouting();
+    void acquireModulationRoutingForBlock();
+    const ModulationRoutingSnapshot *audioModRouting{nullptr};
+    std::atomic<ModulationRoutingSnapshot *> publishedModRouting{nullptr};
+    std::atomic<ModulationRoutingSnapshot *> modRoutingInUse{nullptr};
+    std::vector<ModulationRoutingSnapshot *> retiredModRouting; // guarded by modRoutingMutex
+
+    /*
+     * While a ModulationRoutingBatch is alive, publishModulationRouting only notes that a
+     * publish is due, and the outermost batch publishes once as it ends. loadFx holds one, so
+     * an FX reload on the audio thread builds a single snapshot however many routings it clears.
+     */
+    struct ModulationRoutingBatch
+    {
+        explicit ModulationRoutingBatch(SurgeStorage &s);
+        ~ModulationRoutingBatch();
+        SurgeStorage &storage;
+    };
+    int modRoutingBatchDepth{0};          // guarded by modRoutingMutex
+    bool modRoutingPublishPending{false}; // guarded by modRoutingMutex
     Wavetable WindowWT;
 
     // hardclip
@@ -1607,6 +1678,12 @@ class alignas(16) SurgeStorage
 
     std::atomic<int> otherscene_clients;
 
+    /*
+     * Per-stage timings of each process() block, recorded only while someone is listening.
+     * It lives here rather than in the synth so voices and effects can time themselves.
+     */
+    Surge::Profiling::ProcessProfiler processProfiler;
+
     Surge::Storage::ScenesOutputData scenesOutputData;
 
     std::unordered_map<int, std::string> helpURL_controlgroup;
@@ -1638,6 +1715,7 @@ class alignas(16) SurgeStorage
     static bool skipLoadWtAndPatch;
 
     std::unique_ptr<Surge::Memory::SurgeMemoryPools> memoryPools;
+    std::unique_ptr<Surge::DSP::ImpulseResponseLoader> impulseResponses;
 
 /*
  * An RNG which is decoupled from the non-Surge global state and is threadsafe.
@@ -1665,12 +1743,28 @@ class alignas(16) SurgeStorage
         std::uniform_int_distribution<uint32_t> u32;
     } rngGen;
 
+    /*
+     * While a scene renders, which may be on a worker thread, the calls below draw from that
+     * scene's generator rather than rngGen, so scenes never share random state and their draws
+     * don't depend on which thread got there first. ThreadRNGScope installs one on this thread.
+     */
+    static inline thread_local RNGGen *threadRNG{nullptr};
+    struct ThreadRNGScope
+    {
+        explicit ThreadRNGScope(RNGGen &g) : prior(threadRNG) { threadRNG = &g; }
+        ~ThreadRNGScope() { threadRNG = prior; }
+        RNGGen *prior;
+    };
+    inline RNGGen &activeRNG() { return threadRNG ? *threadRNG : rngGen; }
+
 #define DEBUG_RNG_THREADING 0
-#if DEBUG_RNG_THREADING
+#if DEBUG_RNG_THREADING || SURGE_RT_SAFETY_CHECKS
     std::thread::id audioThreadID{0};
+#endif
+#if DEBUG_RNG_THREADING
     inline void runningOnAudioThread()
     {
-        if (audioThreadID && std::this_thread::get_id() != audioThreadID)
+        if (!threadRNG && audioThreadID && std::this_thread::get_id() != audioThreadID)
         {
             std::cout << "BUM CALL ON NON AUDIO THREAD" << std::endl;
         }
@@ -1687,22 +1781,26 @@ class alignas(16) SurgeStorage
     inline int rand()
     {
         runningOnAudioThread();
-        return rngGen.d(rngGen.g);
+        auto &r = activeRNG();
+        return r.d(r.g);
     }
     inline uint32_t rand_u32()
     {
         runningOnAudioThread();
-        return rngGen.u32(rngGen.g);
+        auto &r = activeRNG();
+        return r.u32(r.g);
     }
     inline float rand_pm1()
     {
         runningOnAudioThread();
-        return rngGen.pm1(rngGen.g);
+        auto &r = activeRNG();
+        return r.pm1(r.g);
     }
     inline float rand_01()
     {
         runningOnAudioThread();
-        return rngGen.z1(rngGen.g);
+        auto &r = activeRNG();
+        return r.z1(r.g);
     }
 // void seed_rand(int s) { rngGen.g.seed(s); }
 #else
@@ -40,6 +40,7 @@
 #endif
 
 #include "SurgeMemoryPools.h"
+#include "DebugHelpers.h"
 
 #include "sst/basic-blocks/mechanics/block-ops.h"
 #include "sst/basic-blocks/dsp/Clippers.h"
@@ -67,6 +68,8 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer *parent, const std::string &suppl
     load_fx_needed = true;
     process_input = false; // hosts set this if there are input busses
 
+    seedSceneRNGs(std::chrono::system_clock::now().time_since_epoch().count());
+
     fx_suspend_bitmask = 0;
 
     for (int i = 0; i < n_fx_slots; ++i)
@@ -416,6 +419,8 @@ int SurgeSynthesizer::calculateChannelMask(int channel, int key)
 void SurgeSynthesizer::playNote(char channel, char key, char velocity, char detune,
                                 int32_t host_noteid, int32_t forceScene)
 {
+    SURGE_AUDIO_THREAD_SCOPE(true);
+
     if (halt_engine)
     {
         return;
@@ -537,7 +542,7 @@ void SurgeSynthesizer::playNoteByFrequency(float freq, char velocity, int32_t id
 
 void SurgeSynthesizer::softkillVoice(int s)
 {
-    list<SurgeVoice *>::iterator iter, max_playing, max_released;
+    voicelist_t::iterator iter, max_playing, max_released;
     int max_age = -1, max_age_release = -1;
     iter = voices[s].begin();
 
@@ -572,7 +577,7 @@ void SurgeSynthesizer::softkillVoice(int s)
 // only allow 'margin' number of voices to be softkilled simultaneously
 void SurgeSynthesizer::enforcePolyphonyLimit(int s, int margin)
 {
-    list<SurgeVoice *>::iterator iter;
+    voicelist_t::iterator iter;
 
     int paddedPoly = std::min((storage.getPatch().polylimit.val.i + margin), MAX_VOICES - 1);
     if (voices[s].size() > paddedPoly)
@@ -814,6 +819,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
                                         &channelState[mpeMainChannel], &channelState[channel],
                                         mpeEnabled, voiceCounter++, host_noteid,
                                         host_originating_key, host_originating_channel, 0.f, 0.f);
+                nvoice->setStartOffset(blockEventOffset * OSC_OVERSAMPLING);
             }
         }
         break;
@@ -822,7 +828,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
     case pm_mono_fp:
     case pm_latch:
     {
-        list<SurgeVoice *>::const_iterator iter;
+        voicelist_t::const_iterator iter;
         bool glide = false;
 
         int primode = storage.getPatch().scene[scene].monoVoicePriorityMode;
@@ -952,6 +958,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
                         &channelState[channel].keyState[key], &channelState[mpeMainChannel],
                         &channelState[channel], mpeEnabled, voiceCounter++, host_noteid,
                         host_originating_key, host_originating_channel, aegReuse, fegReuse);
+                    nvoice->setStartOffset(blockEventOffset * OSC_OVERSAMPLING);
                 }
             }
         }
@@ -1030,7 +1037,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
 
         if (createVoice)
         {
-            list<SurgeVoice *>::const_iterator iter;
+            voicelist_t::const_iterator iter;
             SurgeVoice *recycleThis{nullptr};
             float aegStart{0.}, fegStart{0.};
             for (iter = voices[scene].begin(); iter != voices[scene].end(); iter++)
@@ -1085,6 +1092,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
                         &channelState[channel].keyState[key], &channelState[mpeMainChannel],
                         &channelState[channel], mpeEnabled, voiceCounter++, host_noteid,
                         host_originating_key, host_originating_channel, aegStart, fegStart);
+                    nvoice->setStartOffset(blockEventOffset * OSC_OVERSAMPLING);
                 }
             }
             else
@@ -1125,7 +1133,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
 
 void SurgeSynthesizer::releaseScene(int s)
 {
-    list<SurgeVoice *>::const_iterator iter;
+    voicelist_t::const_iterator iter;
     for (iter = voices[s].begin(); iter != voices[s].end(); iter++)
     {
         freeVoice(*iter);
@@ -1148,6 +1156,8 @@ void SurgeSynthesizer::releaseScene(int s)
 
 void SurgeSynthesizer::chokeNote(int16_t channel, int16_t key, char velocity, int32_t host_noteid)
 {
+    SURGE_AUDIO_THREAD_SCOPE(true);
+
     /*
      * The strategy here is pretty simple. Do a release note, then go find any voice
      * that matches me and do an uber-release. There may be some wierdo MPE mono
@@ -1170,6 +1180,8 @@ void SurgeSynthesizer::chokeNote(int16_t channel, int16_t key, char velocity, in
 
 void SurgeSynthesizer::releaseNote(char channel, char key, char velocity, int32_t host_noteid)
 {
+    SURGE_AUDIO_THREAD_SCOPE(true);
+
     midiNoteEvents++;
     bool foundVoice[n_scenes];
     for (int sc = 0; sc < n_scenes; ++sc)
@@ -1271,7 +1283,7 @@ void SurgeSynthesizer::releaseNotePostHoldCheck(int scene, char channel, char ke
                                                 int32_t host_noteid)
 {
     channelState[channel].keyState[key].keystate = 0;
-    list<SurgeVoice *>::const_iterator iter;
+    voicelist_t::const_iterator iter;
     for (int s = 0; s < n_scenes; s++)
     {
         bool do_switch = false;
@@ -1763,6 +1775,8 @@ void SurgeSynthesizer::releaseNotePostHoldCheck(int scene, char channel, char ke
 
 void SurgeSynthesizer::releaseNoteByHostNoteID(int32_t host_noteid, char velocity)
 {
+    SURGE_AUDIO_THREAD_SCOPE(true);
+
     std::array<uint16_t, 128> done;
     std::fill(done.begin(), done.end(), 0);
 
@@ -1823,6 +1837,8 @@ void SurgeSynthesizer::releaseNoteByHostNoteID(int32_t host_noteid, char velocit
 void SurgeSynthesizer::setNoteExpression(SurgeVoice::NoteExpressionType net, int32_t note_id,
                                          int16_t key, int16_t channel, float value)
 {
+    SURGE_AUDIO_THREAD_SCOPE(true);
+
     for (int sc = 0; sc < n_scenes; sc++)
     {
         for (auto v : voices[sc])
@@ -1923,6 +1939,8 @@ void SurgeSynthesizer::resetPitchBend(int8_t channel)
 
 void SurgeSynthesizer::pitchBend(char channel, int value)
 {
+    SURGE_AUDIO_THREAD_SCOPE(true);
+
     if (mpeEnabled && channel != 0)
     {
         channelState[channel].pitchBend = value;
@@ -1964,6 +1982,8 @@ void SurgeSynthesizer::pitchBend(char channel, int value)
 
 void SurgeSynthesizer::channelAftertouch(char channel, int value)
 {
+    SURGE_AUDIO_THREAD_SCOPE(true);
+
     float fval = (float)value / 127.f;
 
     channelState[channel].pressure = fval;
@@ -1980,6 +2000,8 @@ void SurgeSynthesizer::channelAftertouch(char channel, int value)
 
 void SurgeSynthesizer::polyAftertouch(char channel, int key, int value)
 {
+    SURGE_AUDIO_THREAD_SCOPE(true);
+
     float fval = (float)value / 127.f;
     storage.poly_aftertouch[0][channel][key & 127] = fval;
     storage.poly_aftertouch[1][channel][key & 127] = fval;
@@ -2073,6 +2095,8 @@ float int7ToBipolarFloat(int x)
 
 void SurgeSynthesizer::channelController(char channel, int cc, int value)
 {
+    SURGE_AUDIO_THREAD_SCOPE(true);
+
     float fval = (float)value * (1.f / 127.f);
 
     // store all possible NRPN & RPNs in a short array... amounts to 128 KB or thereabouts
@@ -2429,6 +2453,8 @@ void SurgeSynthesizer::purgeDuplicateHeldVoicesInPolyMode(int scene, int channel
 
 void SurgeSynthesizer::allNotesOff()
 {
+    SURGE_AUDIO_THREAD_SCOPE(true);
+
     for (int i = 0; i < 16; i++)
     {
         channelState[i].hold = false;
@@ -2443,7 +2469,7 @@ void SurgeSynthesizer::allNotesOff()
 
     for (int s = 0; s < n_scenes; s++)
     {
-        list<SurgeVoice *>::const_iterator iter;
+        voicelist_t::const_iterator iter;
         for (iter = voices[s].begin(); iter != voices[s].end(); iter++)
         {
             freeVoice(*iter);
@@ -2607,6 +2633,8 @@ void SurgeSynthesizer::setParameterSmoothed(long index, float value)
 
 bool SurgeSynthesizer::setParameter01(long index, float value, bool external, bool force_integer)
 {
+    SURGE_AUDIO_THREAD_SCOPE(external);
+
     // does the parameter exist in the interpolator array? If it does, delete it
     ReleaseControlInterpolator(index);
     bool need_refresh = false;
@@ -2828,7 +2856,7 @@ void SurgeSynthesizer::switch_toggled()
 {
     for (int s = 0; s < n_scenes; s++)
     {
-        list<SurgeVoice *>::iterator iter;
+        voicelist_t::iterator iter;
         for (iter = voices[s].begin(); iter != voices[s].end(); iter++)
         {
             SurgeVoice *v = *iter;
@@ -2839,6 +2867,9 @@ void SurgeSynthesizer::switch_toggled()
 
 bool SurgeSynthesizer::loadFx(bool initp, bool force_reload_all)
 {
+    // the routing clears and restores below publish one snapshot between them, not one each
+    SurgeStorage::ModulationRoutingBatch routingBatch(storage);
+
     load_fx_needed = false;
     for (int s = 0; s < n_fx_slots; s++)
     {
@@ -3464,7 +3495,11 @@ void SurgeSynthesizer::muteModulation(long ptag, modsources modsource, int modso
     ModulationRouting *r = getModRouting(ptag, modsource, modsourceScene, index);
     if (r)
     {
-        r->muted = mute;
+        {
+            std::lock_guard<std::recursive_mutex> mg(storage.modRoutingMutex);
+            r->muted = mute;
+            storage.publishModulationRouting();
+        }
         storage.getPatch().isDirty = true;
 
         for (auto l : modListeners)
@@ -3474,6 +3509,8 @@ void SurgeSynthesizer::muteModulation(long ptag, modsources modsource, int modso
 
 void SurgeSynthesizer::applyParameterMonophonicModulation(Parameter *p, float depth)
 {
+    SURGE_AUDIO_THREAD_SCOPE(true);
+
     auto &pt = storage.getPatch();
     if (pt.paramModulationCount >= pt.maxMonophonicParamModulations)
     {
@@ -3531,6 +3568,8 @@ void SurgeSynthesizer::applyParameterMonophonicModulation(Parameter *p, float de
 void SurgeSynthesizer::applyParameterPolyphonicModulation(Parameter *p, int32_t note_id,
                                                           int16_t key, int16_t channel, float depth)
 {
+    SURGE_AUDIO_THREAD_SCOPE(true);
+
     // in theory, a parameter without a scene will never get poly modulation applied
     if (p->scene == 0)
         return;
@@ -3587,6 +3626,7 @@ void SurgeSynthesizer::clear_osc_modulation(int scene, int entry)
         else
             iter++;
     }
+    storage.publishModulationRouting();
     storage.modRoutingMutex.unlock();
 }
 
@@ -3670,6 +3710,7 @@ void SurgeSynthesizer::clearModulation(long ptag, modsources modsource, int mods
         {
             storage.modRoutingMutex.lock();
             modlist->erase(modlist->begin() + i);
+            storage.publishModulationRouting();
             storage.modRoutingMutex.unlock();
             storage.getPatch().isDirty = true;
 
@@ -3748,6 +3789,7 @@ bool SurgeSynthesizer::setModDepth01(long ptag, modsources modsource, int modsou
             modlist->at(found_id).depth = value;
         }
     }
+    storage.publishModulationRouting();
     storage.modRoutingMutex.unlock();
 
     for (auto l : modListeners)
@@ -3769,6 +3811,8 @@ float SurgeSynthesizer::getMacroParameterTarget01(long macroNum) const
 
 void SurgeSynthesizer::setMacroParameter01(long macroNum, float val)
 {
+    SURGE_AUDIO_THREAD_SCOPE(true);
+
     storage.getPatch().isDirty = true;
     ((ControllerModulationSource *)storage.getPatch().scene[0].modsources[ms_ctrl1 + macroNum])
         ->set_target01(val, true);
@@ -4182,19 +4226,15 @@ void SurgeSynthesizer::processControl()
             // for(int i=0; i<n_lfos_scene; i++)
             // storage.getPatch().scene[s].modsources[ms_slfo1+i]->process_block();
 
-            int n = storage.getPatch().scene[s].modulation_scene.size();
-            for (int i = 0; i < n; i++)
+            for (const auto &r : storage.audioModRouting->scene[s])
             {
-                int src_id = storage.getPatch().scene[s].modulation_scene[i].source_id;
-                int src_index = storage.getPatch().scene[s].modulation_scene[i].source_index;
-                if (storage.getPatch().scene[s].modsources[src_id])
+                if (storage.getPatch().scene[s].modsources[r.source_id])
                 {
-                    int dst_id = storage.getPatch().scene[s].modulation_scene[i].destination_id;
-                    float depth = storage.getPatch().scene[s].modulation_scene[i].depth;
-                    storage.getPatch().scenedata[s][dst_id].f +=
-                        depth *
-                        storage.getPatch().scene[s].modsources[src_id]->get_output(src_index) *
-                        (1.0 - storage.getPatch().scene[s].modulation_scene[i].muted);
+                    storage.getPatch().scenedata[s][r.destination_id].f +=
+                        r.depth *
+                        storage.getPatch().scene[s].modsources[r.source_id]->get_output(
+                            r.source_index) *
+                        (1.0 - r.muted);
                 }
             }
 
@@ -4217,16 +4257,11 @@ void SurgeSynthesizer::processControl()
 
     loadOscalgos();
 
-    int n = storage.getPatch().modulation_global.size();
-    for (int i = 0; i < n; i++)
+    for (const auto &r : storage.audioModRouting->global)
     {
-        int src_id = storage.getPatch().modulation_global[i].source_id;
-        int dst_id = storage.getPatch().modulation_global[i].destination_id;
-        float depth = storage.getPatch().modulation_global[i].depth;
-        int source_scene = storage.getPatch().modulation_global[i].source_scene;
-        storage.getPatch().globaldata[dst_id].f +=
-            depth * storage.getPatch().scene[source_scene].modsources[src_id]->get_output(0) *
-            (1 - storage.getPatch().modulation_global[i].muted);
+        auto *ms = storage.getPatch().scene[r.source_scene].modsources[r.source_id];
+        storage.getPatch().globaldata[r.destination_id].f +=
+            r.depth * ms->get_output(0) * (1 - r.muted);
     }
 
     if (switch_toggled_queued)
@@ -4235,8 +4270,15 @@ void SurgeSynthesizer::processControl()
         switch_toggled_queued = false;
     }
 
-    if (load_fx_needed)
+    /*
+     * Reloading an FX edits the routing (and fxmodsync, which reorderFx fills under the same
+     * lock), so it needs modRoutingMutex. Rather than wait on the UI for it, try next block.
+     */
+    if (load_fx_needed && storage.modRoutingMutex.try_lock())
+    {
         loadFx(false, false);
+        storage.modRoutingMutex.unlock();
+    }
 
     if (fx_suspend_bitmask)
     {
@@ -4284,18 +4326,299 @@ void SurgeSynthesizer::processControl()
 #endif
 }
 
+void SurgeSynthesizer::renderScene(int s, bool onWorkerPool)
+{
+    /*
+     * Run the voices of scene s, then its quad filter chain. The voices read their routings
+     * from the snapshot process() acquired for this block, so there's no lock to hold. On the
+     * worker pool finished voices are handed back to process() rather than freed here.
+     */
+    SurgeStorage::ThreadRNGScope rngScope(sceneRNG[s]);
+
+    namespace prof = Surge::Profiling;
+    auto &profiler = storage.processProfiler;
+
+    int FBentry = 0;
+    auto iter = voices[s].begin();
+    {
+        prof::StageTimer voiceTimer(profiler, prof::voiceStage(s));
+
+        voiceLFOBank[s].process(storage.getPatch().scene[s], voices[s].begin(),
+                                (int)voices[s].size());
+
+        while (iter != voices[s].end())
+        {
+            SurgeVoice *v = *iter;
+            assert(v);
+            bool resume = v->process_block(FBQ[s][FBentry >> 2], FBentry & 3);
+            FBentry++;
+
+            if (!resume)
+            {
+                if (onWorkerPool)
+                {
+                    deferredFreeVoices[s][deferredFreeVoiceCount[s]++] = v;
+                    iter++;
+                }
+                else
+                {
+                    freeVoice(v);
+                    iter = voices[s].erase(iter);
+                }
+            }
+            else
+                iter++;
+        }
+    }
+
+    prof::StageTimer filterChainTimer(profiler, prof::filterChainStage(s));
+
+    sceneVoiceCount[s] = FBentry;
+
+    using sst::filters::FilterType, sst::filters::FilterSubType;
+    fbq_global g;
+    if (storage.getPatch().scene[s].filterunit[0].type.deactivated)
+    {
+        g.FU1ptr = nullptr;
+    }
+    else
+    {
+        g.FU1ptr = sst::filters::GetQFPtrFilterUnit(
+            static_cast<FilterType>(storage.getPatch().scene[s].filterunit[0].type.val.i),
+            static_cast<FilterSubType>(storage.getPatch().scene[s].filterunit[0].subtype.val.i));
+    }
+    if (storage.getPatch().scene[s].filterunit[1].type.deactivated)
+    {
+        g.FU2ptr = nullptr;
+    }
+    else
+    {
+        g.FU2ptr = sst::filters::GetQFPtrFilterUnit(
+            static_cast<FilterType>(storage.getPatch().scene[s].filterunit[1].type.val.i),
+            static_cast<FilterSubType>(storage.getPatch().scene[s].filterunit[1].subtype.val.i));
+    }
+
+    if (storage.getPatch().scene[s].wsunit.type.deactivated)
+    {
+        g.WSptr = nullptr;
+    }
+    else
+    {
+        g.WSptr = sst::waveshapers::GetQuadWaveshaper(static_cast<sst::waveshapers::WaveshaperType>(
+            storage.getPatch().scene[s].wsunit.type.val.i));
+    }
+
+    FBQFPtr ProcessQuadFB =
+        GetFBQPointer(storage.getPatch().scene[s].filterblock_configuration.val.i,
+                      g.FU1ptr != 0, g.WSptr != 0, g.FU2ptr != 0);
+
+    for (int e = 0; e < FBentry; e += 4)
+    {
+        int units = FBentry - e;
+        for (int i = units; i < 4; i++)
+        {
+            FBQ[s][e >> 2].FU[0].active[i] = 0;
+            FBQ[s][e >> 2].FU[1].active[i] = 0;
+            FBQ[s][e >> 2].FU[2].active[i] = 0;
+            FBQ[s][e >> 2].FU[3].active[i] = 0;
+        }
+        ProcessQuadFB(FBQ[s][e >> 2], g, sceneout[s][0], sceneout[s][1]);
+    }
+
+    if (s == 0 && storage.otherscene_clients > 0)
+    {
+        // Make available for scene B
+        mech::copy_from_to<BLOCK_SIZE_OS>(sceneout[0][0], storage.audio_otherscene[0]);
+        mech::copy_from_to<BLOCK_SIZE_OS>(sceneout[0][1], storage.audio_otherscene[1]);
+    }
+
+    iter = voices[s].begin();
+
+    while (iter != voices[s].end())
+    {
+        SurgeVoice *v = *iter;
+        assert(v);
+        v->GetQFB(); // save filter state in voices after quad processing is done
+        iter++;
+    }
+
+    // mute scene
+    if (storage.getPatch().scene[s].volume.deactivated)
+    {
+        mech::clear_block<BLOCK_SIZE_OS>(sceneout[s][0]);
+        mech::clear_block<BLOCK_SIZE_OS>(sceneout[s][1]);
+    }
+}
+
+void SurgeSynthesizer::setParallelSceneRendering(bool b)
+{
+    if (b && !sceneRenderPool)
+    {
+        // one worker joins the audio thread, which renders the other scene itself
+        sceneRenderPool = std::make_unique<Surge::Threading::WorkerPool>(n_scenes - 1);
+    }
+
+    parallelSceneRendering.store(b, std::memory_order_release);
+}
+
+void SurgeSynthesizer::seedRNG(uint32_t seed)
+{
+    storage.rngGen.g.seed(seed);
+    seedSceneRNGs(seed);
+}
+
+/*
+ * Seeding minstd_rand generators with neighbouring values gives streams which stay correlated
+ * for a long while, so each scene's seed goes through SplitMix64 from its own far apart point.
+ */
+void SurgeSynthesizer::seedSceneRNGs(uint64_t base)
+{
+    for (int s = 0; s < n_scenes; s++)
+    {
+        uint64_t z = base + (s + 1) * 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z = z ^ (z >> 31);
+
+        // minstd_rand wants a seed in [1, modulus)
+        sceneRNG[s].g.seed((uint32_t)(z % (std::minstd_rand::modulus - 1)) + 1);
+    }
+}
+
+void SurgeSynthesizer::setParallelFXRendering(bool b)
+{
+    if (b && !fxRenderPool)
+    {
+        // as with scenes the audio thread takes one of the chains
+        fxRenderPool = std::make_unique<Surge::Threading::WorkerPool>(max_fx_chains - 1);
+    }
+
+    parallelFXRendering.store(b, std::memory_order_release);
+}
+
+namespace
+{
+// the slots of each fx chain in the order they run, by phase
+const int fxInsertChainSlots[n_scenes][4] = {
+    {fxslot_ains1, fxslot_ains2, fxslot_ains3, fxslot_ains4},
+    {fxslot_bins1, fxslot_bins2, fxslot_bins3, fxslot_bins4}};
+const int fxSendSlots[n_send_slots] = {fxslot_send1, fxslot_send2, fxslot_send3, fxslot_send4};
+} // namespace
+
+bool SurgeSynthesizer::isFXSlotActive(int slot) const
+{
+    return fx[slot] && !(storage.getPatch().fx_disable.val.i & (1 << slot));
+}
+
+bool SurgeSynthesizer::runFXSlot(int slot, float *dataL, float *dataR, bool indata_present)
+{
+    Surge::Profiling::StageTimer fxTimer(storage.processProfiler,
+                                         Surge::Profiling::fxStage(slot));
+    fxRan[slot] = true;
+    return fx[slot]->process_ringout(dataL, dataR, indata_present);
+}
+
+void SurgeSynthesizer::runFXChain(int phase, int chain)
+{
+    if (phase == fxp_inserts)
+    {
+        for (auto v : fxInsertChainSlots[chain])
+        {
+            if (isFXSlotActive(v))
+            {
+                fxSceneState[chain] =
+                    runFXSlot(v, sceneout[chain][0], sceneout[chain][1], fxSceneState[chain]);
+            }
+        }
+        return;
+    }
+
+    // a send only writes its own buffer; process() sums the returns once they're all done
+    auto slot = fxSendSlots[chain];
+    if (isFXSlotActive(slot))
+    {
+        auto &buf = fxSendBuffers[chain];
+        send[chain][0].MAC_2_blocks_to(sceneout[0][0], sceneout[0][1], buf[0], buf[1],
+                                       BLOCK_SIZE_QUAD);
+        send[chain][1].MAC_2_blocks_to(sceneout[1][0], sceneout[1][1], buf[0], buf[1],
+                                       BLOCK_SIZE_QUAD);
+        fxSendUsed[chain] = runFXSlot(slot, buf[0], buf[1], fxSendInput);
+    }
+}
+
+void SurgeSynthesizer::runFXPhase(int phase)
+{
+    int nChains = phase == fxp_inserts ? n_scenes : n_send_slots;
+
+    if (parallelFXRendering.load(std::memory_order_acquire) && fxRenderPool)
+    {
+        /*
+         * Chains with an effect on the shared RNG make up one task between them, run in chain
+         * order. Every other chain with anything to run is a task of its own.
+         */
+        uint32_t activeChains = 0, sharedRNGChains = 0;
+        for (int c = 0; c < nChains; ++c)
+        {
+            auto check = [&](int slot) {
+                if (isFXSlotActive(slot))
+                {
+                    activeChains |= 1 << c;
+                    if (fx[slot]->drawsFromSharedRNG())
+                        sharedRNGChains |= 1 << c;
+                }
+            };
+
+            if (phase == fxp_inserts)
+                for (auto v : fxInsertChainSlots[c])
+                    check(v);
+            else
+                check(fxSendSlots[c]);
+        }
+
+        int nTasks = 0;
+        if (sharedRNGChains)
+            fxTaskChains[nTasks++] = sharedRNGChains;
+        for (int c = 0; c < nChains; ++c)
+            if ((activeChains & ~sharedRNGChains) & (1 << c))
+                fxTaskChains[nTasks++] = 1 << c;
+
+        if (nTasks > 1)
+        {
+            fxTaskPhase = phase;
+            fxRenderPool->run(
+                nTasks,
+                [](void *that, int t) {
+                    auto synth = static_cast<SurgeSynthesizer *>(that);
+                    for (int c = 0; c < max_fx_chains; ++c)
+                        if (synth->fxTaskChains[t] & (1 << c))
+                            synth->runFXChain(synth->fxTaskPhase, c);
+                },
+                this);
+            return;
+        }
+    }
+
+    for (int c = 0; c < nChains; ++c)
+        runFXChain(phase, c);
+}
+
 void SurgeSynthesizer::process()
 {
-#if DEBUG_RNG_THREADING
+#if DEBUG_RNG_THREADING || SURGE_RT_SAFETY_CHECKS
     storage.audioThreadID = std::this_thread::get_id();
 #endif
+    SURGE_AUDIO_THREAD_SCOPE(true);
     processRunning = 0;
 
 #if DEBUG
     memset(endedHostNoteIds, 0, 512 * sizeof(int32_t));
 #endif
 
+    namespace prof = Surge::Profiling;
+    auto &profiler = storage.processProfiler;
+
     auto process_start = std::chrono::high_resolution_clock::now();
+    profiler.beginBlock();
 
     if (hostNoteEndedToPushToNextBlock)
     {
@@ -4398,8 +4721,12 @@ void SurgeSynthesizer::process()
         }
     }
 
-    storage.modRoutingMutex.lock();
-    processControl();
+    // pick up any routing edits published since the last block; see SurgeStorage
+    storage.acquireModulationRoutingForBlock();
+    {
+        prof::StageTimer controlTimer(profiler, prof::pst_processControl);
+        processControl();
+    }
 
     amp.set_target_smoothed(
         storage.db_to_linear(storage.getPatch().globaldata[storage.getPatch().volume.id].f));
@@ -4432,121 +4759,59 @@ void SurgeSynthesizer::process()
         }
     }
 
-    list<SurgeVoice *>::iterator iter;
-
     for (int sc = 0; sc < n_scenes; sc++)
     {
         play_scene[sc] = (!voices[sc].empty());
     }
 
-    int FBentry[n_scenes];
-    int vcount = 0;
+    /*
+     * Scenes only meet again at the insert FX sum, so with both of them playing we can render
+     * them concurrently. Scene B can listen to scene A through audio_otherscene though, in which
+     * case the order matters and we stay serial.
+     */
+    bool renderScenesInParallel = parallelSceneRendering.load(std::memory_order_acquire) &&
+                                  sceneRenderPool && storage.otherscene_clients == 0;
 
     for (int s = 0; s < n_scenes; s++)
     {
-        FBentry[s] = 0;
-        iter = voices[s].begin();
-        while (iter != voices[s].end())
-        {
-            SurgeVoice *v = *iter;
-            assert(v);
-            bool resume = v->process_block(FBQ[s][FBentry[s] >> 2], FBentry[s] & 3);
-            FBentry[s]++;
-
-            vcount++;
-
-            if (!resume)
-            {
-                freeVoice(v);
-                iter = voices[s].erase(iter);
-            }
-            else
-                iter++;
-        }
-
-        storage.modRoutingMutex.unlock();
-
-        using sst::filters::FilterType, sst::filters::FilterSubType;
-        fbq_global g;
-        if (storage.getPatch().scene[s].filterunit[0].type.deactivated)
-        {
-            g.FU1ptr = nullptr;
-        }
-        else
-        {
-            g.FU1ptr = sst::filters::GetQFPtrFilterUnit(
-                static_cast<FilterType>(storage.getPatch().scene[s].filterunit[0].type.val.i),
-                static_cast<FilterSubType>(
-                    storage.getPatch().scene[s].filterunit[0].subtype.val.i));
-        }
-        if (storage.getPatch().scene[s].filterunit[1].type.deactivated)
-        {
-            g.FU2ptr = nullptr;
-        }
-        else
-        {
-            g.FU2ptr = sst::filters::GetQFPtrFilterUnit(
-                static_cast<FilterType>(storage.getPatch().scene[s].filterunit[1].type.val.i),
-                static_cast<FilterSubType>(
-                    storage.getPatch().scene[s].filterunit[1].subtype.val.i));
-        }
+        renderScenesInParallel = renderScenesInParallel && play_scene[s];
+    }
 
-        if (storage.getPatch().scene[s].wsunit.type.deactivated)
-        {
-            g.WSptr = nullptr;
-        }
-        else
-        {
-            g.WSptr =
-                sst::waveshapers::GetQuadWaveshaper(static_cast<sst::waveshapers::WaveshaperType>(
-                    storage.getPatch().scene[s].wsunit.type.val.i));
-        }
+    int vcount = 0;
 
-        FBQFPtr ProcessQuadFB =
-            GetFBQPointer(storage.getPatch().scene[s].filterblock_configuration.val.i,
-                          g.FU1ptr != 0, g.WSptr != 0, g.FU2ptr != 0);
+    if (renderScenesInParallel)
+    {
+        sceneRenderPool->run(
+            n_scenes,
+            [](void *that, int s) { static_cast<SurgeSynthesizer *>(that)->renderScene(s, true); },
+            this);
 
-        for (int e = 0; e < FBentry[s]; e += 4)
+        // freeVoice looks at every scene's voice list so it has to wait for the barrier
+        for (int s = 0; s < n_scenes; s++)
         {
-            int units = FBentry[s] - e;
-            for (int i = units; i < 4; i++)
+            for (int i = 0; i < deferredFreeVoiceCount[s]; ++i)
             {
-                FBQ[s][e >> 2].FU[0].active[i] = 0;
-                FBQ[s][e >> 2].FU[1].active[i] = 0;
-                FBQ[s][e >> 2].FU[2].active[i] = 0;
-                FBQ[s][e >> 2].FU[3].active[i] = 0;
+                auto v = deferredFreeVoices[s][i];
+                freeVoice(v);
+                voices[s].remove(v);
             }
-            ProcessQuadFB(FBQ[s][e >> 2], g, sceneout[s][0], sceneout[s][1]);
-        }
 
-        if (s == 0 && storage.otherscene_clients > 0)
-        {
-            // Make available for scene B
-            mech::copy_from_to<BLOCK_SIZE_OS>(sceneout[0][0], storage.audio_otherscene[0]);
-            mech::copy_from_to<BLOCK_SIZE_OS>(sceneout[0][1], storage.audio_otherscene[1]);
+            deferredFreeVoiceCount[s] = 0;
         }
-
-        iter = voices[s].begin();
-
-        while (iter != voices[s].end())
+    }
+    else
+    {
+        for (int s = 0; s < n_scenes; s++)
         {
-            SurgeVoice *v = *iter;
-            assert(v);
-            v->GetQFB(); // save filter state in voices after quad processing is done
-            iter++;
+            renderScene(s, false);
         }
+    }
 
-        storage.modRoutingMutex.lock();
-
-        // mute scene
-        if (storage.getPatch().scene[s].volume.deactivated)
-        {
-            mech::clear_block<BLOCK_SIZE_OS>(sceneout[s][0]);
-            mech::clear_block<BLOCK_SIZE_OS>(sceneout[s][1]);
-        }
+    for (int s = 0; s < n_scenes; s++)
+    {
+        vcount += sceneVoiceCount[s];
     }
 
-    storage.modRoutingMutex.unlock();
     polydisplay = vcount;
 
     // TODO: FIX SCENE ASSUMPTION
@@ -4566,6 +4831,7 @@ void SurgeSynthesizer::process()
             break;
         }
 
+        prof::StageTimer halfbandTimer(profiler, prof::halfbandStage(0));
         halfbandA.process_block_D2(sceneout[0][0], sceneout[0][1], BLOCK_SIZE_OS);
     }
 
@@ -4585,6 +4851,7 @@ void SurgeSynthesizer::process()
             break;
         }
 
+        prof::StageTimer halfbandTimer(profiler, prof::halfbandStage(1));
         halfbandB.process_block_D2(sceneout[1][0], sceneout[1][1], BLOCK_SIZE_OS);
     }
 
@@ -4646,24 +4913,14 @@ void SurgeSynthesizer::process()
         for (int channel = 0; channel < N_OUTPUTS; channel++)
             storage.scenesOutputData.provideSceneData(i, channel, sceneout[i][channel]);
 
+    std::fill(std::begin(fxRan), std::end(fxRan), false);
+
     // apply insert effects
     if (fx_bypass != fxb_no_fx)
     {
-        for (auto v : {fxslot_ains1, fxslot_ains2, fxslot_ains3, fxslot_ains4})
-        {
-            if (fx[v] && !(storage.getPatch().fx_disable.val.i & (1 << v)))
-            {
-                sc_state[0] = fx[v]->process_ringout(sceneout[0][0], sceneout[0][1], sc_state[0]);
-            }
-        }
-
-        for (auto v : {fxslot_bins1, fxslot_bins2, fxslot_bins3, fxslot_bins4})
-        {
-            if (fx[v] && !(storage.getPatch().fx_disable.val.i & (1 << v)))
-            {
-                sc_state[1] = fx[v]->process_ringout(sceneout[1][0], sceneout[1][1], sc_state[1]);
-            }
-        }
+        std::copy(std::begin(sc_state), std::end(sc_state), std::begin(fxSceneState));
+        runFXPhase(fxp_inserts);
+        std::copy(std::begin(fxSceneState), std::end(fxSceneState), std::begin(sc_state));
     }
 
     for (int cls = 0; cls < n_scenes; ++cls)
@@ -4695,19 +4952,20 @@ void SurgeSynthesizer::process()
     // TODO: FIX SCENE ASSUMPTION
     if (fx_bypass == fxb_all_fx)
     {
+        fxSendBuffers = fxsendout;
+        fxSendInput = sc_state[0] || sc_state[1];
+        std::fill(std::begin(fxSendUsed), std::end(fxSendUsed), false);
+        runFXPhase(fxp_sends);
+
+        // the returns are summed in slot order whichever thread ran each send
         for (auto si : sendToIndex)
         {
             auto slot = si[0];
             auto idx = si[1];
 
-            if (fx[slot] && !(storage.getPatch().fx_disable.val.i & (1 << slot)))
+            if (fxRan[slot])
             {
-                send[idx][0].MAC_2_blocks_to(sceneout[0][0], sceneout[0][1], fxsendout[idx][0],
-                                             fxsendout[idx][1], BLOCK_SIZE_QUAD);
-                send[idx][1].MAC_2_blocks_to(sceneout[1][0], sceneout[1][1], fxsendout[idx][0],
-                                             fxsendout[idx][1], BLOCK_SIZE_QUAD);
-                sendused[idx] = fx[slot]->process_ringout(fxsendout[idx][0], fxsendout[idx][1],
-                                                          sc_state[0] || sc_state[1]);
+                sendused[idx] = fxSendUsed[idx];
                 FX[idx].MAC_2_blocks_to(fxsendout[idx][0], fxsendout[idx][1], output[0], output[1],
                                         BLOCK_SIZE_QUAD);
             }
@@ -4723,10 +4981,16 @@ void SurgeSynthesizer::process()
 
         for (auto v : {fxslot_global1, fxslot_global2, fxslot_global3, fxslot_global4})
         {
-            if (fx[v] && !(storage.getPatch().fx_disable.val.i & (1 << v)))
-            {
-                glob = fx[v]->process_ringout(output[0], output[1], glob);
-            }
+            if (isFXSlotActive(v))
+                glob = runFXSlot(v, output[0], output[1], glob);
+        }
+    }
+
+    if (profiler.isActive())
+    {
+        for (int i = 0; i < n_fx_slots; ++i)
+        {
+            profiler.setFXAsleep(i, !fxRan[i] || fx[i]->isSleeping());
         }
     }
 
@@ -4779,6 +5043,10 @@ void SurgeSynthesizer::process()
     auto smoothed_ratio = (c * (window - 1) + ratio) / window;
     c = c * storage.cpu_falloff;
     cpu_level.store(max(c, smoothed_ratio));
+
+    blockEventOffset = 0;
+
+    profiler.endBlock();
 }
 
 SurgeSynthesizer::PluginLayer *SurgeSynthesizer::getParent()
@@ -5005,6 +5273,7 @@ void SurgeSynthesizer::swapMetaControllers(int c1, int c2)
         }
     }
 
+    storage.publishModulationRouting();
     storage.modRoutingMutex.unlock();
 
     refresh_editor = true;
@@ -5027,6 +5296,27 @@ void SurgeSynthesizer::changeModulatorSmoothing(Modulator::SmoothingMode m)
     }
 }
 
+void SurgeSynthesizer::setFxFilePath(int slot, const std::string &path)
+{
+    if (slot < 0 || slot >= n_fx_slots)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> g(fxSpawnMutex);
+
+    {
+        std::lock_guard<std::mutex> pg(storage.fxFilePathMutex);
+        storage.getPatch().fx[slot].file_path = path;
+    }
+    storage.getPatch().isDirty = true;
+
+    if (fx[slot])
+    {
+        fx[slot]->filePathChanged();
+    }
+}
+
 void SurgeSynthesizer::reorderFx(int source, int target, FXReorderMode m)
 {
     if (source < 0 || source >= n_fx_slots || target < 0 || target >= n_fx_slots ||
@@ -5109,6 +5399,19 @@ void SurgeSynthesizer::reorderFx(int source, int target, FXReorderMode m)
         cp(fxsync[target].p[i], so.p[i]);
     }
 
+    // the respawned effects pick these up in init()
+    {
+        std::lock_guard<std::mutex> g(fxSpawnMutex);
+        std::lock_guard<std::mutex> pg(storage.fxFilePathMutex);
+
+        storage.getPatch().fx[target].file_path = so.file_path;
+
+        if (m == FXReorderMode::SWAP)
+        {
+            storage.getPatch().fx[source].file_path = to.file_path;
+        }
+    }
+
     // Now swap the routings. FX routings are always global
     std::vector<ModulationRouting> *mv = nullptr;
     mv = &(storage.getPatch().modulation_global);
@@ -5184,6 +5487,7 @@ void SurgeSynthesizer::reorderFx(int source, int target, FXReorderMode m)
     {
         mv->erase(mv->begin() + *dt);
     }
+    storage.publishModulationRouting();
 
     if (m != FXReorderMode::COPY)
     {
@@ -24,13 +24,17 @@
 #define SURGE_SRC_COMMON_SURGESYNTHESIZER_H
 #include "SurgeStorage.h"
 #include "SurgeVoice.h"
+#include "ActiveVoiceList.h"
 #include "Effect.h"
 #include "BiquadFilter.h"
+#include "WorkerPool.h"
 #include <set>
 #include <sst/filters/HalfRateFilter.h>
+#include "VoiceLFOBank.h"
 
 struct QuadFilterChainState;
 
+#include <algorithm>
 #include <list>
 #include <utility>
 #include <atomic>
@@ -110,6 +114,44 @@ class alignas(16) SurgeSynthesizer
     int getMpeMainChannel(int voiceChannel, int key);
     void process();
 
+    /*
+     * Where, in samples into the block the next process() renders, the events being applied
+     * right now fall. A host loop which applies a block's events before rendering it sets this
+     * ahead of each event, and notes started while it is non-zero begin at that sample rather
+     * than at the top of the block. Other events still take effect for the whole block.
+     * process() puts it back to zero.
+     */
+    void setBlockEventOffset(int offset)
+    {
+        blockEventOffset = std::clamp(offset, 0, BLOCK_SIZE - 1);
+    }
+    int blockEventOffset{0};
+
+    /*
+     * Opt-in rendering of scene A and scene B concurrently on a small worker pool. This only
+     * kicks in for blocks where both scenes are playing, and the output is identical to the
+     * serial render: each scene draws its randomness from its own generator, which only that
+     * scene advances whichever thread runs it. Call it from a non-audio thread since enabling it
+     * spawns the pool.
+     */
+    void setParallelSceneRendering(bool b);
+    bool getParallelSceneRendering() const { return parallelSceneRendering; }
+
+    /*
+     * Seed storage.rngGen and, from the same seed, each scene's generator, for renders which
+     * have to repeat. The scene generators are seeded once here and then left to run.
+     */
+    void seedRNG(uint32_t seed);
+
+    /*
+     * Opt-in running of independent fx chains concurrently: the two scenes' insert chains,
+     * then the four sends. Send returns and the global chain are summed and run on the audio
+     * thread in slot order as before, so the output is identical to the serial render. As with
+     * scenes, call it from a non-audio thread since enabling it spawns the pool.
+     */
+    void setParallelFXRendering(bool b);
+    bool getParallelFXRendering() const { return parallelFXRendering; }
+
     PluginLayer *getParent();
 
     // protected:
@@ -150,6 +192,10 @@ class alignas(16) SurgeSynthesizer
         int source, int target,
         FXReorderMode m); // This is safe to call from the UI thread since it just edits the sync
 
+    // Point an effect at the file it reads besides its params (a convolution impulse response).
+    // Safe from the UI thread; the effect does any loading on its own thread
+    void setFxFilePath(int slot, const std::string &path);
+
     void playVoice(int scene, char channel, char key, char velocity, char detune,
                    int32_t host_noteid, int16_t okey = -1, int16_t ochan = -1);
     void releaseScene(int s);
@@ -463,7 +509,9 @@ class alignas(16) SurgeSynthesizer
     bool approachingAllSoundsOff{false};
     // TODO: FIX SCENE ASSUMPTION (for halfbandA/B - use std::array)
     sst::filters::HalfRate::HalfRateFilter halfbandA, halfbandB, halfbandIN;
-    std::list<SurgeVoice *> voices[n_scenes];
+    typedef Surge::ActiveVoiceList<SurgeVoice, MAX_VOICES> voicelist_t;
+    voicelist_t voices[n_scenes];
+    VoiceLFOBank voiceLFOBank[n_scenes];
     std::unique_ptr<Effect> fx[n_fx_slots];
     std::atomic<bool> halt_engine;
     MidiChannelState channelState[16];
@@ -524,6 +572,44 @@ class alignas(16) SurgeSynthesizer
 
     QuadFilterChainState *FBQ[n_scenes];
 
+    void renderScene(int scene, bool onWorkerPool);
+    std::atomic<bool> parallelSceneRendering{false};
+    std::unique_ptr<Surge::Threading::WorkerPool> sceneRenderPool;
+    int sceneVoiceCount[n_scenes]{};
+    SurgeStorage::RNGGen sceneRNG[n_scenes];
+    void seedSceneRNGs(uint64_t base);
+
+    /*
+     * The fx graph. process() runs it in two phases of independent chains, the insert chain
+     * of each scene and then each send, and the chains of a phase are tasks on fxRenderPool.
+     * Chains holding an effect which drawsFromSharedRNG() share one task and run in chain
+     * order, so the shared random state is never touched from two threads and its draws come
+     * in the serial order. The state below is only valid during process().
+     */
+    enum FXPhase
+    {
+        fxp_inserts,
+        fxp_sends
+    };
+    static constexpr int max_fx_chains = n_send_slots > n_scenes ? n_send_slots : n_scenes;
+
+    bool isFXSlotActive(int slot) const;
+    bool runFXSlot(int slot, float *dataL, float *dataR, bool indata_present);
+    void runFXChain(int phase, int chain);
+    void runFXPhase(int phase);
+
+    std::atomic<bool> parallelFXRendering{false};
+    std::unique_ptr<Surge::Threading::WorkerPool> fxRenderPool;
+    int fxTaskPhase{fxp_inserts};
+    uint32_t fxTaskChains[max_fx_chains]{};
+    bool fxSceneState[n_scenes]{};
+    bool fxSendInput{false};
+    bool fxSendUsed[n_send_slots]{};
+    bool fxRan[n_fx_slots]{}; // which slots got to process_ringout, for the sleep stats
+    float (*fxSendBuffers)[2][BLOCK_SIZE]{nullptr};
+    std::array<std::array<SurgeVoice *, MAX_VOICES>, n_scenes> deferredFreeVoices{};
+    int deferredFreeVoiceCount[n_scenes]{};
+
     std::string hostProgram = "Unknown Host";
     std::string juceWrapperType = "Unknown Wrapper Type";
     bool activateExtraOutputs = true;
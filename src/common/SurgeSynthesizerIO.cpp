@@ -449,6 +449,7 @@ void SurgeSynthesizer::loadRaw(const void *data, int size, bool preset)
     }
 
     loadFx(false, true);
+    storage.publishModulationRouting();
 
     for (int sc = 0; sc < n_scenes; sc++)
     {
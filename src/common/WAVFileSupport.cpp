@@ -544,6 +544,137 @@ bool SurgeStorage::load_wt_wav_portable(std::string fn, Wavetable *wt)
     return true;
 }
 
+bool SurgeStorage::load_wav_channels(const fs::path &path,
+                                     std::vector<std::vector<float>> &channels, int &sampleRate,
+                                     const std::string &uitag)
+{
+    std::filebuf fp;
+    auto fn = path_to_string(path);
+
+    if (!fp.open(path, std::ios::binary | std::ios::in))
+    {
+        reportError("Unable to open file '" + fn + "'!", uitag);
+        return false;
+    }
+
+    char riff[4], szd[4], wav[4];
+    auto hds = fp.sgetn(riff, sizeof(riff));
+
+    hds += fp.sgetn(szd, sizeof(szd));
+    hds += fp.sgetn(wav, sizeof(wav));
+
+    if (hds != 12 || !four_chars(riff, 'R', 'I', 'F', 'F') || !four_chars(wav, 'W', 'A', 'V', 'E'))
+    {
+        reportError("'" + fn + "' is not a standard RIFF/WAVE file!", uitag);
+        return false;
+    }
+
+    unsigned short audioFormat{0}, numChannels{0}, bitsPerSample{0};
+    std::vector<char> data;
+    bool hasFormat{false}, hasData{false};
+
+    while (!(hasFormat && hasData))
+    {
+        char chunkType[4], chunkSzD[4];
+
+        if (fp.sgetn(chunkType, sizeof(chunkType)) != sizeof(chunkType) ||
+            fp.sgetn(chunkSzD, sizeof(chunkSzD)) != sizeof(chunkSzD))
+        {
+            break;
+        }
+
+        int cs = pl_int(chunkSzD);
+
+        // RIFF requires all chunks to be in 2 byte sizes
+        if (cs % 2 == 1)
+            cs = cs + 1;
+
+        if (four_chars(chunkType, 'f', 'm', 't', ' ') && cs >= 16)
+        {
+            std::vector<char> fmt(cs);
+            if (fp.sgetn(fmt.data(), cs) != cs)
+                break;
+
+            audioFormat = pl_short(&fmt[0]);
+            numChannels = pl_short(&fmt[2]);
+            sampleRate = pl_int(&fmt[4]);
+            bitsPerSample = pl_short(&fmt[14]);
+
+            // WAVE_FORMAT_EXTENSIBLE carries the real format in its sub format GUID
+            if (audioFormat == 0xFFFE && cs >= 26)
+                audioFormat = pl_short(&fmt[24]);
+
+            hasFormat = true;
+        }
+        else if (four_chars(chunkType, 'd', 'a', 't', 'a'))
+        {
+            data.resize(cs);
+            data.resize(fp.sgetn(data.data(), cs));
+            hasData = true;
+        }
+        else if (fp.pubseekoff(cs, std::ios::cur, std::ios::in) == std::streampos(-1))
+        {
+            break;
+        }
+    }
+
+    if (!hasFormat || !hasData || numChannels == 0)
+    {
+        reportError("'" + fn + "' has no audio data which Surge XT can find!", uitag);
+        return false;
+    }
+
+    if (!((audioFormat == 1 /* WAVE_FORMAT_PCM */ &&
+           (bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32)) ||
+          (audioFormat == 3 /* IEEE_FLOAT */ && bitsPerSample == 32)))
+    {
+        std::ostringstream oss;
+        oss << "Surge XT can only read 16, 24 or 32-bit PCM or 32-bit float WAV files. '" << fn
+            << "' is format " << audioFormat << " at " << bitsPerSample << " bits.";
+        reportError(oss.str(), uitag);
+        return false;
+    }
+
+    int bytes = bitsPerSample / 8;
+    int frames = data.size() / (bytes * numChannels);
+
+    channels.assign(numChannels, std::vector<float>(frames));
+
+    for (int i = 0; i < frames; ++i)
+    {
+        for (int c = 0; c < numChannels; ++c)
+        {
+            char *d = &data[(i * numChannels + c) * bytes];
+            float v;
+
+            if (audioFormat == 3)
+            {
+                unsigned int b = pl_int(d);
+                memcpy(&v, &b, sizeof(float));
+            }
+            else if (bytes == 2)
+            {
+                v = (short)pl_short(d) / 32768.f;
+            }
+            else if (bytes == 3)
+            {
+                // into the top of an int so the sign comes along
+                int s = ((unsigned char)d[0] << 8) | ((unsigned char)d[1] << 16) |
+                        ((unsigned char)d[2] << 24);
+                v = s / 2147483648.f;
+            }
+            else
+            {
+                v = (int)pl_int(d) / 2147483648.f;
+            }
+
+            channels[c][i] = v;
+        }
+    }
+
+    return true;
+}
+
 std::string SurgeStorage::export_wt_wav_portable(std::string fbase, Wavetable *wt)
 {
     auto path = userDataPath / "Wavetables" / "Exported";
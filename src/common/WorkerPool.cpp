@@ -0,0 +1,165 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "globals.h"
+#include "WorkerPool.h"
+#include "DebugHelpers.h"
+
+#include <chrono>
+
+#if LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Surge
+{
+namespace Threading
+{
+namespace
+{
+constexpr uint64_t indexMask = 0xFFFF;
+constexpr uint64_t countShift = 16;
+constexpr uint64_t generationShift = 32;
+
+// after this many empty polls a worker starts yielding, and after the second one, sleeping
+constexpr int spinsBeforeYield = 4096;
+constexpr int spinsBeforeSleep = 1 << 18;
+
+inline bool hasUnclaimedTask(uint64_t t)
+{
+    return (t & indexMask) < ((t >> countShift) & indexMask);
+}
+} // namespace
+
+WorkerPool::WorkerPool(int numWorkers)
+{
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        workers.push_back(std::make_unique<std::thread>([this, i]() { workerLoop(i); }));
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    keepRunning = false;
+    for (auto &w : workers)
+    {
+        w->join();
+    }
+}
+
+bool WorkerPool::claimAndRunTask()
+{
+    auto t = ticket.fetch_add(1, std::memory_order_acq_rel);
+    auto idx = t & indexMask;
+    auto count = (t >> countShift) & indexMask;
+
+    if (idx >= count)
+        return false;
+
+    /*
+     * currentTask and currentContext can't be replaced under us: the next job is only
+     * published once tasksRemaining hits zero, and it can't while we hold a claimed task.
+     */
+    currentTask(currentContext, (int)idx);
+    tasksRemaining.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+void WorkerPool::run(int nTasks, task_t task, void *context)
+{
+    if (nTasks <= 0)
+        return;
+
+    if (workers.empty() || nTasks == 1)
+    {
+        for (int i = 0; i < nTasks; ++i)
+            task(context, i);
+        return;
+    }
+
+    assert((uint64_t)nTasks < indexMask);
+
+    currentTask = task;
+    currentContext = context;
+    tasksRemaining.store(nTasks, std::memory_order_relaxed);
+
+    auto gen = (ticket.load(std::memory_order_relaxed) >> generationShift) + 1;
+    ticket.store((gen << generationShift) | ((uint64_t)nTasks << countShift),
+                 std::memory_order_release);
+
+    // the calling thread works too, rather than just sitting at the barrier
+    while (claimAndRunTask())
+        ;
+
+    while (tasksRemaining.load(std::memory_order_acquire) > 0)
+        _mm_pause();
+}
+
+void WorkerPool::workerLoop(int workerIndex)
+{
+#if LINUX
+    // leave core 0 to the host and the audio thread, and give each worker its own core
+    auto ncpu = std::thread::hardware_concurrency();
+    if (ncpu > 1)
+    {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(1 + (workerIndex % (ncpu - 1)), &cpuset);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+    }
+#endif
+
+    int idleSpins = 0;
+    while (keepRunning.load(std::memory_order_relaxed))
+    {
+        if (hasUnclaimedTask(ticket.load(std::memory_order_acquire)))
+        {
+            // tasks are a slice of some audio thread's block, so hold them to the same rules
+            SURGE_AUDIO_THREAD_SCOPE(true);
+            while (claimAndRunTask())
+                ;
+            idleSpins = 0;
+            continue;
+        }
+
+        if (idleSpins < spinsBeforeYield)
+        {
+            _mm_pause();
+        }
+        else if (idleSpins < spinsBeforeSleep)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+
+        if (idleSpins < spinsBeforeSleep)
+            idleSpins++;
+    }
+}
+
+} // namespace Threading
+} // namespace Surge
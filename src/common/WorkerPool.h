@@ -0,0 +1,91 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_WORKERPOOL_H
+#define SURGE_SRC_COMMON_WORKERPOOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace Surge
+{
+namespace Threading
+{
+/*
+ * WorkerPool is a tiny fork-join pool for splitting one audio block into a handful of
+ * independent tasks (for instance rendering scene A and scene B). It is built to be
+ * called from the audio thread, so run() never allocates or takes a lock: the calling
+ * thread publishes the job with an atomic generation counter, claims tasks alongside the
+ * workers, and then spins on a completion counter which acts as the per-block barrier.
+ *
+ * Workers spin (with a cpu pause) for a short while after each job so back-to-back blocks
+ * don't pay a wakeup, then back off to yielding and finally to short sleeps once the pool
+ * has been idle for a while. On Linux the workers are pinned to distinct cores.
+ *
+ * The task callback is a plain function pointer and context so a job can be described
+ * without a std::function allocation.
+ */
+struct WorkerPool
+{
+    typedef void (*task_t)(void *context, int taskIndex);
+
+    explicit WorkerPool(int numWorkers);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    /*
+     * Run tasks 0..nTasks-1, using the calling thread as one of the workers, and
+     * return once all of them have completed. Not reentrant.
+     */
+    void run(int nTasks, task_t task, void *context);
+
+    int numWorkers() const { return (int)workers.size(); }
+
+  private:
+    void workerLoop(int workerIndex);
+    bool claimAndRunTask();
+
+    std::vector<std::unique_ptr<std::thread>> workers;
+
+    std::atomic<bool> keepRunning{true};
+
+    /*
+     * The ticket packs the job generation (high 32 bits), the job's task count (next 16)
+     * and the next unclaimed task index (low 16) into one word. Claiming a task is a single
+     * fetch_add, and since the count travels with the index a late worker can never claim
+     * a task against the wrong job.
+     */
+    std::atomic<uint64_t> ticket{0};
+    std::atomic<int> tasksRemaining{0};
+
+    task_t currentTask{nullptr};
+    void *currentContext{nullptr};
+};
+} // namespace Threading
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_WORKERPOOL_H
@@ -0,0 +1,110 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_ACTIVEVOICELIST_H
+#define SURGE_SRC_COMMON_DSP_ACTIVEVOICELIST_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+
+namespace Surge
+{
+/*
+ * ActiveVoiceList is the per-scene set of playing voices. It used to be a std::list, which
+ * meant a heap node per voice and a pointer chase per step of the two per-block scans. This
+ * is a fixed capacity, contiguous array of voice pointers instead, so a scan at full
+ * polyphony touches a handful of cache lines.
+ *
+ * It keeps the slice of the std::list API the synth uses. erase() closes the gap by shifting
+ * the tail down rather than swapping the last voice in: that's at most MAX_VOICES pointer
+ * moves when a voice ends, and it keeps the list in creation order, which the mono and
+ * legato voice selection in playVoice relies on and which keeps the quad filter lane
+ * assignment (and so the summing order into the scene output) unchanged.
+ */
+template <typename V, size_t capacity> struct ActiveVoiceList
+{
+    typedef V *value_type;
+    typedef V **iterator;
+    typedef V *const *const_iterator;
+
+    iterator begin() { return items.data(); }
+    iterator end() { return items.data() + count; }
+    const_iterator begin() const { return items.data(); }
+    const_iterator end() const { return items.data() + count; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    V *front() const
+    {
+        assert(count > 0);
+        return items[0];
+    }
+    V *back() const
+    {
+        assert(count > 0);
+        return items[count - 1];
+    }
+
+    void push_back(V *v)
+    {
+        assert(count < capacity);
+        items[count++] = v;
+    }
+
+    iterator erase(iterator it)
+    {
+        assert(it >= begin() && it < end());
+        std::copy(it + 1, end(), it);
+        count--;
+        items[count] = nullptr;
+        return it;
+    }
+
+    void remove(V *v)
+    {
+        auto it = begin();
+        while (it != end())
+        {
+            if (*it == v)
+                it = erase(it);
+            else
+                ++it;
+        }
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i < count; ++i)
+            items[i] = nullptr;
+        count = 0;
+    }
+
+  private:
+    std::array<V *, capacity> items{};
+    size_t count{0};
+};
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_DSP_ACTIVEVOICELIST_H
@@ -24,6 +24,7 @@
 #include "ChorusEffectImpl.h"
 #include "CombulatorEffect.h"
 #include "ConditionerEffect.h"
+#include "ConvolutionEffect.h"
 #include "DistortionEffect.h"
 #include "DelayEffect.h"
 #include "FlangerEffect.h"
@@ -116,6 +117,8 @@ Effect *spawn_effect(int id, SurgeStorage *storage, FxStorage *fxdata, pdata *pd
         return new BonsaiEffect(storage, fxdata, pd);
     case fxt_audio_input:
         return new AudioInputEffect(storage, fxdata, pd);
+    case fxt_convolution:
+        return new ConvolutionEffect(storage, fxdata, pd);
     default:
         return 0;
     };
@@ -138,21 +141,64 @@ Effect::Effect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd)
     }
 }
 
+namespace
+{
+bool isBlockSilent(const float *dataL, const float *dataR)
+{
+    float sum = 0.f;
+    for (int i = 0; i < BLOCK_SIZE; ++i)
+        sum += dataL[i] * dataL[i] + dataR[i] * dataR[i];
+    return sum < fx_silence_floor * fx_silence_floor * 2 * BLOCK_SIZE;
+}
+} // namespace
+
 bool Effect::process_ringout(float *dataL, float *dataR, bool indata_present)
 {
+    /*
+     * A slot is fed from a playing scene even when that scene is silent, so check the input
+     * itself. A silent input is left as is when we don't process, which is under the floor.
+     */
+    if (indata_present && isBlockSilent(dataL, dataR))
+        indata_present = false;
+
     if (indata_present)
         ringout = 0;
     else
         ringout++;
 
     int d = get_ringout_decay();
-    if ((d < 0) || (ringout < d) || (ringout == 0))
+    if (d >= 0)
+    {
+        sleeping = !((ringout < d) || (ringout == 0));
+    }
+    else if (indata_present)
+    {
+        sleeping = false;
+        silentOutputBlocks = 0;
+    }
+    else if (!sleeping)
     {
+        // we don't know how long our tail is, so process and listen for it to end
         process(dataL, dataR);
+
+        auto hold = get_sleep_hold_seconds();
+        if (isBlockSilent(dataL, dataR))
+            silentOutputBlocks++;
+        else
+            silentOutputBlocks = 0;
+
+        if (hold >= 0 && silentOutputBlocks > hold * storage->samplerate * BLOCK_SIZE_INV)
+            sleeping = true;
         return true;
     }
-    else
-        process_only_control();
+
+    if (!sleeping)
+    {
+        process(dataL, dataR);
+        return true;
+    }
+
+    process_only_control();
     return false;
 }
 
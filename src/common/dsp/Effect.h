@@ -68,6 +68,22 @@ class alignas(16) Effect
         return -1;
     } // number of blocks it takes for the effect to 'ring out'
 
+    /*
+     * Effects which can't say how long they ring out for (a negative get_ringout_decay()) are
+     * put to sleep once their input is silent and their output has stayed under
+     * fx_silence_floor for this long. It needs to cover the longest quiet gap the effect can
+     * leave in a tail which then comes back, which for most is none at all. Return a negative
+     * value for effects which make sound from nothing and so must never sleep. The
+     * --non-test --fx-tails mode of the test runner measures the tails to set these from.
+     */
+    virtual float get_sleep_hold_seconds() { return 0.25f; }
+
+    /*
+     * True for effects whose process() draws from random state shared with other slots, such
+     * as the storage RNG. The parallel fx graph keeps these on one thread in slot order.
+     */
+    virtual bool drawsFromSharedRNG() { return false; }
+
     virtual void process(float *dataL, float *dataR) { return; }
     virtual void process_only_control()
     {
@@ -75,6 +91,8 @@ class alignas(16) Effect
     } // for controllers that should run regardless of the audioprocess
     virtual bool process_ringout(float *dataL, float *dataR,
                                  bool indata_present = true); // returns rtue if outdata is present
+    // true when process_ringout has stopped calling process() until the input comes back
+    bool isSleeping() const { return sleeping; }
     // virtual void processSSE(float *dataL, float *dataR){ return; }
     // virtual void processSSE2(float *dataL, float *dataR){ return; }
     // virtual void processSSE3(float *dataL, float *dataR){ return; }
@@ -86,6 +104,9 @@ class alignas(16) Effect
     // keeps a cache so give loaded fx a notice when the sample rate changes
     virtual void sampleRateReset() {}
 
+    // Called with the spawn lock held when fxdata->file_path has been pointed somewhere new
+    virtual void filePathChanged() {}
+
     virtual void handleStreamingMismatches(int streamingRevision, int currentSynthStreamingRevision)
     {
         // No-op here.
@@ -118,12 +139,18 @@ class alignas(16) Effect
     pdata *pd;
     int ringout;
     bool hasInvalidated{false};
+
+  private:
+    bool sleeping{false};
+    int silentOutputBlocks{0};
 };
 
 // Some common constants
 const int max_delay_length = 1 << 18;
 const int slowrate = 8;
 const int slowrate_m1 = slowrate - 1;
+// RMS level under which an effect's input counts as absent and its tail as finished (-100 dB)
+const float fx_silence_floor = 1e-5f;
 
 Effect *spawn_effect(int id, SurgeStorage *storage, FxStorage *fxdata, pdata *pd);
 
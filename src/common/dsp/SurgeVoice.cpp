@@ -479,19 +479,13 @@ void SurgeVoice::switch_toggled()
     /*
      * Since we have updated the keytrack output here we need to re-update the localcopy modulators
      */
-    vector<ModulationRouting>::iterator iter;
-    iter = scene->modulation_voice.begin();
-    while (iter != scene->modulation_voice.end())
+    for (const auto &r : storage->audioModRouting->voice[state.scene_id])
     {
-        int src_id = iter->source_id;
-        int dst_id = iter->destination_id;
-        float depth = iter->depth;
-        if (modsources[src_id] && src_id == ms_keytrack)
+        if (modsources[r.source_id] && r.source_id == ms_keytrack)
         {
-            localcopy[dst_id].f +=
-                depth * modsources[ms_keytrack]->get_output(0) * (1 - iter->muted);
+            localcopy[r.destination_id].f +=
+                r.depth * modsources[ms_keytrack]->get_output(0) * (1 - r.muted);
         }
-        iter++;
     }
 
     for (int i = 0; i < n_oscs; i++)
@@ -698,7 +692,8 @@ int SurgeVoice::routefilter(int r)
 template <bool first> void SurgeVoice::calc_ctrldata(QuadFilterChainState *Q, int e)
 {
     // Always process LFO1 so the gate retrigger always work
-    lfo[0].process_block();
+    if (!lfo[0].processedByBank)
+        lfo[0].process_block();
     velocitySource.process_block();
 
     for (int i = 0; i < n_lfos_voice; i++)
@@ -709,12 +704,15 @@ template <bool first> void SurgeVoice::calc_ctrldata(QuadFilterChainState *Q, in
             Surge::Formula::setupEvaluatorStateFrom(lfo[i].formulastate, this);
         }
 
-        if (i != 0 && scene->modsource_doprocess[ms_lfo1 + i])
+        if (i != 0 && scene->modsource_doprocess[ms_lfo1 + i] && !lfo[i].processedByBank)
         {
             lfo[i].process_block();
         }
     }
 
+    for (auto &l : lfo)
+        l.processedByBank = false;
+
     for (int i = 0; i < n_lfos_voice; ++i)
     {
         if (lfo[i].retrigger_AEG)
@@ -979,6 +977,10 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
     mech::clear_block<BLOCK_SIZE_OS>(output[0]);
     mech::clear_block<BLOCK_SIZE_OS>(output[1]);
 
+    // each oscillator's timer covers rendering it and mixing it into the voice output
+    namespace prof = Surge::Profiling;
+    auto &profiler = storage->processProfiler;
+
     for (int i = 0; i < n_oscs; ++i)
     {
         if (osc[i])
@@ -990,6 +992,8 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
     if (osc3 || ring23 || ((osc1 || osc2 || ring12) && (FMmode == fm_3to2to1)) ||
         ((osc1 || ring12) && (FMmode == fm_2and3to1)))
     {
+        prof::StageTimer oscTimer(profiler, prof::oscStage(state.scene_id, 2));
+
         osc[2]->process_block(
             noteShiftFromPitchParam(
                 (scene->osc[2].keytrack.val.b ? state.pitch : ktrkroot + state.scenepbpitch) +
@@ -1022,6 +1026,8 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
 
     if (osc2 || ring12 || ring23 || (FMmode && osc1))
     {
+        prof::StageTimer oscTimer(profiler, prof::oscStage(state.scene_id, 1));
+
         if (FMmode == fm_3to2to1)
         {
             osc[1]->process_block(
@@ -1067,6 +1073,8 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
 
     if (osc1 || ring12)
     {
+        prof::StageTimer oscTimer(profiler, prof::oscStage(state.scene_id, 0));
+
         if (FMmode == fm_2and3to1)
         {
             mech::add_block<BLOCK_SIZE_OS>(osc[1]->output, osc[2]->output, fmbuffer);
@@ -1200,6 +1208,20 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
     // pre-filter gain
     osclevels[le_pfg].multiply_2_blocks(output[0], output[1], BLOCK_SIZE_OS_QUAD);
 
+    if (startOffset > 0)
+    {
+        float tail alignas(16)[BLOCK_SIZE_OS];
+        auto keep = BLOCK_SIZE_OS - startOffset;
+
+        for (int c = 0; c < 2; ++c)
+        {
+            memcpy(tail, output[c] + keep, startOffset * sizeof(float));
+            memmove(output[c] + startOffset, output[c], keep * sizeof(float));
+            memcpy(output[c], startOffsetCarry[c], startOffset * sizeof(float));
+            memcpy(startOffsetCarry[c], tail, startOffset * sizeof(float));
+        }
+    }
+
     for (int i = 0; i < BLOCK_SIZE_OS; i++)
     {
         _mm_store_ss(((float *)&Q.DL[i] + Qe), _mm_load_ss(&output[0][i]));
@@ -1216,23 +1238,21 @@ bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
 
 template <bool noLFOSources> void SurgeVoice::applyModulationToLocalcopy()
 {
-    vector<ModulationRouting>::iterator iter;
-    iter = scene->modulation_voice.begin();
-    while (iter != scene->modulation_voice.end())
+    // routings come from the snapshot the synth acquired for this block, not the patch
+    const auto &routing = *storage->audioModRouting;
+
+    for (const auto &r : routing.voice[state.scene_id])
     {
-        int src_id = iter->source_id;
-        int dst_id = iter->destination_id;
-        float depth = iter->depth;
+        int src_id = r.source_id;
 
         if (noLFOSources && isLFO((::modsources)src_id))
         {
         }
         else if (modsources[src_id])
         {
-            localcopy[dst_id].f +=
-                depth * modsources[src_id]->get_output(iter->source_index) * (1.0 - iter->muted);
+            localcopy[r.destination_id].f +=
+                r.depth * modsources[src_id]->get_output(r.source_index) * (1.0 - r.muted);
         }
-        iter++;
     }
 
     if (mpeEnabled)
@@ -1240,23 +1260,20 @@ template <bool noLFOSources> void SurgeVoice::applyModulationToLocalcopy()
         // See github issue 1214. This basically compensates for
         // channel AT being per-voice in MPE mode (since it is per channel)
         // vs per-scene (since it is per keyboard in non MPE mode).
-        iter = scene->modulation_scene.begin();
-        while (iter != scene->modulation_scene.end())
+        for (const auto &r : routing.scene[state.scene_id])
         {
-            int src_id = iter->source_id;
+            int src_id = r.source_id;
             if (src_id == ms_aftertouch && modsources[src_id])
             {
-                int dst_id = iter->destination_id;
+                int dst_id = r.destination_id;
                 // I don't THINK we need this but am not sure the global params are in my localcopy
                 // span
                 if (dst_id >= 0 && dst_id < n_scene_params)
                 {
-                    float depth = iter->depth;
                     localcopy[dst_id].f +=
-                        depth * modsources[src_id]->get_output(0) * (1.0 - iter->muted);
+                        r.depth * modsources[src_id]->get_output(0) * (1.0 - r.muted);
                 }
             }
-            iter++;
         }
 
         monoAftertouchSource.set_target(state.voiceChannelState->pressure +
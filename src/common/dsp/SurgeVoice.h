@@ -65,6 +65,26 @@ class alignas(16) SurgeVoice
     SurgeVoiceState state;
     int age, age_release;
 
+    /*
+     * A voice started part way into a block runs its oscillators from the top of the block
+     * as usual, but its pre-filter output is delayed by startOffset oversampled samples for
+     * the rest of its life, so the note sounds from the sample it was played on. The tail
+     * of each block which the delay pushes out is carried into the next one. The amp and
+     * filter envelopes only run for the part of the first block after the offset, so they
+     * start on the same sample as the audio.
+     */
+    void setStartOffset(int offsetOS)
+    {
+        startOffset = offsetOS;
+        memset(startOffsetCarry, 0, sizeof(startOffsetCarry));
+
+        auto frac = 1.f - (float)offsetOS / BLOCK_SIZE_OS;
+        ampEGSource.setNextBlockFraction(frac);
+        filterEGSource.setNextBlockFraction(frac);
+    }
+    int startOffset{0};
+    float startOffsetCarry alignas(16)[2][BLOCK_SIZE_OS];
+
     bool matchesChannelKeyId(int16_t channel, int16_t key, int32_t host_noteid);
 
     /*
@@ -234,6 +254,8 @@ class alignas(16) SurgeVoice
     int routefilter(int);
     void retriggerPortaIfKeyChanged();
 
+    // the scene's VoiceLFOBank runs these ahead of the voices when it can
+    friend class VoiceLFOBank;
     LFOModulationSource lfo[n_lfos_voice];
 
     // Filterblock state storage
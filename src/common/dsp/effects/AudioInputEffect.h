@@ -56,6 +56,8 @@ class AudioInputEffect : public Effect
     void init_ctrltypes() override;
     void init_default_values() override;
     void process(float *dataL, float *dataR) override;
+    // we bring in the host's audio input, so there's sound with nothing coming into the slot
+    float get_sleep_hold_seconds() override { return -1.f; }
     const char *group_label(int id) override;
     int group_label_ypos(int id) override;
 
@@ -42,6 +42,9 @@ class BonsaiEffect
     virtual void init_ctrltypes() override;
     virtual const char *group_label(int id) override;
     virtual int group_label_ypos(int id) override;
+
+    // filters and saturation with short memory, so the tail decays without gaps
+    float get_sleep_hold_seconds() override { return 0.05f; }
 };
 
 #endif // SURGE_SRC_COMMON_DSP_EFFECTS_BONSAIEFFECT_H
@@ -65,6 +65,12 @@ class CombulatorEffect : public Effect
     virtual void sampleRateReset() override;
     virtual void process(float *dataL, float *dataR) override;
     virtual int get_ringout_decay() override { return -1; }
+    // a comb tuned right down repeats up to its whole delay line apart, quiet in between
+    virtual float get_sleep_hold_seconds() override
+    {
+        return 1.f * MAX_FB_COMB_EXTENDED / storage->dsamplerate_os + 0.05f;
+    }
+    virtual bool drawsFromSharedRNG() override { return true; }
     virtual void suspend() override;
     void setvars(bool init);
     virtual void init_ctrltypes() override;
@@ -0,0 +1,275 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "ConvolutionEffect.h"
+#include "sst/basic-blocks/mechanics/block-ops.h"
+
+#include <algorithm>
+
+namespace mech = sst::basic_blocks::mechanics;
+
+namespace
+{
+// long enough to hide the step when one IR replaces another, short enough to feel immediate
+constexpr int fadeBlocks = std::max(1, 2048 / BLOCK_SIZE);
+} // namespace
+
+ConvolutionEffect::ConvolutionEffect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd)
+    : Effect(storage, fxdata, pd), lp(storage), hp(storage)
+{
+    gain.set_blocksize(BLOCK_SIZE);
+    width.set_blocksize(BLOCK_SIZE);
+    mix.set_blocksize(BLOCK_SIZE);
+
+    for (int i = 0; i < n_fx_slots; ++i)
+        if (fxdata == &storage->getPatch().fx[i])
+            slot = i;
+}
+
+ConvolutionEffect::~ConvolutionEffect()
+{
+    auto *loader = storage->impulseResponses.get();
+
+    if (!loader)
+    {
+        delete current;
+        delete fading;
+        return;
+    }
+
+    // whatever is still being built for us gets freed when it lands, not waited for
+    if (lastRequest)
+        loader->cancel(slot);
+
+    loader->retire(current);
+    loader->retire(fading);
+}
+
+void ConvolutionEffect::init()
+{
+    setvars(true);
+
+    // the effect is also spawned just to read its params, so only ask for an IR here
+    requestLoad(current == nullptr);
+}
+
+void ConvolutionEffect::suspend()
+{
+    if (current && current->left)
+    {
+        current->left->reset();
+        current->right->reset();
+    }
+
+    lp.suspend();
+    hp.suspend();
+}
+
+void ConvolutionEffect::sampleRateReset()
+{
+    if (lastRequest)
+        requestLoad(false);
+}
+
+void ConvolutionEffect::filePathChanged()
+{
+    if (lastRequest)
+        requestLoad(true);
+}
+
+void ConvolutionEffect::requestLoad(bool force)
+{
+    if (slot < 0 || !storage->impulseResponses)
+        return;
+
+    lastRequest = storage->impulseResponses->request(slot, storage->samplerate, force);
+    if (!firstRequest)
+        firstRequest = lastRequest;
+}
+
+bool ConvolutionEffect::isLoaded() const
+{
+    if (!lastRequest)
+        return !fading;
+
+    return storage->impulseResponses->isSettled(slot, lastRequest) && !fading;
+}
+
+void ConvolutionEffect::setvars(bool init)
+{
+    gain.set_target_smoothed(storage->db_to_linear(*pd_float[cnv_gain]));
+    width.set_target_smoothed(storage->db_to_linear(*pd_float[cnv_width]));
+    mix.set_target_smoothed(clamp01(*pd_float[cnv_mix]));
+
+    hp.coeff_HP(hp.calc_omega(*pd_float[cnv_lowcut] / 12.0), 0.707);
+    lp.coeff_LP2B(lp.calc_omega(*pd_float[cnv_highcut] / 12.0), 0.707);
+
+    if (init)
+    {
+        lp.suspend();
+        hp.suspend();
+        hp.coeff_instantize();
+        lp.coeff_instantize();
+
+        gain.instantize();
+        width.instantize();
+        mix.instantize();
+    }
+}
+
+void ConvolutionEffect::convolve(ImpulseResponse *ir, float *dataL, float *dataR, float *wetL,
+                                 float *wetR)
+{
+    if (ir && ir->left)
+    {
+        ir->left->process(dataL, wetL);
+        ir->right->process(dataR, wetR);
+    }
+    else
+    {
+        mech::clear_block<BLOCK_SIZE>(wetL);
+        mech::clear_block<BLOCK_SIZE>(wetR);
+    }
+}
+
+void ConvolutionEffect::process(float *dataL, float *dataR)
+{
+    setvars(false);
+
+    if (!fading && lastRequest)
+    {
+        if (auto *ir = storage->impulseResponses->take(slot, firstRequest))
+        {
+            fading = current;
+            fadePos = 0;
+            current = ir;
+            ringout_value = current->length / BLOCK_SIZE + 1;
+        }
+    }
+
+    float wetL alignas(16)[BLOCK_SIZE], wetR alignas(16)[BLOCK_SIZE];
+    convolve(current, dataL, dataR, wetL, wetR);
+
+    if (fading)
+    {
+        if (fadePos < fadeBlocks)
+        {
+            float oldL alignas(16)[BLOCK_SIZE], oldR alignas(16)[BLOCK_SIZE];
+            convolve(fading, dataL, dataR, oldL, oldR);
+
+            auto dt = 1.f / (fadeBlocks * BLOCK_SIZE);
+            auto t = fadePos * BLOCK_SIZE * dt;
+            for (int i = 0; i < BLOCK_SIZE; ++i)
+            {
+                t += dt;
+                wetL[i] = oldL[i] + t * (wetL[i] - oldL[i]);
+                wetR[i] = oldR[i] + t * (wetR[i] - oldR[i]);
+            }
+            fadePos++;
+        }
+        else
+        {
+            storage->impulseResponses->retire(fading);
+            fading = nullptr;
+        }
+    }
+
+    gain.multiply_2_blocks(wetL, wetR, BLOCK_SIZE_QUAD);
+
+    if (!fxdata->p[cnv_lowcut].deactivated)
+        hp.process_block(wetL, wetR);
+
+    if (!fxdata->p[cnv_highcut].deactivated)
+        lp.process_block(wetL, wetR);
+
+    applyWidth(wetL, wetR, width);
+    mix.fade_2_blocks_inplace(dataL, wetL, dataR, wetR, BLOCK_SIZE_QUAD);
+}
+
+const char *ConvolutionEffect::group_label(int id)
+{
+    switch (id)
+    {
+    case 0:
+        return "Impulse Response";
+    case 1:
+        return "EQ";
+    case 2:
+        return "Output";
+    }
+    return 0;
+}
+
+int ConvolutionEffect::group_label_ypos(int id)
+{
+    switch (id)
+    {
+    case 0:
+        return 1;
+    case 1:
+        return 5;
+    case 2:
+        return 11;
+    }
+    return 0;
+}
+
+void ConvolutionEffect::init_ctrltypes()
+{
+    Effect::init_ctrltypes();
+
+    fxdata->p[cnv_gain].set_name("Gain");
+    fxdata->p[cnv_gain].set_type(ct_decibel_narrow);
+
+    fxdata->p[cnv_lowcut].set_name("Low Cut");
+    fxdata->p[cnv_lowcut].set_type(ct_freq_audible_deactivatable_hp);
+    fxdata->p[cnv_highcut].set_name("High Cut");
+    fxdata->p[cnv_highcut].set_type(ct_freq_audible_deactivatable_lp);
+
+    fxdata->p[cnv_width].set_name("Width");
+    fxdata->p[cnv_width].set_type(ct_decibel_narrow);
+    fxdata->p[cnv_mix].set_name("Mix");
+    fxdata->p[cnv_mix].set_type(ct_percent);
+
+    for (int i = cnv_gain; i < cnv_num_params; ++i)
+    {
+        auto a = 1;
+        if (i >= cnv_lowcut)
+            a += 2;
+        if (i >= cnv_width)
+            a += 2;
+        fxdata->p[i].posy_offset = a;
+    }
+}
+
+void ConvolutionEffect::init_default_values()
+{
+    fxdata->p[cnv_gain].val.f = 0.f;
+
+    fxdata->p[cnv_lowcut].val.f = fxdata->p[cnv_lowcut].val_min.f;
+    fxdata->p[cnv_lowcut].deactivated = true;
+    fxdata->p[cnv_highcut].val.f = fxdata->p[cnv_highcut].val_max.f;
+    fxdata->p[cnv_highcut].deactivated = true;
+
+    fxdata->p[cnv_width].val.f = 0.f;
+    fxdata->p[cnv_mix].val.f = 0.5f;
+}
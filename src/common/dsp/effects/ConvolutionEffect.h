@@ -0,0 +1,94 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_EFFECTS_CONVOLUTIONEFFECT_H
+#define SURGE_SRC_COMMON_DSP_EFFECTS_CONVOLUTIONEFFECT_H
+#include "Effect.h"
+#include "BiquadFilter.h"
+#include "DSPUtils.h"
+#include "ImpulseResponseLoader.h"
+
+#include <vembertech/lipol.h>
+
+/*
+ * Convolves with an impulse response read from the WAV file at fxdata->file_path. A mono IR
+ * runs on both channels, a stereo one left to left and right to right.
+ *
+ * Reading, resampling and partitioning an IR takes far too long for the audio thread, so
+ * that happens on storage's ImpulseResponseLoader. The effect asks for its slot's IR, picks
+ * up the finished one in process() and crossfades into it, and hands the old one back to the
+ * loader to free. Neither process() nor construction or destruction allocates, locks or
+ * waits, so the effect can come and go on the audio thread like any other.
+ */
+class ConvolutionEffect : public Effect
+{
+  public:
+    ConvolutionEffect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd);
+    virtual ~ConvolutionEffect();
+    virtual const char *get_effectname() override { return "convolution"; }
+    virtual void init() override;
+    virtual void process(float *dataL, float *dataR) override;
+    virtual void suspend() override;
+    void setvars(bool init);
+    virtual void init_ctrltypes() override;
+    virtual void init_default_values() override;
+    virtual const char *group_label(int id) override;
+    virtual int group_label_ypos(int id) override;
+    virtual int get_ringout_decay() override { return ringout_value; }
+    virtual void sampleRateReset() override;
+    virtual void filePathChanged() override;
+
+    // for tests and the benchmark: true once the requested IR is the one playing
+    bool isLoaded() const;
+
+    enum convolution_params
+    {
+        cnv_gain = 0,
+
+        cnv_lowcut,
+        cnv_highcut,
+
+        cnv_width,
+        cnv_mix,
+
+        cnv_num_params,
+    };
+
+  private:
+    using ImpulseResponse = Surge::DSP::ImpulseResponse;
+
+    void requestLoad(bool force);
+    void convolve(ImpulseResponse *ir, float *dataL, float *dataR, float *wetL, float *wetR);
+
+    // our index in the patch's fx, or -1 if we aren't playing one of them and never load
+    int slot{-1};
+    uint32_t firstRequest{0}, lastRequest{0};
+
+    ImpulseResponse *current{nullptr}, *fading{nullptr};
+    int fadePos{0};
+    int ringout_value{0};
+
+    BiquadFilter lp, hp;
+    lipol_ps_blocksz gain alignas(16), width alignas(16), mix alignas(16);
+};
+
+#endif // SURGE_SRC_COMMON_DSP_EFFECTS_CONVOLUTIONEFFECT_H
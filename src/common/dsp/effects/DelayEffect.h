@@ -46,6 +46,12 @@ class DelayEffect
 
     virtual void handleStreamingMismatches(int streamingRevision,
                                            int currentSynthStreamingRevision) override;
+
+    // echoes can be a whole delay line apart, with silence between them
+    float get_sleep_hold_seconds() override
+    {
+        return 1.f * max_delay_length / storage->samplerate + 0.05f;
+    }
 };
 
 #endif // SURGE_SRC_COMMON_DSP_EFFECTS_DELAYEFFECT_H
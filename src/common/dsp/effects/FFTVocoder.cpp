@@ -0,0 +1,263 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "FFTVocoder.h"
+#include "pffft.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+// brings the FFT mode to about the level of the filter bank on speech into a saw
+constexpr float outputGain = 0.08f;
+
+// weight of bin k in a triangle rising from lo to 1 at c and falling to hi
+inline float triangle(int k, float lo, float c, float hi)
+{
+    if (k < c)
+        return (k - lo) / (c - lo);
+    if (k > c)
+        return (hi - k) / (hi - c);
+    return 1.f;
+}
+
+float *allocBuffer(int n)
+{
+    auto r = (float *)pffft_aligned_malloc(n * sizeof(float));
+    memset(r, 0, n * sizeof(float));
+    return r;
+}
+} // namespace
+
+FFTVocoder::FFTVocoder(float samplerate)
+{
+    // keep the bins about 40-50Hz wide whatever the rate
+    fftSize = 1024;
+    while (fftSize < 4096 && samplerate > fftSize * 50.f)
+        fftSize *= 2;
+
+    hopSize = fftSize / 4;
+    nBins = fftSize / 2 + 1;
+    binHz = samplerate / fftSize;
+
+    setup = pffft_new_setup(fftSize, PFFFT_REAL);
+
+    window = allocBuffer(fftSize);
+    for (auto b : {&inModL, &inModR, &inCarL, &inCarR, &olaL, &olaR, &frame, &work, &specMod,
+                   &specCarL, &specCarR})
+        *b = allocBuffer(fftSize);
+    for (auto b : {&power, &gain, &gainWeight})
+        *b = allocBuffer(nBins);
+
+    // a periodic Hann on both analysis and synthesis sums to 3/2 at 75% overlap
+    float sumSq = 0.f;
+    for (int i = 0; i < fftSize; ++i)
+    {
+        window[i] = 0.5f - 0.5f * std::cos(2.0 * M_PI * i / fftSize);
+        sumSq += window[i] * window[i];
+    }
+    powerNorm = 1.f / sumSq;
+    olaNorm = 1.f / (fftSize * 1.5f);
+
+    reset();
+}
+
+FFTVocoder::~FFTVocoder()
+{
+    for (auto b : {window, inModL, inModR, inCarL, inCarR, olaL, olaR, frame, work, specMod,
+                   specCarL, specCarR, power, gain, gainWeight})
+        pffft_aligned_free(b);
+    if (setup)
+        pffft_destroy_setup(setup);
+}
+
+void FFTVocoder::reset()
+{
+    for (auto b : {inModL, inModR, inCarL, inCarR, olaL, olaR})
+        memset(b, 0, fftSize * sizeof(float));
+
+    std::fill(envL, envL + maxBands, 0.f);
+    std::fill(envR, envR + maxBands, 0.f);
+    inPos = 0;
+    hopPos = 0;
+}
+
+void FFTVocoder::setBands(int n, float carrierLoHz, float carrierRatio, float modLoHz,
+                          float modRatio, float widthScale)
+{
+    bands = std::clamp(n, 1, maxBands);
+
+    auto place = [this, widthScale](float loHz, float ratio, float *c, float *lo, float *hi) {
+        auto spread = std::pow(ratio, widthScale);
+        auto hz = loHz;
+        for (int b = 0; b < bands; ++b)
+        {
+            // every triangle covers at least the bin nearest its center
+            c[b] = std::clamp(hz / binHz, 0.f, nBins - 1.f);
+            lo[b] = std::max(0.f, std::min(c[b] / spread, c[b] - 1.f));
+            hi[b] = std::min(nBins - 1.f, std::max(c[b] * spread, c[b] + 1.f));
+            hz *= ratio;
+        }
+    };
+
+    place(carrierLoHz, carrierRatio, carCenter, carLo, carHi);
+    place(modLoHz, modRatio, modCenter, modLo, modHi);
+}
+
+void FFTVocoder::setEnvelope(float rate, float gate, float maxLevel)
+{
+    frameRate = 1.f - std::pow(1.f - rate, (float)hopSize);
+    gateLevel = gate;
+    this->maxLevel = maxLevel;
+}
+
+void FFTVocoder::process(const float *modL, const float *modR, bool stereoModulator,
+                         float *dataL, float *dataR, float wet, int nSamples)
+{
+    stereo = stereoModulator;
+    const int mask = fftSize - 1;
+    const float dry = 1.f - wet;
+
+    for (int i = 0; i < nSamples; ++i)
+    {
+        // what we overwrite is exactly latency() old, so the dry lines up with the wet
+        auto dL = inCarL[inPos], dR = inCarR[inPos];
+
+        inModL[inPos] = modL[i];
+        inModR[inPos] = stereo ? modR[i] : 0.f;
+        inCarL[inPos] = dataL[i];
+        inCarR[inPos] = dataR[i];
+
+        dataL[i] = dL * dry + wet * olaL[hopPos];
+        dataR[i] = dR * dry + wet * olaR[hopPos];
+
+        inPos = (inPos + 1) & mask;
+        if (++hopPos == hopSize)
+        {
+            runFrame();
+            hopPos = 0;
+        }
+    }
+}
+
+void FFTVocoder::runFrame()
+{
+    const int mask = fftSize - 1;
+
+    // inPos is now the oldest sample in each ring
+    auto analyse = [&](const float *ring, float *spec) {
+        for (int n = 0; n < fftSize; ++n)
+            frame[n] = ring[(inPos + n) & mask] * window[n];
+        pffft_transform_ordered(setup, frame, spec, work, PFFFT_FORWARD);
+    };
+
+    auto synthesise = [&](const float *spec, float *ola) {
+        pffft_transform_ordered(setup, spec, frame, work, PFFFT_BACKWARD);
+
+        memmove(ola, ola + hopSize, (fftSize - hopSize) * sizeof(float));
+        memset(ola + fftSize - hopSize, 0, hopSize * sizeof(float));
+        for (int n = 0; n < fftSize; ++n)
+            ola[n] += frame[n] * window[n] * olaNorm;
+    };
+
+    analyse(inModL, specMod);
+    bandLevels(specMod, envL);
+
+    analyse(inCarL, specCarL);
+    analyse(inCarR, specCarR);
+
+    computeGains(envL);
+    applyGains(specCarL);
+
+    if (stereo)
+    {
+        analyse(inModR, specMod);
+        bandLevels(specMod, envR);
+        computeGains(envR);
+    }
+    applyGains(specCarR);
+
+    synthesise(specCarL, olaL);
+    synthesise(specCarR, olaR);
+}
+
+void FFTVocoder::bandLevels(const float *spec, float *env)
+{
+    // pffft's ordered real layout packs the real Nyquist term in next to DC
+    power[0] = spec[0] * spec[0];
+    power[nBins - 1] = spec[1] * spec[1];
+    for (int k = 1; k < nBins - 1; ++k)
+        power[k] = spec[2 * k] * spec[2 * k] + spec[2 * k + 1] * spec[2 * k + 1];
+
+    for (int b = 0; b < bands; ++b)
+    {
+        auto c = modCenter[b], lo = modLo[b], hi = modHi[b];
+        float sum = 0.f, wsum = 0.f;
+        for (int k = (int)std::ceil(lo); k <= (int)hi; ++k)
+        {
+            auto w = triangle(k, lo, c, hi);
+            sum += w * power[k];
+            wsum += w;
+        }
+
+        // the mean square of the modulator in this band, as the filter bank would see it
+        auto e = (wsum > 0.f) ? std::min(sum / wsum * powerNorm, maxLevel) : 0.f;
+        if (e < gateLevel)
+            e = 0.f;
+        env[b] += frameRate * (e - env[b]);
+    }
+}
+
+void FFTVocoder::computeGains(const float *env)
+{
+    std::fill(gain, gain + nBins, 0.f);
+    std::fill(gainWeight, gainWeight + nBins, 0.f);
+
+    for (int b = 0; b < bands; ++b)
+    {
+        auto c = carCenter[b], lo = carLo[b], hi = carHi[b];
+        auto g = std::sqrt(env[b]);
+        for (int k = (int)std::ceil(lo); k <= (int)hi; ++k)
+        {
+            auto w = triangle(k, lo, c, hi);
+            gain[k] += w * g;
+            gainWeight[k] += w;
+        }
+    }
+
+    // where wide bands pile up don't let the overlap boost the carrier
+    for (int k = 0; k < nBins; ++k)
+        gain[k] *= outputGain / std::max(1.f, gainWeight[k]);
+}
+
+void FFTVocoder::applyGains(float *spec)
+{
+    spec[0] *= gain[0];
+    spec[1] *= gain[nBins - 1];
+    for (int k = 1; k < nBins - 1; ++k)
+    {
+        spec[2 * k] *= gain[k];
+        spec[2 * k + 1] *= gain[k];
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_EFFECTS_FFTVOCODER_H
+#define SURGE_SRC_COMMON_DSP_EFFECTS_FFTVOCODER_H
+
+struct PFFFT_Setup;
+
+/*
+ * The STFT engine behind the vocoder's FFT mode. Modulator and carrier are analysed with
+ * overlapping Hann windows, the modulator power is summed into log spaced triangular bands
+ * with the same envelope follower and gate as the filter bank, and the band levels are
+ * spread back over the carrier bins and resynthesised by overlap-add.
+ *
+ * The work per frame is the transforms plus one pass over the bins for each band edge, so
+ * the cost hardly moves between 64 and 256 bands. The price is latency: the output (dry
+ * included, so the mix stays phase aligned) runs latency() samples behind the input.
+ */
+class FFTVocoder
+{
+  public:
+    static constexpr int maxBands = 256;
+
+    // The band count parameter keeps its 4..20 range; in FFT mode that maps onto 64..256
+    static int bandsForParam(int bandParam) { return 12 * bandParam + 16; }
+
+    explicit FFTVocoder(float samplerate);
+    ~FFTVocoder();
+
+    void reset();
+
+    /*
+     * Band centers are geometric, from loHz up by ratio. The modulator can be analysed on a
+     * different set of bands to the carrier (the Range/Center controls). widthScale stretches
+     * the triangles, 1 meaning each reaches its neighbours' centers.
+     */
+    void setBands(int n, float carrierLoHz, float carrierRatio, float modLoHz, float modRatio,
+                  float widthScale);
+
+    // rate is the per sample envelope follower coefficient, gate and maxLevel are band power
+    void setEnvelope(float rate, float gate, float maxLevel);
+
+    /*
+     * Vocode dataL/dataR in place, mixing in wet. If stereoModulator is false the modulator
+     * is modL alone and drives both carrier channels.
+     */
+    void process(const float *modL, const float *modR, bool stereoModulator, float *dataL,
+                 float *dataR, float wet, int nSamples);
+
+    int latency() const { return fftSize; }
+
+  private:
+    void runFrame();
+    void bandLevels(const float *spec, float *env);
+    void computeGains(const float *env);
+    void applyGains(float *spec);
+
+    int fftSize, hopSize, nBins;
+    float binHz;
+    PFFFT_Setup *setup{nullptr};
+
+    // all of these are pffft aligned allocations, sized at construction
+    float *window{nullptr};
+    float *inModL{nullptr}, *inModR{nullptr}, *inCarL{nullptr}, *inCarR{nullptr};
+    float *olaL{nullptr}, *olaR{nullptr};
+    float *frame{nullptr}, *work{nullptr};
+    float *specMod{nullptr}, *specCarL{nullptr}, *specCarR{nullptr};
+    float *power{nullptr}, *gain{nullptr}, *gainWeight{nullptr};
+
+    int inPos{0}, hopPos{0};
+    bool stereo{false};
+
+    int bands{0};
+    float carCenter[maxBands], carLo[maxBands], carHi[maxBands];
+    float modCenter[maxBands], modLo[maxBands], modHi[maxBands];
+    float envL[maxBands], envR[maxBands];
+
+    float frameRate{0.f}, gateLevel{0.f}, maxLevel{6.f};
+    float powerNorm{1.f}, olaNorm{1.f};
+};
+
+#endif // SURGE_SRC_COMMON_DSP_EFFECTS_FFTVOCODER_H
@@ -42,6 +42,9 @@ class FlangerEffect : public surge::sstfx::SurgeSSTFXBase<
     virtual void init_ctrltypes() override;
     virtual const char *group_label(int id) override;
     virtual int group_label_ypos(int id) override;
+
+    // the combs sit at audio pitches, so repeats are well under this apart
+    float get_sleep_hold_seconds() override { return 0.25f; }
 };
 
 #endif // SURGE_SRC_COMMON_DSP_EFFECTS_FLANGEREFFECT_H
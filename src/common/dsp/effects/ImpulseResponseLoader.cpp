@@ -0,0 +1,310 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "ImpulseResponseLoader.h"
+#include "samplerate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+// trailing IR below this (-120dB) is trimmed rather than convolved
+constexpr float silenceFloor = 1e-6f;
+} // namespace
+
+namespace Surge
+{
+namespace DSP
+{
+ImpulseResponseLoader::ImpulseResponseLoader(SurgeStorage *s) : storage(s)
+{
+    loader = std::thread([this]() { loaderRun(); });
+}
+
+ImpulseResponseLoader::~ImpulseResponseLoader()
+{
+    {
+        std::lock_guard<std::mutex> g(wakeMutex);
+        stopLoader = true;
+    }
+    wakeCV.notify_all();
+    loader.join();
+
+    for (auto &s : slots)
+        retire(s.ready.exchange(nullptr));
+    freeRetired();
+}
+
+uint32_t ImpulseResponseLoader::request(int slot, float samplerate, bool force)
+{
+    auto &s = slots[slot];
+
+    s.rate.store(samplerate, std::memory_order_relaxed);
+    if (force)
+        s.forced.store(true, std::memory_order_relaxed);
+    s.cancelled.store(false, std::memory_order_relaxed);
+
+    auto id = s.requested.fetch_add(1, std::memory_order_release) + 1;
+    wake();
+    return id;
+}
+
+void ImpulseResponseLoader::cancel(int slot)
+{
+    auto &s = slots[slot];
+
+    s.cancelled.store(true, std::memory_order_relaxed);
+    s.requested.fetch_add(1, std::memory_order_release);
+    wake();
+}
+
+ImpulseResponse *ImpulseResponseLoader::take(int slot, uint32_t since)
+{
+    auto ir = slots[slot].ready.exchange(nullptr, std::memory_order_acquire);
+
+    if (ir && ir->request < since)
+    {
+        retire(ir);
+        return nullptr;
+    }
+    return ir;
+}
+
+bool ImpulseResponseLoader::isSettled(int slot, uint32_t id) const
+{
+    auto &s = slots[slot];
+    return s.completed.load(std::memory_order_acquire) >= id &&
+           s.ready.load(std::memory_order_acquire) == nullptr;
+}
+
+void ImpulseResponseLoader::retire(ImpulseResponse *ir)
+{
+    if (!ir)
+        return;
+
+    // the loader takes the whole list at once, so a plain push is ABA safe
+    auto head = retiredHead.load(std::memory_order_relaxed);
+    do
+    {
+        ir->nextRetired = head;
+    } while (!retiredHead.compare_exchange_weak(head, ir, std::memory_order_release,
+                                                std::memory_order_relaxed));
+}
+
+/*
+ * Effects signal from the audio thread without taking wakeMutex, so a wake can land just
+ * before the loader starts waiting and be missed. The timeout catches that, and also frees
+ * retired IRs from effects which didn't ask for anything new.
+ */
+void ImpulseResponseLoader::wake()
+{
+    wakeWanted.store(true, std::memory_order_release);
+    wakeCV.notify_one();
+}
+
+void ImpulseResponseLoader::loaderRun()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lk(wakeMutex);
+            wakeCV.wait_for(lk, std::chrono::milliseconds(100), [this]() {
+                return stopLoader || wakeWanted.load(std::memory_order_acquire);
+            });
+        }
+
+        if (stopLoader)
+            return;
+        wakeWanted.store(false, std::memory_order_release);
+
+        freeRetired();
+
+        for (int i = 0; i < n_fx_slots && !stopLoader; ++i)
+            serve(i);
+    }
+}
+
+void ImpulseResponseLoader::freeRetired()
+{
+    auto ir = retiredHead.exchange(nullptr, std::memory_order_acquire);
+    while (ir)
+    {
+        auto next = ir->nextRetired;
+        delete ir;
+        ir = next;
+    }
+}
+
+void ImpulseResponseLoader::serve(int slot)
+{
+    auto &s = slots[slot];
+
+    auto id = s.requested.load(std::memory_order_acquire);
+    if (id == s.handled)
+        return;
+    s.handled = id;
+
+    if (s.cancelled.load(std::memory_order_relaxed))
+    {
+        retire(s.ready.exchange(nullptr));
+        s.everDelivered = false;
+        s.completed.store(id, std::memory_order_release);
+        return;
+    }
+
+    auto rate = s.rate.load(std::memory_order_relaxed);
+    auto force = s.forced.exchange(false, std::memory_order_relaxed);
+
+    std::string path;
+    {
+        std::lock_guard<std::mutex> g(storage->fxFilePathMutex);
+        path = storage->getPatch().fx[slot].file_path;
+    }
+
+    if (force || !s.everDelivered || path != s.deliveredPath || rate != s.deliveredRate)
+    {
+        auto ir = build(path, rate);
+
+        // a file which didn't load leaves the last IR playing
+        if (ir)
+        {
+            ir->request = id;
+            s.deliveredPath = path;
+            s.deliveredRate = rate;
+            s.everDelivered = true;
+
+            // anything the effect hadn't picked up yet is stale now
+            retire(s.ready.exchange(ir.release(), std::memory_order_release));
+        }
+    }
+
+    s.completed.store(id, std::memory_order_release);
+}
+
+std::unique_ptr<ImpulseResponse> ImpulseResponseLoader::build(const std::string &path,
+                                                              float samplerate)
+{
+    auto ir = std::make_unique<ImpulseResponse>();
+
+    if (path.empty())
+        return ir;
+
+    std::vector<std::vector<float>> channels;
+    int fileRate;
+
+    if (!storage->load_wav_channels(string_to_path(path), channels, fileRate,
+                                    "Impulse Response Import Error") ||
+        channels[0].empty() || fileRate <= 0)
+        return nullptr;
+
+    // past stereo there is no telling how a file lays its channels out, so use the first two
+    channels.resize(std::min((int)channels.size(), 2));
+
+    if (fileRate != (int)samplerate)
+    {
+        for (auto &c : channels)
+            if (!resample(c, samplerate / fileRate))
+                return nullptr;
+    }
+
+    int length = std::min(channels[0].size(), (size_t)(maxIRSeconds * samplerate));
+    while (length > 1)
+    {
+        bool quiet = true;
+        for (auto &c : channels)
+            quiet = quiet && std::fabs(c[length - 1]) < silenceFloor;
+        if (!quiet)
+            break;
+        length--;
+    }
+
+    // unit energy on the louder channel, so noise in comes out at the level it went in
+    double energy = 0;
+    for (auto &c : channels)
+    {
+        double e = 0;
+        for (int i = 0; i < length; ++i)
+            e += (double)c[i] * c[i];
+        energy = std::max(energy, e);
+    }
+    auto norm = (energy > 0) ? (float)(1.0 / std::sqrt(energy)) : 0.f;
+    for (auto &c : channels)
+        for (int i = 0; i < length; ++i)
+            c[i] *= norm;
+
+    ir->left = std::make_unique<PartitionedConvolver>(channels.front().data(), length, BLOCK_SIZE);
+    ir->right = std::make_unique<PartitionedConvolver>(channels.back().data(), length, BLOCK_SIZE);
+    ir->length = length;
+    return ir;
+}
+
+bool ImpulseResponseLoader::resample(std::vector<float> &data, double ratio)
+{
+    int error;
+    auto src = src_new(SRC_SINC_MEDIUM_QUALITY, 1, &error);
+    if (!src)
+        return false;
+
+    std::vector<float> out((size_t)(data.size() * ratio) + 64);
+    size_t inPos = 0, outPos = 0;
+    bool ok = true;
+
+    // in chunks, so that a loader being shut down doesn't have to finish first
+    while (outPos < out.size())
+    {
+        if (stopLoader)
+        {
+            ok = false;
+            break;
+        }
+
+        SRC_DATA sd;
+        sd.data_in = data.data() + inPos;
+        sd.input_frames = std::min((size_t)8192, data.size() - inPos);
+        sd.data_out = out.data() + outPos;
+        sd.output_frames = out.size() - outPos;
+        sd.end_of_input = (inPos + sd.input_frames == data.size());
+        sd.src_ratio = ratio;
+
+        if (src_process(src, &sd) != 0)
+        {
+            ok = false;
+            break;
+        }
+
+        inPos += sd.input_frames_used;
+        outPos += sd.output_frames_gen;
+
+        if (sd.input_frames_used == 0 && sd.output_frames_gen == 0)
+            break;
+    }
+
+    src_delete(src);
+
+    out.resize(outPos);
+    data.swap(out);
+    return ok && !data.empty();
+}
+} // namespace DSP
+} // namespace Surge
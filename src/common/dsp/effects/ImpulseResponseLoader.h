@@ -0,0 +1,127 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_EFFECTS_IMPULSERESPONSELOADER_H
+#define SURGE_SRC_COMMON_DSP_EFFECTS_IMPULSERESPONSELOADER_H
+
+#include "SurgeStorage.h"
+#include "PartitionedConvolver.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Surge
+{
+namespace DSP
+{
+struct ImpulseResponse
+{
+    // both null means no IR, which silences the wet signal
+    std::unique_ptr<PartitionedConvolver> left, right;
+    int length{0};
+
+    // the request this was built for, and the link while it waits to be freed
+    uint32_t request{0};
+    ImpulseResponse *nextRetired{nullptr};
+};
+
+/*
+ * Reads, resamples and partitions impulse responses for the convolution effects. Storage
+ * owns one of these, so its thread starts and stops with the synth rather than with an
+ * effect, which is spawned and destroyed on the audio thread.
+ *
+ * Requests are keyed by FX slot and carry no strings: the loader reads the slot's file_path
+ * itself under SurgeStorage::fxFilePathMutex. Every call an effect makes here is wait-free;
+ * finished IRs come back through a per slot pointer swap, and IRs an effect is done with
+ * (including whatever it holds when it is destroyed) go onto a lock-free list which this
+ * thread frees. A result whose request has been superseded or cancelled is freed unplayed.
+ */
+class ImpulseResponseLoader
+{
+  public:
+    static constexpr float maxIRSeconds = 20.f;
+
+    explicit ImpulseResponseLoader(SurgeStorage *storage);
+    ~ImpulseResponseLoader();
+
+    /*
+     * Ask for slot's IR at samplerate and return the request id. Unless force is set, a
+     * request for the file and rate last delivered to the slot completes without a rebuild.
+     */
+    uint32_t request(int slot, float samplerate, bool force);
+
+    // drop whatever slot asked for; anything still in flight is freed when it arrives
+    void cancel(int slot);
+
+    /*
+     * The newest IR built for slot, if one has arrived, else null. The caller owns it. One
+     * built for a request older than since (another effect's, say) is retired instead.
+     */
+    ImpulseResponse *take(int slot, uint32_t since);
+
+    // whether request id has been dealt with, successfully or not, and any IR it built taken
+    bool isSettled(int slot, uint32_t id) const;
+
+    // hand an IR back to be freed off the audio thread. Null is fine
+    void retire(ImpulseResponse *ir);
+
+  private:
+    struct Slot
+    {
+        std::atomic<uint32_t> requested{0}, completed{0};
+        std::atomic<float> rate{0.f};
+        std::atomic<bool> forced{false}, cancelled{false};
+        std::atomic<ImpulseResponse *> ready{nullptr};
+
+        // loader thread only
+        uint32_t handled{0};
+        std::string deliveredPath;
+        float deliveredRate{0.f};
+        bool everDelivered{false};
+    };
+
+    void wake();
+    void loaderRun();
+    void freeRetired();
+    void serve(int slot);
+    std::unique_ptr<ImpulseResponse> build(const std::string &path, float samplerate);
+    bool resample(std::vector<float> &data, double ratio);
+
+    SurgeStorage *storage;
+    Slot slots[n_fx_slots];
+
+    std::atomic<ImpulseResponse *> retiredHead{nullptr};
+
+    std::thread loader;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCV;
+    std::atomic<bool> wakeWanted{false}, stopLoader{false};
+};
+} // namespace DSP
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_DSP_EFFECTS_IMPULSERESPONSELOADER_H
@@ -57,6 +57,8 @@ NimbusEffect::NimbusEffect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd)
     {
         euroSR_to_surgeSR = nullptr;
     }
+
+    sampleRateReset();
 }
 
 NimbusEffect::~NimbusEffect()
@@ -83,19 +85,46 @@ void NimbusEffect::init()
     builtBuffer = false;
     resampReadPtr = 0;
     resampWritePtr = 1; // why 1? well while we are stalling we want to output 0 so write 1 ahead
-}
 
-void NimbusEffect::setvars(bool init) {}
+    if (surgeSR_to_euroPR)
+        surgeSR_to_euroPR->reset();
+    if (euroSR_to_surgePR)
+        euroSR_to_surgePR->reset();
+}
 
-void NimbusEffect::process(float *dataL, float *dataR)
+void NimbusEffect::sampleRateReset()
 {
-    setvars(false);
+    auto sr = storage->samplerate;
+    surgeSR_to_euroPR.reset();
+    euroSR_to_surgePR.reset();
 
-    if (!surgeSR_to_euroSR || !euroSR_to_surgeSR)
+    if (!Surge::DSP::PolyphaseResampler::supports(sr, processor_sr))
         return;
 
-    /* Resample Temp Buffers */
-    float resample_this[BLOCK_SIZE << 3][2];
+    auto to = std::make_unique<Surge::DSP::PolyphaseResampler>((int)sr, processor_sr);
+    auto from = std::make_unique<Surge::DSP::PolyphaseResampler>(processor_sr, (int)sr);
+
+    // a block's worth in, plus at most one held back stub, has to fit both ways
+    auto toFrames = to->maxOutputFrames(BLOCK_SIZE);
+    auto fromFrames = from->maxOutputFrames(toFrames + nimbusprocess_blocksize);
+    if (toFrames <= euro_sz && fromFrames <= euro_sz)
+    {
+        surgeSR_to_euroPR = std::move(to);
+        euroSR_to_surgePR = std::move(from);
+    }
+}
+
+int NimbusEffect::resampleToProcessor(float *dataL, float *dataR, float *euroL, float *euroR,
+                                      int maxOut)
+{
+    if (surgeSR_to_euroPR)
+    {
+        assert(surgeSR_to_euroPR->maxOutputFrames(BLOCK_SIZE) <= maxOut);
+        consumed += BLOCK_SIZE;
+        return surgeSR_to_euroPR->process(dataL, dataR, BLOCK_SIZE, euroL, euroR);
+    }
+
+    float resample_this[BLOCK_SIZE][2];
     float resample_into[BLOCK_SIZE << 3][2];
 
     for (int i = 0; i < BLOCK_SIZE; ++i)
@@ -110,16 +139,75 @@ void NimbusEffect::process(float *dataL, float *dataR)
     sdata.data_in = &(resample_this[0][0]);
     sdata.data_out = &(resample_into[0][0]);
     sdata.input_frames = BLOCK_SIZE;
-    sdata.output_frames = (BLOCK_SIZE << 3);
-    auto res = src_process(surgeSR_to_euroSR, &sdata);
+    sdata.output_frames = std::min(maxOut, BLOCK_SIZE << 3);
+    src_process(surgeSR_to_euroSR, &sdata);
     consumed += sdata.input_frames_used;
 
-    if (sdata.output_frames_gen)
+    for (int i = 0; i < sdata.output_frames_gen; ++i)
+    {
+        euroL[i] = resample_into[i][0];
+        euroR[i] = resample_into[i][1];
+    }
+    return sdata.output_frames_gen;
+}
+
+int NimbusEffect::resampleFromProcessor(float *euroL, float *euroR, int nIn, float *outL,
+                                        float *outR, int maxOut)
+{
+    if (euroSR_to_surgePR)
+    {
+        assert(euroSR_to_surgePR->maxOutputFrames(nIn) <= maxOut);
+        return euroSR_to_surgePR->process(euroL, euroR, nIn, outL, outR);
+    }
+
+    float resample_this[BLOCK_SIZE << 3][2];
+    float resample_into[BLOCK_SIZE << 3][2];
+
+    for (int i = 0; i < nIn; ++i)
+    {
+        resample_this[i][0] = euroL[i];
+        resample_this[i][1] = euroR[i];
+    }
+
+    SRC_DATA odata;
+    odata.end_of_input = 0;
+    odata.src_ratio = processor_sr_inv * storage->samplerate;
+    odata.data_in = &(resample_this[0][0]);
+    odata.data_out = &(resample_into[0][0]);
+    odata.input_frames = nIn;
+    odata.output_frames = std::min(maxOut, BLOCK_SIZE << 3);
+    src_process(euroSR_to_surgeSR, &odata);
+
+    for (int i = 0; i < odata.output_frames_gen; ++i)
+    {
+        outL[i] = resample_into[i][0];
+        outR[i] = resample_into[i][1];
+    }
+    return odata.output_frames_gen;
+}
+
+void NimbusEffect::setvars(bool init) {}
+
+void NimbusEffect::process(float *dataL, float *dataR)
+{
+    setvars(false);
+
+    if (!surgeSR_to_euroPR && (!surgeSR_to_euroSR || !euroSR_to_surgeSR))
+        return;
+
+    /* Resample Temp Buffers, planar at the processor rate and then back at ours */
+    float euroInL[euro_sz], euroInR[euro_sz];
+    float euroOutL[euro_sz], euroOutR[euro_sz];
+    float hostL[euro_sz], hostR[euro_sz];
+
+    auto framesGen = resampleToProcessor(dataL, dataR, euroInL, euroInR, euro_sz);
+
+    if (framesGen)
     {
         clouds::ShortFrame input[BLOCK_SIZE << 3];
         clouds::ShortFrame output[BLOCK_SIZE << 3];
 
-        int frames_to_go = sdata.output_frames_gen;
+        int frames_to_go = framesGen;
         int outpos = 0;
 
         processor->set_playback_mode(
@@ -140,8 +228,8 @@ void NimbusEffect::process(float *dataL, float *dataR)
 
             for (int i = sp; i < nimbusprocess_blocksize; ++i)
             {
-                input[i].l = (short)(clamp1bp(resample_into[consume_ptr][0]) * 32767.0f);
-                input[i].r = (short)(clamp1bp(resample_into[consume_ptr][1]) * 32767.0f);
+                input[i].l = (short)(clamp1bp(euroInL[consume_ptr]) * 32767.0f);
+                input[i].r = (short)(clamp1bp(euroInR[consume_ptr]) * 32767.0f);
                 consume_ptr++;
             }
 
@@ -173,8 +261,8 @@ void NimbusEffect::process(float *dataL, float *dataR)
 
             for (int i = 0; i < inputSz; ++i)
             {
-                resample_this[outpos + i][0] = output[i].l / 32767.0f;
-                resample_this[outpos + i][1] = output[i].r / 32767.0f;
+                euroOutL[outpos + i] = output[i].l / 32767.0f;
+                euroOutR[outpos + i] = output[i].r / 32767.0f;
             }
             outpos += inputSz;
             frames_to_go -= (nimbusprocess_blocksize - sp);
@@ -188,30 +276,23 @@ void NimbusEffect::process(float *dataL, float *dataR)
 
             for (int i = 0; i < addStub; ++i)
             {
-                stub_input[0][i + startSub] = resample_into[consume_ptr][0];
-                stub_input[1][i + startSub] = resample_into[consume_ptr][1];
+                stub_input[0][i + startSub] = euroInL[consume_ptr];
+                stub_input[1][i + startSub] = euroInR[consume_ptr];
                 consume_ptr++;
             }
         }
 
         if (outpos > 0)
         {
-            SRC_DATA odata;
-            odata.end_of_input = 0;
-            odata.src_ratio = processor_sr_inv * storage->samplerate;
-            odata.data_in = &(resample_this[0][0]);
-            odata.data_out = &(resample_into[0][0]);
-            odata.input_frames = outpos;
-            odata.output_frames = BLOCK_SIZE << 3;
-            auto reso = src_process(euroSR_to_surgeSR, &odata);
+            auto hostGen = resampleFromProcessor(euroOutL, euroOutR, outpos, hostL, hostR, euro_sz);
             if (!builtBuffer)
-                created += odata.output_frames_gen;
+                created += hostGen;
 
             size_t w = resampWritePtr;
-            for (int i = 0; i < odata.output_frames_gen; ++i)
+            for (int i = 0; i < hostGen; ++i)
             {
-                resampled_output[w][0] = resample_into[i][0];
-                resampled_output[w][1] = resample_into[i][1];
+                resampled_output[w][0] = hostL[i];
+                resampled_output[w][1] = hostR[i];
 
                 w = (w + 1U) & (raw_out_sz - 1U);
             }
@@ -24,6 +24,7 @@
 #define SURGE_SRC_COMMON_DSP_EFFECTS_NIMBUSEFFECT_H
 
 #include "Effect.h"
+#include "PolyphaseResampler.h"
 
 #include <memory>
 #include <vembertech/lipol.h>
@@ -70,6 +71,7 @@ class NimbusEffect : public Effect
     virtual void init() override;
     virtual void process(float *dataL, float *dataR) override;
     virtual void suspend() override;
+    virtual void sampleRateReset() override;
     void setvars(bool init);
     virtual void init_ctrltypes() override;
     virtual void init_default_values() override;
@@ -78,6 +80,10 @@ class NimbusEffect : public Effect
     virtual int group_label_ypos(int id) override;
 
     virtual int get_ringout_decay() override { return -1; }
+    // sparse grains (or a frozen buffer) can go quiet for a while then play again
+    virtual float get_sleep_hold_seconds() override { return 4.f; }
+    // the clouds processor uses the stmlib random generator, whose state is static
+    virtual bool drawsFromSharedRNG() override { return true; }
 
   private:
     uint8_t *block_mem, *block_ccm;
@@ -86,8 +92,21 @@ class NimbusEffect : public Effect
     static constexpr float processor_sr_inv = 1.f / 32000;
     int old_nmb_mode = 0;
 
+    /*
+     * At the usual host rates the conversion to and from the processor rate is a fixed ratio,
+     * so we use a precomputed polyphase resampler and only fall back to libsamplerate when
+     * the ratio doesn't reduce, or when a block could resample to more frames than the
+     * euro_sz buffers in process() hold (which is also what we do if the polyphase ones are
+     * null). libsamplerate is told the buffer size, so it stops short instead.
+     */
+    static constexpr int euro_sz = BLOCK_SIZE << 3;
+    std::unique_ptr<Surge::DSP::PolyphaseResampler> surgeSR_to_euroPR, euroSR_to_surgePR;
     SRC_STATE_tag *surgeSR_to_euroSR, *euroSR_to_surgeSR;
 
+    int resampleToProcessor(float *dataL, float *dataR, float *euroL, float *euroR, int maxOut);
+    int resampleFromProcessor(float *euroL, float *euroR, int nIn, float *outL, float *outR,
+                              int maxOut);
+
     static constexpr int raw_out_sz = BLOCK_SIZE_OS << 5; // power of 2 pls
     float resampled_output[raw_out_sz][2];                // at sr
     size_t resampReadPtr = 0, resampWritePtr = 1;         // see comment in init
@@ -74,6 +74,8 @@ class ResonatorEffect : public Effect
     virtual void sampleRateReset() override;
     virtual void process(float *dataL, float *dataR) override;
     virtual int get_ringout_decay() override { return -1; }
+    // resonant bandpasses ring down smoothly, so once quiet they stay quiet
+    virtual float get_sleep_hold_seconds() override { return 0.05f; }
     virtual void suspend() override;
     void setvars(bool init);
     virtual void init_ctrltypes() override;
@@ -173,6 +173,9 @@ template <typename T> struct SurgeSSTFXBase : T
 
     int get_ringout_decay() override { return T::getRingoutDecay(); }
 
+    // the sst effects can reach the storage RNG through rand01 in the config
+    bool drawsFromSharedRNG() override { return true; }
+
     const char *get_effectname() override { return T::effectName; }
 
     void init_default_values() override
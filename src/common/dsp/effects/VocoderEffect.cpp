@@ -20,6 +20,7 @@
  * https://github.com/surge-synthesizer/surge
  */
 #include "VocoderEffect.h"
+#include "FFTVocoder.h"
 #include <algorithm>
 #include "globals.h"
 #include "sst/basic-blocks/mechanics/block-ops.h"
@@ -61,6 +62,8 @@ VocoderEffect::VocoderEffect(SurgeStorage *storage, FxStorage *fxdata, pdata *pd
         mEnvF[i] = vZero;
         mEnvFR[i] = vZero;
     }
+
+    fftEngine = std::make_unique<FFTVocoder>(storage->samplerate);
 }
 
 //------------------------------------------------------------------------------------------------
@@ -69,7 +72,19 @@ VocoderEffect::~VocoderEffect() {}
 
 //------------------------------------------------------------------------------------------------
 
-void VocoderEffect::init() { setvars(true); }
+void VocoderEffect::init()
+{
+    setvars(true);
+    fftEngine->reset();
+}
+
+//------------------------------------------------------------------------------------------------
+
+void VocoderEffect::sampleRateReset()
+{
+    fftEngine = std::make_unique<FFTVocoder>(storage->samplerate);
+    setvars(true);
+}
 
 //------------------------------------------------------------------------------------------------
 
@@ -82,10 +97,17 @@ void VocoderEffect::setvars(bool init)
     const float Q = 20.f * (1.f + 0.5f * *pd_float[voc_q]);
     const float Spread = 0.4f / Q;
 
+    fftMode = fxdata->p[voc_num_bands].deform_type == ve_fft;
+
     active_bands = *pd_int[voc_num_bands];
     // FIXME - adjust the UI to be chunks of 4
     active_bands = active_bands - (active_bands % 4);
 
+    if (fftMode)
+    {
+        active_bands = FFTVocoder::bandsForParam(active_bands);
+    }
+
     // We need to clamp these in reasonable ranges
     float flo = limit_range(*pd_float[voc_minfreq], -36.f, 36.f);
     float fhi = limit_range(*pd_float[voc_maxfreq], 0.f, 60.f);
@@ -133,7 +155,13 @@ void VocoderEffect::setvars(bool init)
         mdhz = pow(2.f, dM / 12.f);
     }
 
-    for (int i = 0; i < active_bands && i < n_vocoder_bands; i++)
+    if (fftMode)
+    {
+        // the filter bank spreads each band by 0.4/Q either side of its center
+        fftEngine->setBands(active_bands, fb, dhz, mb, mdhz, 20.f / Q);
+    }
+
+    for (int i = 0; !fftMode && i < active_bands && i < n_vocoder_bands; i++)
     {
         Freq[i & 3] = fb * storage->samplerate_inv;
         FreqM[i & 3] = mb * storage->samplerate_inv;
@@ -181,7 +209,31 @@ void VocoderEffect::process(float *dataL, float *dataR)
 {
     mBI = (mBI + 1) & 0x3f;
 
-    if (mBI == 0)
+    bool wantFFT = fxdata->p[voc_num_bands].deform_type == ve_fft;
+
+    // the engine we switch to starts from silence rather than wherever it was left. This
+    // happens before setvars since resetting the filters clears their coefficients too.
+    if (wantFFT != fftMode)
+    {
+        if (wantFFT)
+        {
+            fftEngine->reset();
+        }
+        else
+        {
+            for (int i = 0; i < voc_vector_size; i++)
+            {
+                mCarrierL[i].Reset();
+                mCarrierR[i].Reset();
+                mModulator[i].Reset();
+                mModulatorR[i].Reset();
+                mEnvF[i] = vZero;
+                mEnvFR[i] = vZero;
+            }
+        }
+    }
+
+    if (mBI == 0 || wantFFT != fftMode)
     {
         setvars(false);
     }
@@ -219,6 +271,16 @@ void VocoderEffect::process(float *dataL, float *dataR)
 
     const vFloat MaxLevel = vLoad1(6.f);
 
+    if (fftMode)
+    {
+        float *input = (modulator_mode == vim_right) ? modulator_inR : modulator_in;
+
+        fftEngine->setEnvelope(EnvFRate, Gate * Gate, 6.f);
+        fftEngine->process(input, modulator_inR, modulator_mode == vim_stereo, dataL, dataR, wet,
+                           BLOCK_SIZE);
+        return;
+    }
+
     // Voiced / Unvoiced detection
     /*   mVoicedDetect.process_block_to(modulator_in, modulator_tbuf);
        float a = min(4.f, get_squaremax(modulator_tbuf,BLOCK_SIZE_QUAD));
@@ -331,6 +393,7 @@ void VocoderEffect::init_default_values()
     fxdata->p[voc_q].val.f = 0.f;
 
     fxdata->p[voc_num_bands].val.i = n_vocoder_bands;
+    fxdata->p[voc_num_bands].deform_type = ve_filterbank;
 
     fxdata->p[voc_minfreq].val.f = 12.f * log(vocoder_freq_vsm201[0] / 440.f) / log(2.f);
     fxdata->p[voc_maxfreq].val.f =
@@ -444,6 +507,7 @@ void VocoderEffect::handleStreamingMismatches(int streamingRevision,
     if (streamingRevision <= 10)
     {
         fxdata->p[voc_num_bands].val.i = n_vocoder_bands;
+        fxdata->p[voc_num_bands].deform_type = ve_filterbank;
 
         fxdata->p[voc_minfreq].val.f = 12.f * log(vocoder_freq_vsm201[0] / 440.f) / log(2.f);
         fxdata->p[voc_maxfreq].val.f =
@@ -29,8 +29,11 @@
 
 #include "VectorizedSVFilter.h"
 
+#include <memory>
 #include <vembertech/lipol.h>
 
+class FFTVocoder;
+
 const int n_vocoder_bands = 20;
 const int voc_vector_size = n_vocoder_bands >> 2;
 
@@ -45,6 +48,13 @@ class VocoderEffect : public Effect
         vim_stereo,
     };
 
+    // chosen with the deform menu on the band count
+    enum vocoder_engines
+    {
+        ve_filterbank,
+        ve_fft,
+    };
+
     enum vocoder_params
     {
         voc_input_gain,
@@ -75,7 +85,9 @@ class VocoderEffect : public Effect
     virtual void init() override;
     virtual void process(float *dataL, float *dataR) override;
     virtual void suspend() override;
+    virtual void sampleRateReset() override;
     virtual int get_ringout_decay() override { return 500; }
+    virtual bool drawsFromSharedRNG() override { return true; }
     void setvars(bool init);
     virtual void init_ctrltypes() override;
     virtual void init_default_values() override;
@@ -99,6 +111,10 @@ class VocoderEffect : public Effect
     int mBI; // block increment (to keep track of events not occurring every n blocks)
     int active_bands;
 
+    // the FFT engine is always there so switching modes never allocates on the audio thread
+    std::unique_ptr<FFTVocoder> fftEngine;
+    bool fftMode{false};
+
     /*
     float mVoicedLevel;
     float mUnvoicedLevel;
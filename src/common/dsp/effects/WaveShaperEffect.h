@@ -49,6 +49,8 @@ class WaveShaperEffect : public Effect
     virtual int group_label_ypos(int id) override;
 
     virtual int get_ringout_decay() override { return -1; }
+    // only the pre and post filters hold state, and they decay without going quiet and back
+    virtual float get_sleep_hold_seconds() override { return 0.05f; }
 
     enum wsfx_params
     {
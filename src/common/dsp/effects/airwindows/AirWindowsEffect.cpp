@@ -272,7 +272,10 @@ void AirWindowsEffect::process(float *dataL, float *dataR)
         out[0] = &(outL[0]) + subb * QBLOCK;
         out[1] = &(outR[0]) + subb * QBLOCK;
 
-        airwin->processReplacing(in, out, QBLOCK);
+        if (simdKernel)
+            simdKernel->process(airwin.get(), in, out, QBLOCK);
+        else
+            airwin->processReplacing(in, out, QBLOCK);
     }
 
     mech::copy_from_to<BLOCK_SIZE>(outL, dataL);
@@ -292,6 +295,7 @@ void AirWindowsEffect::setupSubFX(int sfx, bool useStreamedValues)
 
     airwin = r.create(r.id, storage->dsamplerate, dp); // FIXME
     airwin->storage = storage;
+    simdKernel = Surge::AirWindows::createSIMDKernel(r.name);
 
     char fxname[1024];
     airwin->getEffectName(fxname);
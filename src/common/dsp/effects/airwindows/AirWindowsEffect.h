@@ -25,6 +25,7 @@
 
 #include "Effect.h"
 #include "airwindows/AirWinBaseClass.h"
+#include "AirWindowsSIMD.h"
 
 #include <vector>
 #include "UserDefaults.h"
@@ -48,6 +49,11 @@ class alignas(16) AirWindowsEffect : public Effect
 
     virtual void process(float *dataL, float *dataR) override;
 
+    // a good few of the algorithms dither or add noise from the global rand() every sample
+    virtual bool drawsFromSharedRNG() override { return true; }
+    // the ports include echoes and reverbs with long predelays, which we can't tell apart here
+    virtual float get_sleep_hold_seconds() override { return 2.f; }
+
     virtual const char *group_label(int id) override;
     virtual int group_label_ypos(int id) override;
 
@@ -70,6 +76,8 @@ class alignas(16) AirWindowsEffect : public Effect
 
     void setupSubFX(int awfx, bool useStreamedValues);
     std::unique_ptr<AirWinBaseClass> airwin;
+    // runs in place of airwin's processReplacing for the algorithms which have one
+    std::unique_ptr<Surge::AirWindows::SIMDKernel> simdKernel;
     int lastSelected = -1;
 
     void sampleRateReset() override
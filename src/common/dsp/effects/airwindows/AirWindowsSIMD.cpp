@@ -0,0 +1,264 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "AirWindowsSIMD.h"
+#include "globals.h"
+
+#include <cmath>
+
+namespace Surge
+{
+namespace AirWindows
+{
+namespace
+{
+typedef __m128d lr_t; // lane 0 is left, lane 1 is right
+
+inline lr_t loadLR(const float *l, const float *r, int i) { return _mm_set_pd(r[i], l[i]); }
+
+inline void storeLR(lr_t v, float *l, float *r, int i)
+{
+    double d alignas(16)[2];
+    _mm_store_pd(d, v);
+    l[i] = (float)d[0];
+    r[i] = (float)d[1];
+}
+
+inline lr_t splat(double d) { return _mm_set1_pd(d); }
+
+inline lr_t absLR(lr_t v) { return _mm_andnot_pd(_mm_set1_pd(-0.0), v); }
+
+inline lr_t select(lr_t mask, lr_t ifTrue, lr_t ifFalse)
+{
+    return _mm_or_pd(_mm_and_pd(mask, ifTrue), _mm_andnot_pd(mask, ifFalse));
+}
+
+// sin(x) for x in [-pi/2, pi/2], Taylor to x^13 so the error is under 1e-9
+inline lr_t sinQuadrant(lr_t x)
+{
+    auto x2 = _mm_mul_pd(x, x);
+    auto r = _mm_sub_pd(splat(1.0), _mm_mul_pd(x2, splat(1.0 / 156.0)));
+    for (double d : {110.0, 72.0, 42.0, 20.0, 6.0})
+        r = _mm_sub_pd(splat(1.0), _mm_mul_pd(_mm_mul_pd(x2, splat(1.0 / d)), r));
+    return _mm_mul_pd(x, r);
+}
+
+// cos(x) for x in [0, pi/2]
+inline lr_t cosQuadrant(lr_t x)
+{
+    return sinQuadrant(_mm_sub_pd(splat(1.5707963267948966), x));
+}
+
+// sin(x) for any x a float sample can reasonably drive, folded into [-pi/2, pi/2]
+inline lr_t sinAny(lr_t x)
+{
+    const auto twoPi = splat(2.0 * M_PI), pi = splat(M_PI), halfPi = splat(M_PI * 0.5);
+    auto k = _mm_cvtepi32_pd(_mm_cvtpd_epi32(_mm_mul_pd(x, splat(0.5 / M_PI))));
+    auto y = _mm_sub_pd(x, _mm_mul_pd(k, twoPi));
+    y = select(_mm_cmpgt_pd(y, halfPi), _mm_sub_pd(pi, y), y);
+    y = select(_mm_cmplt_pd(y, _mm_sub_pd(_mm_setzero_pd(), halfPi)),
+               _mm_sub_pd(_mm_sub_pd(_mm_setzero_pd(), pi), y), y);
+    return sinQuadrant(y);
+}
+
+inline double overallScale(AirWinBaseClass *p) { return p->getSampleRate() / 44100.0; }
+
+/*
+ * Density and Drive share the alternating one pole highpass at the front and the output and
+ * dry/wet stage at the back.
+ */
+struct HighpassFront
+{
+    lr_t iirA{_mm_setzero_pd()}, iirB{_mm_setzero_pd()};
+    bool fpFlip{true};
+
+    inline lr_t process(lr_t x, lr_t iirAmount, lr_t oneMinusIirAmount)
+    {
+        auto &iir = fpFlip ? iirA : iirB;
+        iir = _mm_add_pd(_mm_mul_pd(iir, oneMinusIirAmount), _mm_mul_pd(x, iirAmount));
+        fpFlip = !fpFlip;
+        return _mm_sub_pd(x, iir);
+    }
+};
+
+inline lr_t outputStage(lr_t x, lr_t dry, double output, double wet)
+{
+    if (output < 1.0)
+        x = _mm_mul_pd(x, splat(output));
+    if (wet < 1.0)
+        x = _mm_add_pd(_mm_mul_pd(dry, splat(1.0 - wet)), _mm_mul_pd(x, splat(wet)));
+    return x;
+}
+
+struct DensityKernel : SIMDKernel
+{
+    HighpassFront front;
+
+    void process(AirWinBaseClass *p, float **in, float **out, int sampleFrames) override
+    {
+        double density = (p->getParameter(0) * 5.0) - 1.0;
+        double iirAmount = pow(p->getParameter(1), 3) / overallScale(p);
+        double output = p->getParameter(2);
+        double wet = p->getParameter(3);
+        double outAmt = fabs(density);
+        density = density * fabs(density);
+        while (outAmt > 1.0)
+            outAmt = outAmt - 1.0;
+
+        int fullRectifications = 0;
+        for (double count = density; count > 1.0; count -= 1.0)
+            fullRectifications++;
+
+        const auto halfPi = splat(1.57079633);
+        const auto zero = _mm_setzero_pd();
+        const auto amt = splat(iirAmount), oneMinusAmt = splat(1.0 - iirAmount);
+        const auto blendDry = splat(1.0 - outAmt), blendWet = splat(outAmt);
+
+        for (int i = 0; i < sampleFrames; ++i)
+        {
+            auto x = loadLR(in[0], in[1], i);
+            auto dry = x;
+
+            x = front.process(x, amt, oneMinusAmt);
+
+            for (int c = 0; c < fullRectifications; ++c)
+            {
+                auto br = sinQuadrant(_mm_min_pd(_mm_mul_pd(absLR(x), halfPi), halfPi));
+                x = select(_mm_cmpgt_pd(x, zero), br, _mm_sub_pd(zero, br));
+            }
+
+            auto br = _mm_min_pd(_mm_mul_pd(absLR(x), halfPi), halfPi);
+            if (density > 0)
+                br = sinQuadrant(br);
+            else
+                br = _mm_sub_pd(splat(1.0), cosQuadrant(br));
+            auto kept = _mm_mul_pd(x, blendDry);
+            br = _mm_mul_pd(br, blendWet);
+            x = select(_mm_cmpgt_pd(x, zero), _mm_add_pd(kept, br), _mm_sub_pd(kept, br));
+
+            storeLR(outputStage(x, dry, output, wet), out[0], out[1], i);
+        }
+    }
+};
+
+struct DriveKernel : SIMDKernel
+{
+    HighpassFront front;
+
+    void process(AirWinBaseClass *p, float **in, float **out, int sampleFrames) override
+    {
+        double driveone = pow(p->getParameter(0) * 2.0, 2);
+        double iirAmount = pow(p->getParameter(1), 3) / overallScale(p);
+        double output = p->getParameter(2);
+        double wet = p->getParameter(3);
+        constexpr double glitch = 0.60;
+
+        int glitchStages = 0;
+        double outAmt = driveone;
+        while (outAmt > glitch)
+        {
+            outAmt -= glitch;
+            glitchStages++;
+        }
+
+        const auto amt = splat(iirAmount), oneMinusAmt = splat(1.0 - iirAmount);
+        const auto g = splat(glitch), gGain = splat(1.0 + glitch);
+        const auto o = splat(outAmt), oGain = splat(1.0 + outAmt);
+
+        auto shape = [](lr_t x, lr_t k, lr_t gain) {
+            auto a = _mm_mul_pd(absLR(x), k);
+            return _mm_mul_pd(_mm_sub_pd(x, _mm_mul_pd(_mm_mul_pd(x, a), a)), gain);
+        };
+
+        for (int i = 0; i < sampleFrames; ++i)
+        {
+            auto x = loadLR(in[0], in[1], i);
+            auto dry = x;
+
+            x = front.process(x, amt, oneMinusAmt);
+            x = _mm_max_pd(_mm_min_pd(x, splat(1.0)), splat(-1.0));
+
+            for (int s = 0; s < glitchStages; ++s)
+                x = shape(x, g, gGain);
+            x = shape(x, o, oGain);
+
+            storeLR(outputStage(x, dry, output, wet), out[0], out[1], i);
+        }
+    }
+};
+
+struct MojoKernel : SIMDKernel
+{
+    void process(AirWinBaseClass *p, float **in, float **out, int sampleFrames) override
+    {
+        double gain = pow(10.0, ((p->getParameter(0) * 24.0) - 12.0) / 20.0);
+        const auto zero = _mm_setzero_pd();
+
+        for (int i = 0; i < sampleFrames; ++i)
+        {
+            auto x = loadLR(in[0], in[1], i);
+            if (gain != 1.0)
+                x = _mm_mul_pd(x, splat(gain));
+
+            // mojo is |x|^0.25, and a sample of zero is left alone
+            auto mojo = _mm_sqrt_pd(_mm_sqrt_pd(absLR(x)));
+            auto folded = sinAny(_mm_mul_pd(_mm_mul_pd(x, mojo), splat(M_PI * 0.5)));
+            folded = _mm_mul_pd(_mm_div_pd(folded, mojo), splat(0.987654321));
+            x = select(_mm_cmpgt_pd(mojo, zero), folded, x);
+
+            storeLR(x, out[0], out[1], i);
+        }
+    }
+};
+
+struct KernelEntry
+{
+    const char *name;
+    std::unique_ptr<SIMDKernel> (*create)();
+};
+
+template <typename K> std::unique_ptr<SIMDKernel> make() { return std::make_unique<K>(); }
+
+const KernelEntry kernels[] = {
+    {"Density", make<DensityKernel>},
+    {"Drive", make<DriveKernel>},
+    {"Mojo", make<MojoKernel>},
+};
+} // namespace
+
+std::unique_ptr<SIMDKernel> createSIMDKernel(const std::string &name)
+{
+    for (const auto &k : kernels)
+        if (name == k.name)
+            return k.create();
+    return nullptr;
+}
+
+std::vector<std::string> simdKernelNames()
+{
+    std::vector<std::string> res;
+    for (const auto &k : kernels)
+        res.push_back(k.name);
+    return res;
+}
+} // namespace AirWindows
+} // namespace Surge
@@ -0,0 +1,58 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_EFFECTS_AIRWINDOWS_AIRWINDOWSSIMD_H
+#define SURGE_SRC_COMMON_DSP_EFFECTS_AIRWINDOWS_AIRWINDOWSSIMD_H
+
+#include "airwindows/AirWinBaseClass.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Surge
+{
+namespace AirWindows
+{
+/*
+ * The Airwindows ports are scalar loops which run left then right for each sample, mostly
+ * in long double. A SIMDKernel is a rewrite of one of them with left and right as the two
+ * double lanes of an SSE2 register, so a sample of both channels is one pass. They keep
+ * their own copy of the algorithm's state and read the parameters from the scalar instance,
+ * which still owns them, the display and the streaming. The output is within rounding of
+ * the scalar path; the sine shapers use a polynomial rather than libm.
+ */
+struct SIMDKernel
+{
+    virtual ~SIMDKernel() = default;
+    virtual void process(AirWinBaseClass *params, float **in, float **out, int sampleFrames) = 0;
+};
+
+// A kernel for the registered Airwindows name, or null if that one only runs scalar
+std::unique_ptr<SIMDKernel> createSIMDKernel(const std::string &name);
+
+// The registered names of every Airwindows with a kernel
+std::vector<std::string> simdKernelNames();
+} // namespace AirWindows
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_DSP_EFFECTS_AIRWINDOWS_AIRWINDOWSSIMD_H
@@ -77,6 +77,8 @@ class TapeEffect : public Effect
     virtual void process(float *dataL, float *dataR) override;
     virtual void suspend() override;
     virtual int get_ringout_decay() override { return -1; };
+    // hysteresis, loss and degrade filters are all short; degrade noise keeps it awake anyway
+    virtual float get_sleep_hold_seconds() override { return 0.05f; }
 
     virtual void init_ctrltypes() override;
     virtual void init_default_values() override;
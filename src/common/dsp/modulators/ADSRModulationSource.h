@@ -126,6 +126,13 @@ class ADSRModulationSource : public ModulationSource
         }
     }
 
+    /*
+     * A voice started part way into a block (see SurgeVoice::setStartOffset) only sounds for
+     * the last fraction of that block, so the envelope advances by just that fraction of a
+     * block on its next process_block, keeping it in step with the delayed audio.
+     */
+    void setNextBlockFraction(float f) { blockFraction = f; }
+
     virtual const char *get_title() override { return "envelope"; }
     virtual int get_type() override { return mst_adsr; }
     virtual bool per_voice() override { return true; }
@@ -167,11 +174,14 @@ class ADSRModulationSource : public ModulationSource
     bool correctAnalogMode{false};
     virtual void process_block() override
     {
+        auto frac = blockFraction;
+        blockFraction = 1.f;
+
         if (lc[mode].b)
         {
             if (correctAnalogMode)
             {
-                doCorrectAnalogMode();
+                doCorrectAnalogMode(frac);
                 return;
             }
             /*
@@ -242,6 +252,9 @@ class ADSRModulationSource : public ModulationSource
                            std::min(0.f, coeff_offset - lc[r].f * (adsr->r.temposync
                                                                        ? storage->temposyncratio
                                                                        : 1.f)));
+            coef_A *= frac;
+            coef_D *= frac;
+            coef_R *= frac;
 
             v_c1 = _mm_add_ss(v_c1, _mm_mul_ss(diff_v_a, _mm_load_ss(&coef_A)));
             v_c1 = _mm_add_ss(v_c1, _mm_mul_ss(diff_v_d, _mm_load_ss(&coef_D)));
@@ -269,7 +282,7 @@ class ADSRModulationSource : public ModulationSource
             case (s_attack):
             {
                 phase += storage->envelope_rate_linear_nowrap(lc[a].f) *
-                         (adsr->a.temposync ? storage->temposyncratio : 1.f);
+                         (adsr->a.temposync ? storage->temposyncratio : 1.f) * frac;
                 if (phase >= 1)
                 {
                     phase = 1;
@@ -300,7 +313,7 @@ class ADSRModulationSource : public ModulationSource
                 phase = sustain;
                 }*/
                 float rate = storage->envelope_rate_linear_nowrap(lc[d].f) *
-                             (adsr->d.temposync ? storage->temposyncratio : 1.f);
+                             (adsr->d.temposync ? storage->temposyncratio : 1.f) * frac;
 
                 float l_lo, l_hi;
 
@@ -351,7 +364,7 @@ class ADSRModulationSource : public ModulationSource
             case (s_release):
             {
                 phase -= storage->envelope_rate_linear_nowrap(lc[r].f) *
-                         (adsr->r.temposync ? storage->temposyncratio : 1.f);
+                         (adsr->r.temposync ? storage->temposyncratio : 1.f) * frac;
                 output = phase;
                 for (int i = 0; i < lc[r_s].i; i++)
                     output *= phase;
@@ -366,7 +379,7 @@ class ADSRModulationSource : public ModulationSource
             break;
             case (s_uberrelease):
             {
-                phase -= storage->envelope_rate_linear_nowrap(-6.5);
+                phase -= storage->envelope_rate_linear_nowrap(-6.5) * frac;
                 output = phase;
                 for (int i = 0; i < lc[r_s].i; i++)
                     output *= phase;
@@ -387,7 +400,7 @@ class ADSRModulationSource : public ModulationSource
         }
     }
 
-    void doCorrectAnalogMode()
+    void doCorrectAnalogMode(float frac = 1.f)
     {
         const float coeff_offset = 2.f - log(storage->samplerate / BLOCK_SIZE) / log(2.f);
 
@@ -429,6 +442,10 @@ class ADSRModulationSource : public ModulationSource
         // float diff_v_d = std::min( 0.f, v_decay   - v_c1 );
         float diff_v_r = std::min(0.f, v_release - corr_v_c1);
 
+        coef_A *= frac;
+        coef_D *= frac;
+        coef_R *= frac;
+
         corr_v_c1 = corr_v_c1 + diff_v_a * coef_A;
         corr_v_c1 = corr_v_c1 + diff_v_d * coef_D;
         corr_v_c1 = corr_v_c1 + diff_v_r * coef_R;
@@ -451,6 +468,7 @@ class ADSRModulationSource : public ModulationSource
     int envstate = 0;
     pdata *lc = nullptr;
     int a = 0, d = 0, s = 0, r = 0, a_s = 0, d_s = 0, r_s = 0, mode = 0;
+    float blockFraction{1.f};
 
     float _v_c1 = 0.f;
     float _v_c1_delayed = 0.f;
@@ -32,6 +32,96 @@ namespace Surge
 {
 namespace Formula
 {
+namespace
+{
+/*
+ * The state fields valueAt writes and reads. Each lua state holds their names in a table
+ * at these indices, so pushing a key is an array read rather than hashing the name again.
+ */
+enum StateKey
+{
+    sk_intphase = 1,
+    sk_phase,
+    sk_delay,
+    sk_decay,
+    sk_attack,
+    sk_hold,
+    sk_sustain,
+    sk_release,
+    sk_rate,
+    sk_amplitude,
+    sk_startphase,
+    sk_deform,
+    sk_tempo,
+    sk_songpos,
+    sk_released,
+    sk_is_voice,
+    sk_key,
+    sk_velocity,
+    sk_channel,
+    sk_retrigger_AEG,
+    sk_retrigger_FEG,
+    sk_macros,
+    sk_output,
+    sk_use_envelope,
+    sk_clamp_output,
+
+    n_state_keys
+};
+
+const char *stateKeyNames[n_state_keys] = {"",
+                                           "intphase",
+                                           "phase",
+                                           "delay",
+                                           "decay",
+                                           "attack",
+                                           "hold",
+                                           "sustain",
+                                           "release",
+                                           "rate",
+                                           "amplitude",
+                                           "startphase",
+                                           "deform",
+                                           "tempo",
+                                           "songpos",
+                                           "released",
+                                           "is_voice",
+                                           "key",
+                                           "velocity",
+                                           "channel",
+                                           "retrigger_AEG",
+                                           "retrigger_FEG",
+                                           "macros",
+                                           "output",
+                                           "use_envelope",
+                                           "clamp_output"};
+
+#if HAS_LUA
+int createStateKeys(lua_State *L)
+{
+    lua_createtable(L, n_state_keys, 0);
+    for (int i = 1; i < n_state_keys; ++i)
+    {
+        lua_pushstring(L, stateKeyNames[i]);
+        lua_rawseti(L, -2, i);
+    }
+    return luaL_ref(L, LUA_REGISTRYINDEX);
+}
+
+void releaseStateRefs(EvaluatorState &s)
+{
+    // the references are only ever set along with L
+    for (auto *r : {&s.funcRef, &s.stateRef})
+    {
+        if (*r != LUA_NOREF)
+        {
+            luaL_unref(s.L, LUA_REGISTRYINDEX, *r);
+            *r = LUA_NOREF;
+        }
+    }
+}
+#endif
+} // namespace
 
 void setupStorage(SurgeStorage *s) { s->formulaGlobalData = std::make_unique<GlobalData>(); }
 bool prepareForEvaluation(SurgeStorage *storage, FormulaModulatorStorage *fs, EvaluatorState &s,
@@ -39,6 +129,9 @@ bool prepareForEvaluation(SurgeStorage *storage, FormulaModulatorStorage *fs, Ev
 {
     auto &stateData = *storage->formulaGlobalData;
     bool firstTimeThrough = false;
+#if HAS_LUA
+    releaseStateRefs(s);
+#endif
     if (!is_display)
     {
         static int aid = 1;
@@ -93,7 +186,12 @@ end
         {
             lua_setglobal(s.L, "surge_reserved_formula_error_stub");
         }
+
+        (is_display ? stateData.displayKeysRef : stateData.audioKeysRef) =
+            createStateKeys(s.L);
     }
+    s.keysRef = is_display ? stateData.displayKeysRef : stateData.audioKeysRef;
+    s.clearRetriggers = true;
 
     // OK so now evaluate the formula. This is a mistake - the loading and
     // compiling can be expensive so lets look it up by hash first
@@ -352,6 +450,14 @@ end
                 lua_pop(s.L, 1); // the modulator state
             }
         }
+
+        if (s.isvalid)
+        {
+            lua_getglobal(s.L, s.funcName);
+            s.funcRef = luaL_ref(s.L, LUA_REGISTRYINDEX);
+            lua_getglobal(s.L, s.stateName);
+            s.stateRef = luaL_ref(s.L, LUA_REGISTRYINDEX);
+        }
     }
 
     if (is_display)
@@ -430,6 +536,7 @@ void removeFunctionsAssociatedWith(SurgeStorage *storage, FormulaModulatorStorag
 bool cleanEvaluatorState(EvaluatorState &s)
 {
 #if HAS_LUA
+    releaseStateRefs(s);
     if (s.L && s.stateName[0] != 0)
     {
         lua_pushnil(s.L);
@@ -463,114 +570,132 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
     auto gs = Surge::LuaSupport::SGLD("valueAt", s->L);
     struct OnErrorReplaceWithZero
     {
-        OnErrorReplaceWithZero(lua_State *L, std::string fn) : L(L), fn(fn) {}
+        OnErrorReplaceWithZero(lua_State *L, const char *fn) : L(L), fn(fn) {}
         ~OnErrorReplaceWithZero()
         {
             if (replace)
             {
                 // std::cout << "Would nuke " << fn << std::endl;
                 lua_getglobal(L, "surge_reserved_formula_error_stub");
-                lua_setglobal(L, fn.c_str());
+                lua_setglobal(L, fn);
             }
         }
         lua_State *L;
-        std::string fn;
+        const char *fn;
         bool replace = true;
     } onerr(s->L, s->funcName);
     /*
      * So: make the stack my evaluation func then my table; then push my table
-     * values; then call my function; then update my global
+     * values; then call my function; then update my table if it handed back another
      */
-    lua_getglobal(s->L, s->funcName);
+    lua_rawgeti(s->L, LUA_REGISTRYINDEX, s->funcRef);
     if (!lua_isfunction(s->L, -1))
     {
         s->isvalid = false;
         lua_pop(s->L, 1);
         return;
     }
-    lua_getglobal(s->L, s->stateName);
-
-    lua_pushstring(s->L, "av");
-    lua_gettable(s->L, -2);
-    lua_pop(s->L, 1);
+    lua_rawgeti(s->L, LUA_REGISTRYINDEX, s->stateRef);
+    if (!lua_istable(s->L, -1))
+    {
+        s->isvalid = false;
+        lua_pop(s->L, 2);
+        return;
+    }
+    lua_rawgeti(s->L, LUA_REGISTRYINDEX, s->keysRef);
 
-    // Stack is now func > table  so we can update the table
-    lua_pushstring(s->L, "intphase");
-    lua_pushinteger(s->L, phaseIntPart);
-    lua_settable(s->L, -3);
+    // Stack is now func > table > keys so we can update the table
+    auto keys = lua_gettop(s->L);
+    auto table = keys - 1;
 
-    auto addn = [s](const char *q, float f) {
-        lua_pushstring(s->L, q);
+    auto addn = [s, keys, table](StateKey k, double f) {
+        lua_rawgeti(s->L, keys, k);
         lua_pushnumber(s->L, f);
-        lua_settable(s->L, -3);
+        lua_settable(s->L, table);
     };
 
-    auto addb = [s](const char *q, bool b) {
-        lua_pushstring(s->L, q);
+    auto addb = [s, keys, table](StateKey k, bool b) {
+        lua_rawgeti(s->L, keys, k);
         lua_pushboolean(s->L, b);
-        lua_settable(s->L, -3);
+        lua_settable(s->L, table);
     };
 
-    auto addnil = [s](const char *q) {
-        lua_pushstring(s->L, q);
+    auto addnil = [s, keys, table](StateKey k) {
+        lua_rawgeti(s->L, keys, k);
         lua_pushnil(s->L);
-        lua_settable(s->L, -3);
+        lua_settable(s->L, table);
     };
 
-    addn("phase", phaseFracPart);
+    addn(sk_intphase, phaseIntPart);
+    addn(sk_phase, phaseFracPart);
 
     if (s->subLfoEnvelope)
     {
-        addn("delay", s->del);
-        addn("decay", s->dec);
-        addn("attack", s->a);
-        addn("hold", s->h);
-        addn("sustain", s->s);
-        addn("release", s->r);
+        addn(sk_delay, s->del);
+        addn(sk_decay, s->dec);
+        addn(sk_attack, s->a);
+        addn(sk_hold, s->h);
+        addn(sk_sustain, s->s);
+        addn(sk_release, s->r);
     }
     if (s->subLfoParams)
     {
-        addn("rate", s->rate);
-        addn("amplitude", s->amp);
-        addn("startphase", s->phase);
-        addn("deform", s->deform);
+        addn(sk_rate, s->rate);
+        addn(sk_amplitude, s->amp);
+        addn(sk_startphase, s->phase);
+        addn(sk_deform, s->deform);
     }
 
     if (s->subTiming)
     {
-        addn("tempo", s->tempo);
-        addn("songpos", s->songpos);
-        addb("released", s->released);
+        addn(sk_tempo, s->tempo);
+        addn(sk_songpos, s->songpos);
+        addb(sk_released, s->released);
     }
 
     if (s->subVoice && s->isVoice)
     {
-        addb("is_voice", s->isVoice);
-        addn("key", s->key);
-        addn("velocity", s->velocity);
-        addn("channel", s->channel);
+        addb(sk_is_voice, s->isVoice);
+        addn(sk_key, s->key);
+        addn(sk_velocity, s->velocity);
+        addn(sk_channel, s->channel);
     }
 
-    addnil("retrigger_AEG");
-    addnil("retrigger_FEG");
+    // these are requests from the last block, so they only need clearing once they're made
+    if (s->clearRetriggers)
+    {
+        addnil(sk_retrigger_AEG);
+        addnil(sk_retrigger_FEG);
+        s->clearRetriggers = false;
+    }
 
     if (s->subAnyMacro)
     {
         // load the macros
-        lua_pushstring(s->L, "macros");
-        lua_createtable(s->L, n_customcontrollers, 0);
+        lua_rawgeti(s->L, keys, sk_macros);
+        lua_gettable(s->L, table);
+        if (!lua_istable(s->L, -1))
+        {
+            lua_pop(s->L, 1);
+            lua_createtable(s->L, n_customcontrollers, 0);
+            lua_rawgeti(s->L, keys, sk_macros);
+            lua_pushvalue(s->L, -2);
+            lua_settable(s->L, table);
+        }
+
+        // the table is reused, so unsubscribed slots are cleared as a fresh one would be
         for (int i = 0; i < n_customcontrollers; ++i)
         {
             if (s->subMacros[i])
-            {
-                lua_pushinteger(s->L, i + 1);
                 lua_pushnumber(s->L, s->macrovalues[i]);
-                lua_settable(s->L, -3);
-            }
+            else
+                lua_pushnil(s->L);
+            lua_rawseti(s->L, -2, i + 1);
         }
-        lua_settable(s->L, -3);
+        lua_pop(s->L, 1);
     }
 
+    lua_pop(s->L, 1); // the keys, leaving func > table for the call
     auto lres = lua_pcall(s->L, 1, 1, 0);
     // stack is now just the result
     if (lres == LUA_OK)
@@ -591,6 +716,7 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
             auto r = lua_tonumber(s->L, -1);
             lua_pop(s->L, 1);
             output[0] = checkFinite(r);
+            onerr.replace = false;
             return;
         }
         if (!lua_istable(s->L, -1))
@@ -602,12 +728,26 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
             lua_pop(s->L, 1);
             return;
         }
-        // Store the value and keep it on top of the stack
-        lua_setglobal(s->L, s->stateName);
-        lua_getglobal(s->L, s->stateName);
 
-        lua_pushstring(s->L, "output");
-        lua_gettable(s->L, -2);
+        // Store the value if it isn't the table we already hold, and keep it on top of the stack
+        lua_rawgeti(s->L, LUA_REGISTRYINDEX, s->stateRef);
+        auto sameTable = lua_rawequal(s->L, -1, -2);
+        lua_pop(s->L, 1);
+        if (!sameTable)
+        {
+            lua_pushvalue(s->L, -1);
+            lua_setglobal(s->L, s->stateName);
+            lua_pushvalue(s->L, -1);
+            lua_rawseti(s->L, LUA_REGISTRYINDEX, s->stateRef);
+            s->clearRetriggers = true;
+        }
+
+        lua_rawgeti(s->L, LUA_REGISTRYINDEX, s->keysRef);
+        keys = lua_gettop(s->L);
+        table = keys - 1;
+
+        lua_rawgeti(s->L, keys, sk_output);
+        lua_gettable(s->L, table);
         // top of stack is now the result
         float res = 0.0;
         if (lua_isnumber(s->L, -1))
@@ -664,26 +804,30 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
             stateData.knownBadFunctions.insert(s->funcName);
             s->isvalid = false;
         };
-        // pop the result and the function
+        // pop the output
         lua_pop(s->L, 1);
 
-        auto getBoolDefault = [s](const char *n, bool def) -> bool {
+        auto getBoolDefault = [s, keys, table](StateKey k, bool def, bool *isSet = nullptr) {
             auto res = def;
-            lua_pushstring(s->L, n);
-            lua_gettable(s->L, -2);
+            lua_rawgeti(s->L, keys, k);
+            lua_gettable(s->L, table);
             if (lua_isboolean(s->L, -1))
             {
                 res = lua_toboolean(s->L, -1);
             }
+            if (isSet)
+                *isSet = !lua_isnil(s->L, -1);
             lua_pop(s->L, 1);
             return res;
         };
 
-        s->useEnvelope = getBoolDefault("use_envelope", true);
-        s->retrigger_AEG = getBoolDefault("retrigger_AEG", false);
-        s->retrigger_FEG = getBoolDefault("retrigger_FEG", false);
+        bool aegSet, fegSet;
+        s->useEnvelope = getBoolDefault(sk_use_envelope, true);
+        s->retrigger_AEG = getBoolDefault(sk_retrigger_AEG, false, &aegSet);
+        s->retrigger_FEG = getBoolDefault(sk_retrigger_FEG, false, &fegSet);
+        s->clearRetriggers = aegSet || fegSet;
 
-        auto doClamp = getBoolDefault("clamp_output", true);
+        auto doClamp = getBoolDefault(sk_clamp_output, true);
         if (doClamp)
         {
             for (int i = 0; i < 8; ++i)
@@ -692,8 +836,8 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
             }
         }
 
-        // Finally pop the table result
-        lua_pop(s->L, 1);
+        // Finally pop the keys and the table result
+        lua_pop(s->L, 2);
         onerr.replace = false;
         return;
     }
@@ -40,6 +40,8 @@ struct GlobalData
     std::unordered_set<std::string> knownBadFunctions; // these are functions which cause an error
     std::unordered_map<FormulaModulatorStorage *, std::unordered_set<std::string>> functionsPerFMS;
     void *audioState{nullptr}, *displayState{nullptr};
+    // registry references to each lua state's table of interned state keys
+    int audioKeysRef{-2}, displayKeysRef{-2};
 };
 
 static constexpr int max_formula_outputs{max_lfo_indices};
@@ -82,6 +84,16 @@ struct EvaluatorState
     int activeoutputs;
 
     lua_State *L; // This is assigned by prepareForEvaluation to be one per thread
+
+    /*
+     * valueAt runs per voice per block, so it reaches the process function, the state table
+     * and the names of the state fields through registry references rather than looking
+     * strings up. Every subscribed input is still written on every call, so a script which
+     * assigns to an input field gets the real value back next block. The references are
+     * LUA_NOREF (-2) until prepareForEvaluation sets them.
+     */
+    int funcRef{-2}, stateRef{-2}, keysRef{-2};
+    bool clearRetriggers{true};
 };
 
 void setupStorage(SurgeStorage *s);
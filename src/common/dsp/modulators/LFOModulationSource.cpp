@@ -535,7 +535,7 @@ void LFOModulationSource::retriggerEnvelopeFrom(float start)
     }
 }
 
-void LFOModulationSource::process_block()
+float LFOModulationSource::advancePhaseAndEnvelope()
 {
     if ((!phaseInitialized) || (lfo->trigmode.val.i == lm_keytrigger && lfo->rate.deactivated))
     {
@@ -814,6 +814,14 @@ void LFOModulationSource::process_block()
         };
     }
 
+    return frate;
+}
+
+void LFOModulationSource::process_block()
+{
+    auto frate = advancePhaseAndEnvelope();
+    int s = lfo->shape.val.i;
+
     float useenvval = env_val;
 
     if (lfo->delay.deactivated)
@@ -100,7 +100,12 @@ class LFOModulationSource : public ModulationSource
 
     bool everAttacked{false};
 
+    // set by the scene's VoiceLFOBank when it has already run this block for the voice
+    bool processedByBank{false};
+
   private:
+    friend class VoiceLFOBank;
+
     LFOStorage *lfo;
     SurgeVoiceState *state;
     SurgeStorage *storage;
@@ -127,6 +132,8 @@ class LFOModulationSource : public ModulationSource
     bool phaseInitialized;
     void initPhaseFromStartPhase();
     void msegEnvelopePhaseAdjustment();
+    // the start of process_block: moves the phase and envelope on a block and returns the rate
+    float advancePhaseAndEnvelope();
 
     float phase, target, noise, noised1, env_phase, priorPhase;
     int unwrappedphase_intpart;
@@ -21,6 +21,7 @@
  */
 
 #include "MSEGModulationHelper.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include "DebugHelpers.h"
@@ -32,6 +33,140 @@ namespace Surge
 namespace MSEG
 {
 
+namespace
+{
+static_assert(max_msegs <= 256, "MSEGStorage::timeIndex holds segment indices in a byte");
+
+/*
+ * Alright so we have a functional form (e^ax-1)/(e^a-1) = y;
+ * We also know that since we have vertical only motion here x = 1/2 and y is where we want
+ * to hit ( specifically since we are generating a 0,1 line and cpv is -1,1 then
+ * here we get y = 0.5 * cpv + 0.5.
+ *
+ * Fine so lets show our work. I'm going to use X and V for now
+ *
+ * (e^aX-1)/(e^a-1) = V  @ x=1/2
+ * introduce Q = e^a/2
+ * (Q - 1) / ( Q^2 - 1 ) = V
+ * Q - 1 = V Q^2 - V
+ * V Q^2 - Q + ( 1-V ) = 0
+ *
+ * OK cool we know how to solve that (for V != 0)
+ *
+ * Q = (1 +/- sqrt( 1 - 4 * V * (1-V) )) / 2 V
+ *
+ * and since Q = e^a/2
+ *
+ * a = 2 * log(Q)
+ *
+ */
+float controlPointExponent(float cpv)
+{
+    float V = 0.5 * cpv + 0.5;
+    float amul = 1;
+
+    if (V < 0.5)
+    {
+        amul = -1;
+        V = 1 - V;
+    }
+
+    float disc = (1 - 4 * V * (1 - V));
+    float a = 0;
+
+    if (fabs(V) > 1e-3)
+    {
+        float Q = limit_range((1 - sqrt(disc)) / (2 * V), 0.00001f, 1000000.f);
+        a = amul * 2 * log(Q);
+    }
+
+    return a;
+}
+
+// How many oscillations the sine, sawtooth, triangle and square segments make in between
+int waveformSteps(float cpv)
+{
+    float pct = (cpv + 1) * 0.5;
+    float as = 5.0;
+    float scaledpct = (exp(as * pct) - 1) / (exp(as) - 1);
+    return (int)(scaledpct * 100);
+}
+
+// The stairs work this out in double rather than float, so it can be a step off the above
+int stairSteps(float cpv)
+{
+    auto pct = (cpv + 1) * 0.5;
+    auto as = 5.0;
+    auto scaledpct = (exp(as * pct) - 1) / (exp(as) - 1);
+    return (int)(scaledpct * 100) + 2;
+}
+
+void rebuildTimeIndex(MSEGStorage *ms)
+{
+    ms->timeIndex.fill(0);
+    ms->timeIndexScale = 0;
+
+    auto n = ms->n_activeSegments;
+
+    if (n <= 0 || ms->totalDuration <= MSEGStorage::minimumDuration)
+    {
+        return;
+    }
+
+    // firstSegmentReaching relies on the ends never going backwards; if they do, scan it all
+    for (int i = 1; i < n; ++i)
+    {
+        if (ms->segmentEnd[i] < ms->segmentEnd[i - 1])
+        {
+            return;
+        }
+    }
+
+    ms->timeIndexScale = MSEGStorage::timeIndexSize / ms->totalDuration;
+
+    int seg = 0;
+
+    for (int c = 0; c < MSEGStorage::timeIndexSize; ++c)
+    {
+        double cellStart = c / (double)ms->timeIndexScale;
+
+        while (seg < n - 1 && ms->segmentEnd[seg] < cellStart)
+        {
+            seg++;
+        }
+
+        ms->timeIndex[c] = seg;
+    }
+}
+
+/*
+ * The first segment which can hold t, since every segment before it ends before t. So a scan
+ * for the segment holding t can start here rather than at 0 and still find the same one. The
+ * time index lands within a cell of it, and the walk back covers t rounding into the next.
+ */
+int firstSegmentReaching(const MSEGStorage *ms, double t)
+{
+    if (!(t > 0))
+    {
+        return 0;
+    }
+
+    double x = t * ms->timeIndexScale;
+    int i = ms->timeIndex[x < MSEGStorage::timeIndexSize - 1 ? (int)x
+                                                             : MSEGStorage::timeIndexSize - 1];
+
+    // segments can be removed before the next rebuildCache
+    i = std::min(i, std::max(ms->n_activeSegments - 1, 0));
+
+    while (i > 0 && ms->segmentEnd[i - 1] >= t)
+    {
+        i--;
+    }
+
+    return i;
+}
+} // namespace
+
 void rebuildCache(MSEGStorage *ms)
 {
     forceToConstrainedNormalForm(ms);
@@ -98,8 +233,16 @@ void rebuildCache(MSEGStorage *ms)
     for (int i = 0; i < ms->n_activeSegments; ++i)
     {
         constrainControlPointAt(ms, i);
+
+        auto cpv = ms->segments[i].cpv;
+        ms->segmentCurveCpv[i] = cpv;
+        ms->segmentCurveExponent[i] = controlPointExponent(cpv);
+        ms->segmentWaveSteps[i] = waveformSteps(cpv);
+        ms->segmentStairSteps[i] = stairSteps(cpv);
     }
 
+    rebuildTimeIndex(ms);
+
     ms->durationToLoopEnd = ms->totalDuration;
     ms->durationLoopStartToLoopEnd = ms->totalDuration;
 
@@ -184,7 +327,8 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
             // so now find the index
             idx = -1;
 
-            for (int ai = 0; ai < ms->n_activeSegments && idx < 0; ai++)
+            for (int ai = firstSegmentReaching(ms, adjustedPhase);
+                 ai < ms->n_activeSegments && idx < 0; ai++)
             {
                 if (ms->segmentStart[ai] <= adjustedPhase && ms->segmentEnd[ai] > adjustedPhase)
                 {
@@ -212,6 +356,9 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
     auto r = ms->segments[idx];
     bool segInit = false;
 
+    // the control point can move between rebuildCache calls, so only trust terms made for it
+    bool curveCached = (r.cpv == ms->segmentCurveCpv[idx]);
+
     if (idx != es->lastEval || es->has_triggered)
     {
         segInit = true;
@@ -324,50 +471,8 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
             }
         }
 
-        // So we want to handle control points
-        auto cpd = r.cpv;
-
-        /*
-         * Alright so we have a functional form (e^ax-1)/(e^a-1) = y;
-         * We also know that since we have vertical only motion here x = 1/2 and y is where we want
-         * to hit ( specifically since we are generating a 0,1 line and cpv is -1,1 then
-         * here we get y = 0.5 * cpv + 0.5.
-         *
-         * Fine so lets show our work. I'm going to use X and V for now
-         *
-         * (e^aX-1)/(e^a-1) = V  @ x=1/2
-         * introduce Q = e^a/2
-         * (Q - 1) / ( Q^2 - 1 ) = V
-         * Q - 1 = V Q^2 - V
-         * V Q^2 - Q + ( 1-V ) = 0
-         *
-         * OK cool we know how to solve that (for V != 0)
-         *
-         * Q = (1 +/- sqrt( 1 - 4 * V * (1-V) )) / 2 V
-         *
-         * and since Q = e^a/2
-         *
-         * a = 2 * log(Q)
-         *
-         */
-
-        float V = 0.5 * r.cpv + 0.5;
-        float amul = 1;
-
-        if (V < 0.5)
-        {
-            amul = -1;
-            V = 1 - V;
-        }
-
-        float disc = (1 - 4 * V * (1 - V));
-        float a = 0;
-
-        if (fabs(V) > 1e-3)
-        {
-            float Q = limit_range((1 - sqrt(disc)) / (2 * V), 0.00001f, 1000000.f);
-            a = amul * 2 * log(Q);
-        }
+        // the exponent which puts the curve through the control point
+        float a = curveCached ? ms->segmentCurveExponent[idx] : controlPointExponent(r.cpv);
 
         // OK so frac is the 0,1 line point
         auto cpline = frac;
@@ -504,10 +609,7 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
     case MSEGStorage::segment::TRIANGLE:
     case MSEGStorage::segment::SQUARE:
     {
-        float pct = (r.cpv + 1) * 0.5;
-        float as = 5.0;
-        float scaledpct = (exp(as * pct) - 1) / (exp(as) - 1);
-        int steps = (int)(scaledpct * 100);
+        int steps = curveCached ? ms->segmentWaveSteps[idx] : waveformSteps(r.cpv);
         auto frac = timeAlongSegment / r.duration;
         float kernel = 0;
 
@@ -577,10 +679,7 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
 
     case MSEGStorage::segment::STAIRS:
     {
-        auto pct = (r.cpv + 1) * 0.5;
-        auto as = 5.0;
-        auto scaledpct = (exp(as * pct) - 1) / (exp(as) - 1);
-        auto steps = (int)(scaledpct * 100) + 2;
+        auto steps = curveCached ? ms->segmentStairSteps[idx] : stairSteps(r.cpv);
         auto frac = (float)((int)(steps * timeAlongSegment / r.duration)) / (steps - 1);
 
         if (df < 0)
@@ -598,10 +697,7 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
     }
     case MSEGStorage::segment::SMOOTH_STAIRS:
     {
-        auto pct = (r.cpv + 1) * 0.5;
-        auto as = 5.0;
-        auto scaledpct = (exp(as * pct) - 1) / (exp(as) - 1);
-        auto steps = (int)(scaledpct * 100) + 2;
+        auto steps = curveCached ? ms->segmentStairSteps[idx] : stairSteps(r.cpv);
         auto frac = timeAlongSegment / r.duration;
 
         auto c = df < 0.f ? 1.0 + df * 0.7 : 1.0 + df * 3.0;
@@ -751,7 +847,7 @@ int timeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &amountAlon
 
         int idx = -1;
 
-        for (int i = 0; i < ms->n_activeSegments; ++i)
+        for (int i = firstSegmentReaching(ms, t); i < ms->n_activeSegments; ++i)
         {
             if (t >= ms->segmentStart[i] && t < ms->segmentEnd[i])
             {
@@ -773,7 +869,7 @@ int timeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &amountAlon
         // So are we before the first loop end point
         if (t <= ms->durationToLoopEnd)
         {
-            for (int i = 0; i < ms->n_activeSegments; ++i)
+            for (int i = firstSegmentReaching(ms, t); i < ms->n_activeSegments; ++i)
                 if (t >= ms->segmentStart[i] && t <= ms->segmentEnd[i])
                 {
                     amountAlongSegment = t - ms->segmentStart[i];
@@ -807,7 +903,7 @@ int timeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &amountAlon
             // and we need to offset it by the starting point
             nt += ms->segmentStart[ls];
 
-            for (int i = 0; i < ms->n_activeSegments; ++i)
+            for (int i = firstSegmentReaching(ms, nt); i < ms->n_activeSegments; ++i)
                 if (nt >= ms->segmentStart[i] && nt <= ms->segmentEnd[i])
                 {
                     amountAlongSegment = nt - ms->segmentStart[i];
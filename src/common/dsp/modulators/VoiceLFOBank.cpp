@@ -0,0 +1,181 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "VoiceLFOBank.h"
+#include "SurgeVoice.h"
+
+namespace
+{
+// LFOModulationSource::bend1, twice over x - a * x * x + a
+inline __m128 bend1(__m128 x, __m128 a)
+{
+    x = _mm_add_ps(_mm_sub_ps(x, _mm_mul_ps(_mm_mul_ps(a, x), x)), a);
+    x = _mm_add_ps(_mm_sub_ps(x, _mm_mul_ps(_mm_mul_ps(a, x), x)), a);
+    return x;
+}
+
+// SurgeStorage::lookup_waveshape_warp, with the table reads done a lane at a time
+inline __m128 lookupSineWarp(__m128 x)
+{
+    const auto &table =
+        sst::waveshapers::globalWaveshaperTables
+            .waveshapers[(int)sst::waveshapers::WaveshaperType::wst_sine];
+
+    x = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(256.f)), _mm_set1_ps(512.f));
+    auto e = _mm_cvttps_epi32(x);
+    auto a = _mm_sub_ps(x, _mm_cvtepi32_ps(e));
+
+    int ei alignas(16)[4];
+    float t0 alignas(16)[4], t1 alignas(16)[4];
+    _mm_store_si128((__m128i *)ei, e);
+    for (int i = 0; i < 4; ++i)
+    {
+        t0[i] = table[ei[i] & 0x3ff];
+        t1[i] = table[(ei[i] + 1) & 0x3ff];
+    }
+
+    return _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.f), a), _mm_load_ps(t0)),
+                      _mm_mul_ps(a, _mm_load_ps(t1)));
+}
+} // namespace
+
+bool VoiceLFOBank::canBatch(const LFOStorage &lfo)
+{
+    switch (lfo.shape.val.i)
+    {
+    case lt_square:
+        return true;
+    case lt_sine:
+    case lt_tri:
+    case lt_ramp:
+        return lfo.deform.deform_type == type_1;
+    }
+    return false;
+}
+
+void VoiceLFOBank::process(SurgeSceneStorage &scene, SurgeVoice *const *voices, int count)
+{
+    LFOModulationSource *sources[MAX_VOICES];
+
+    for (int s = 0; s < n_lfos_voice; ++s)
+    {
+        // LFO 1 always runs, so that its gate retriggers work
+        if (!canBatch(scene.lfo[s]) || (s != 0 && !scene.modsource_doprocess[ms_lfo1 + s]))
+            continue;
+
+        for (int v = 0; v < count; ++v)
+            sources[v] = &voices[v]->lfo[s];
+
+        processSlot(scene.lfo[s], sources, count);
+    }
+}
+
+void VoiceLFOBank::processSlot(LFOStorage &lfo, LFOModulationSource *const *sources, int count)
+{
+    int n = 0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        auto *l = sources[i];
+
+        if (l->envRetrigMode != LFOModulationSource::FROM_ZERO)
+            continue;
+
+        l->advancePhaseAndEnvelope();
+        l->processedByBank = true;
+
+        lanes[n] = l;
+        phase[n] = l->phase;
+        env[n] = lfo.delay.deactivated ? 1.f : l->env_val;
+        deform[n] = l->localcopy[l->ideform].f;
+        magnf[n] = limit_range(lfo.magnitude.get_extended(l->localcopy[l->magn].f), -3.f, 3.f);
+        n++;
+    }
+
+    if (n == 0)
+        return;
+
+    auto nQuads = (n + 3) >> 2;
+    for (int i = n; i < nQuads << 2; ++i)
+    {
+        phase[i] = 0.f;
+        env[i] = 0.f;
+        deform[i] = 0.f;
+        magnf[i] = 0.f;
+    }
+
+    const auto shape = lfo.shape.val.i;
+    const auto unipolar = lfo.unipolar.val.b;
+    const auto scaled = lfo.lfoExtraAmplitude == LFOStorage::SCALED;
+
+    const auto one = _mm_set1_ps(1.f), half = _mm_set1_ps(0.5f);
+
+    for (int q = 0; q < nQuads << 2; q += 4)
+    {
+        auto p = _mm_load_ps(phase + q);
+        auto df = _mm_load_ps(deform + q);
+        auto a = _mm_mul_ps(half, _mm_min_ps(_mm_max_ps(df, _mm_set1_ps(-3.f)), _mm_set1_ps(3.f)));
+        __m128 io;
+
+        switch (shape)
+        {
+        case lt_sine:
+            io = bend1(lookupSineWarp(_mm_sub_ps(_mm_set1_ps(2.f), _mm_mul_ps(_mm_set1_ps(4.f), p))),
+                       a);
+            break;
+        case lt_tri:
+        {
+            auto over = _mm_cmpgt_ps(p, half);
+            auto folded = _mm_or_ps(_mm_and_ps(over, _mm_sub_ps(one, p)), _mm_andnot_ps(over, p));
+            io = bend1(_mm_add_ps(_mm_set1_ps(-1.f), _mm_mul_ps(_mm_set1_ps(4.f), folded)), a);
+        }
+        break;
+        case lt_ramp:
+            io = bend1(_mm_sub_ps(one, _mm_mul_ps(_mm_set1_ps(2.f), p)), a);
+            break;
+        default: // lt_square
+        {
+            auto low = _mm_cmpgt_ps(p, _mm_add_ps(half, _mm_mul_ps(half, df)));
+            io = _mm_or_ps(_mm_and_ps(low, _mm_set1_ps(-1.f)), _mm_andnot_ps(low, one));
+        }
+        break;
+        }
+
+        if (unipolar)
+            io = _mm_add_ps(half, _mm_mul_ps(half, io));
+
+        auto e = _mm_load_ps(env + q);
+        auto m = _mm_load_ps(magnf + q);
+
+        _mm_store_ps(out0 + q, _mm_mul_ps(_mm_mul_ps(e, m), io));
+        _mm_store_ps(out1 + q, scaled ? _mm_mul_ps(io, m) : io);
+        _mm_store_ps(out2 + q, scaled ? _mm_mul_ps(e, m) : e);
+    }
+
+    for (int i = 0; i < n; ++i)
+    {
+        auto *l = lanes[i];
+        l->output_multi[0] = out0[i];
+        l->output_multi[1] = out1[i];
+        l->output_multi[2] = out2[i];
+    }
+}
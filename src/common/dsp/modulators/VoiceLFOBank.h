@@ -0,0 +1,64 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_MODULATORS_VOICELFOBANK_H
+#define SURGE_SRC_COMMON_DSP_MODULATORS_VOICELFOBANK_H
+
+#include "LFOModulationSource.h"
+
+class SurgeVoice;
+
+/*
+ * Runs each voice LFO slot of a scene for all of the scene's voices at once, rather than
+ * having every voice call its own process_block with the shape switch inside.
+ *
+ * The phase and the envelope still move on lane by lane, through the same code the scalar
+ * path runs, since each is a short branchy state machine over table lookups. The waveform and
+ * output scaling are done four voices to an SSE register, in the same float operations in the
+ * same order as LFOModulationSource, so the results match it exactly.
+ *
+ * Only the shapes which are plain float arithmetic of the phase are banked. Noise, S&H, the
+ * step sequencer, MSEG and formula carry state of their own, and the type 2 and 3 deforms
+ * are computed in double. All of those, and any LFO retriggering from its last value, stay
+ * on the scalar path.
+ */
+class VoiceLFOBank
+{
+  public:
+    static bool canBatch(const LFOStorage &lfo);
+
+    // Runs every slot it can and flags those LFOs, so calc_ctrldata skips them this block
+    void process(SurgeSceneStorage &scene, SurgeVoice *const *voices, int count);
+
+    // Runs the count sources, which must all be assigned to lfo, if canBatch(lfo)
+    void processSlot(LFOStorage &lfo, LFOModulationSource *const *sources, int count);
+
+  private:
+    static constexpr int maxLanes = (MAX_VOICES + 3) & ~3;
+
+    LFOModulationSource *lanes[maxLanes];
+    float phase alignas(16)[maxLanes], env alignas(16)[maxLanes];
+    float deform alignas(16)[maxLanes], magnf alignas(16)[maxLanes];
+    float out0 alignas(16)[maxLanes], out1 alignas(16)[maxLanes], out2 alignas(16)[maxLanes];
+};
+
+#endif // SURGE_SRC_COMMON_DSP_MODULATORS_VOICELFOBANK_H
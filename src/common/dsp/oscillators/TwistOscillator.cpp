@@ -22,6 +22,7 @@
 
 #include "TwistOscillator.h"
 #include "DebugHelpers.h"
+#include "SurgeMemoryPools.h"
 
 #define TEST
 #ifndef _MSC_VER
@@ -275,16 +276,10 @@ static struct EngineDynamicDeact : public ParameterDynamicDeactivationFunction
     }
 } etDynamicDeact;
 
-TwistOscillator::TwistOscillator(SurgeStorage *storage, OscillatorStorage *oscdata,
-                                 pdata *localcopy)
-    : Oscillator(storage, oscdata, localcopy), charFilt(storage)
+TwistEngineState::TwistEngineState()
 {
-#if SAMPLERATE_LANCZOS
-    lancRes = std::make_unique<sst::basic_blocks::dsp::LanczosResampler<BLOCK_SIZE>>(
-        48000, storage->dsamplerate_os);
-    srcstate = nullptr;
-#else
     int error;
+#if !SAMPLERATE_LANCZOS
     srcstate = src_new(SRC_SINC_FASTEST, 2, &error);
     // srcstate = src_new(SRC_LINEAR, 2, &error);
     if (error != 0)
@@ -293,13 +288,12 @@ TwistOscillator::TwistOscillator(SurgeStorage *storage, OscillatorStorage *oscda
     }
 #endif
     voice = std::make_unique<plaits::Voice>();
-    shared_buffer = new char[16384];
-    alloc = std::make_unique<stmlib::BufferAllocator>(shared_buffer, 16384);
+    shared_buffer = std::make_unique<char[]>(sharedBufferSize);
+    alloc = std::make_unique<stmlib::BufferAllocator>(shared_buffer.get(), sharedBufferSize);
     patch = std::make_unique<plaits::Patch>();
     mod = std::make_unique<plaits::Modulations>();
 
     // FM downsampling with a linear interpolator is absolutely fine
-    int error;
     fmdownsamplestate = src_new(SRC_LINEAR, 1, &error);
     if (error != 0)
     {
@@ -307,6 +301,22 @@ TwistOscillator::TwistOscillator(SurgeStorage *storage, OscillatorStorage *oscda
     }
 }
 
+TwistEngineState::~TwistEngineState()
+{
+    if (srcstate)
+        srcstate = src_delete(srcstate);
+
+    if (fmdownsamplestate)
+        fmdownsamplestate = src_delete(fmdownsamplestate);
+}
+
+TwistOscillator::TwistOscillator(SurgeStorage *storage, OscillatorStorage *oscdata,
+                                 pdata *localcopy)
+    : Oscillator(storage, oscdata, localcopy), charFilt(storage)
+{
+    // the engine comes at init(), as this is also built just to set up parameters
+}
+
 float TwistOscillator::tuningAwarePitch(float pitch)
 {
     if (storage->tuningApplicationMode == SurgeStorage::RETUNE_ALL &&
@@ -324,13 +334,40 @@ float TwistOscillator::tuningAwarePitch(float pitch)
 
 void TwistOscillator::init(float pitch, bool is_display, bool nonzero_drift)
 {
-    voice->Init(alloc.get());
+    if (!engine)
+    {
+        // the display renders on the UI thread, so can't share the audio thread's pool
+        ownEngine = is_display;
+        if (ownEngine)
+            engine = new TwistEngineState();
+        else
+            engine = storage->memoryPools->twistEngines.getItem();
+    }
+
+    voice = engine->voice.get();
+    patch = engine->patch.get();
+    mod = engine->mod.get();
+    srcstate = engine->srcstate;
+    fmdownsamplestate = engine->fmdownsamplestate;
+
+    // a pooled engine carries the last note's state, so start everything over
+    engine->alloc->Init(engine->shared_buffer.get(), TwistEngineState::sharedBufferSize);
+    if (srcstate)
+        src_reset(srcstate);
+    if (fmdownsamplestate)
+        src_reset(fmdownsamplestate);
+#if SAMPLERATE_LANCZOS
+    engine->lancRes.emplace(48000, storage->dsamplerate_os);
+    lancRes = &(*engine->lancRes);
+#endif
+
+    voice->Init(engine->alloc.get());
 
     charFilt.init(storage->getPatch().character.val.i);
 
     float tpitch = tuningAwarePitch(pitch);
-    memset((void *)patch.get(), 0, sizeof(plaits::Patch));
-    memset((void *)mod.get(), 0, sizeof(plaits::Modulations));
+    memset((void *)patch, 0, sizeof(plaits::Patch));
+    memset((void *)mod, 0, sizeof(plaits::Modulations));
 
     driftLFO.init(nonzero_drift);
 
@@ -354,14 +391,13 @@ void TwistOscillator::init(float pitch, bool is_display, bool nonzero_drift)
 }
 TwistOscillator::~TwistOscillator()
 {
-    if (shared_buffer)
-        delete[] shared_buffer;
-
-    if (srcstate)
-        srcstate = src_delete(srcstate);
+    if (!engine)
+        return;
 
-    if (fmdownsamplestate)
-        fmdownsamplestate = src_delete(fmdownsamplestate);
+    if (ownEngine)
+        delete engine;
+    else
+        storage->memoryPools->twistEngines.returnItem(engine);
 }
 
 template <bool FM, bool throwaway>
@@ -20,6 +20,9 @@
  * https://github.com/surge-synthesizer/surge
  */
 
+#ifndef SURGE_SRC_COMMON_DSP_OSCILLATORS_TWISTOSCILLATOR_H
+#define SURGE_SRC_COMMON_DSP_OSCILLATORS_TWISTOSCILLATOR_H
+
 /*
  * What's our samplerate strategy
  */
@@ -29,6 +32,7 @@
 
 #include "OscillatorBase.h"
 #include <memory>
+#include <optional>
 #include "basic_dsp.h"
 #include "DSPUtils.h"
 #include "OscillatorCommonFunctions.h"
@@ -52,6 +56,33 @@ class BufferAllocator;
 
 struct SRC_STATE_tag;
 
+/*
+ * Everything a Twist voice needs which is either too big for the oscillator buffer or takes
+ * an allocation to make. Live voices take these from storage->memoryPools, so a note on
+ * allocates nothing; TwistOscillator::init resets the one it gets rather than building it.
+ */
+struct TwistEngineState
+{
+    TwistEngineState();
+    ~TwistEngineState();
+
+    std::unique_ptr<plaits::Voice> voice;
+    std::unique_ptr<plaits::Patch> patch;
+    std::unique_ptr<plaits::Modulations> mod;
+    std::unique_ptr<stmlib::BufferAllocator> alloc;
+    std::unique_ptr<char[]> shared_buffer;
+
+    // Keep this here for now even if using lanczos since I'm using SRC for FM still
+    SRC_STATE_tag *srcstate{nullptr}, *fmdownsamplestate{nullptr};
+
+#if SAMPLERATE_LANCZOS
+    // rebuilt in place at each note on, since the rate it converts to can have changed
+    std::optional<sst::basic_blocks::dsp::LanczosResampler<BLOCK_SIZE>> lancRes;
+#endif
+
+    static constexpr int sharedBufferSize = 16384;
+};
+
 class TwistOscillator : public Oscillator
 {
   public:
@@ -88,21 +119,21 @@ class TwistOscillator : public Oscillator
         return clamp01((localcopy[oscdata->p[ps].param_id_in_scene].f + 1) * 0.5f);
     }
 
-    std::unique_ptr<plaits::Voice> voice;
-    std::unique_ptr<plaits::Patch> patch;
-    std::unique_ptr<plaits::Modulations> mod;
-    std::unique_ptr<stmlib::BufferAllocator> alloc;
-    char *shared_buffer{nullptr};
+    // engine is pooled, except for display oscillators which own theirs; the rest point into it
+    TwistEngineState *engine{nullptr};
+    bool ownEngine{false};
+    plaits::Voice *voice{nullptr};
+    plaits::Patch *patch{nullptr};
+    plaits::Modulations *mod{nullptr};
+    SRC_STATE_tag *srcstate{nullptr}, *fmdownsamplestate{nullptr};
 
-    // Keep this here for now even if using lanczos since I'm using SRC for FM still
-    SRC_STATE_tag *srcstate, *fmdownsamplestate;
     float fmlagbuffer[BLOCK_SIZE_OS << 1];
     int fmwp, fmrp;
 
     bool useCorrectLPGBlockSize{false}; // See #6760
 
 #if SAMPLERATE_LANCZOS
-    std::unique_ptr<sst::basic_blocks::dsp::LanczosResampler<BLOCK_SIZE>> lancRes;
+    sst::basic_blocks::dsp::LanczosResampler<BLOCK_SIZE> *lancRes{nullptr};
 #endif
 
     float carryover[BLOCK_SIZE_OS][2];
@@ -113,3 +144,5 @@ class TwistOscillator : public Oscillator
     Surge::Oscillator::DriftLFO driftLFO;
     Surge::Oscillator::CharacterFilter<float> charFilt;
 };
+
+#endif // SURGE_SRC_COMMON_DSP_OSCILLATORS_TWISTOSCILLATOR_H
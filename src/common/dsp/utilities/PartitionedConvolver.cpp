@@ -0,0 +1,210 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "PartitionedConvolver.h"
+#include "pffft.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Surge
+{
+namespace DSP
+{
+namespace
+{
+// pffft's smallest real transform is 32 points, so 16 sample partitions
+constexpr int minPartition = 16;
+constexpr int midPartition = 1024;
+constexpr int tailPartition = 8192;
+
+int nextPow2(int n)
+{
+    int r = 1;
+    while (r < n)
+        r *= 2;
+    return r;
+}
+
+float *allocBuffer(int n)
+{
+    auto r = (float *)pffft_aligned_malloc(n * sizeof(float));
+    memset(r, 0, n * sizeof(float));
+    return r;
+}
+} // namespace
+
+PartitionedConvolver::PartitionedConvolver(const float *ir, int irLength, int blockSize)
+    : blockSize(blockSize), irLen(std::max(irLength, 1))
+{
+    auto head = nextPow2(std::max(blockSize, minPartition));
+    auto mid = std::max(midPartition, head);
+    auto tail = std::max(tailPartition, 8 * mid);
+    latencySamples = head - blockSize;
+
+    stages.reserve(3);
+    stages.emplace_back();
+    buildStage(stages.back(), ir, irLength, head, 0, std::min(irLen, mid));
+    if (irLen > mid)
+    {
+        stages.emplace_back();
+        buildStage(stages.back(), ir, irLength, mid, mid, std::min(irLen, tail) - mid);
+    }
+    if (irLen > tail)
+    {
+        stages.emplace_back();
+        buildStage(stages.back(), ir, irLength, tail, tail, irLen - tail);
+    }
+
+    // a stage writes up to its offset plus a period ahead of the block being read
+    auto &last = stages.back();
+    auto ringSize = nextPow2(2 * (last.offset + last.size + head));
+    output = allocBuffer(ringSize);
+    outMask = ringSize - 1;
+}
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+    for (auto &s : stages)
+    {
+        for (auto b : {s.input, s.filters, s.delayLine, s.accum, s.work, s.scratch})
+            pffft_aligned_free(b);
+        if (s.setup)
+            pffft_destroy_setup(s.setup);
+    }
+    pffft_aligned_free(output);
+}
+
+void PartitionedConvolver::buildStage(Stage &s, const float *ir, int irLength, int size,
+                                      int offset, int length)
+{
+    auto n = 2 * size;
+    s.size = size;
+    s.offset = offset;
+    s.partitions = std::max(1, (length + size - 1) / size);
+    s.setup = pffft_new_setup(n, PFFFT_REAL);
+
+    s.input = allocBuffer(n);
+    s.filters = allocBuffer(n * s.partitions);
+    s.delayLine = allocBuffer(n * s.partitions);
+    s.accum = allocBuffer(n);
+    s.work = allocBuffer(n);
+    s.scratch = allocBuffer(n);
+
+    // the inverse transform is unscaled, so fold its 1/n into the filters
+    for (int p = 0; p < s.partitions; ++p)
+    {
+        memset(s.scratch, 0, n * sizeof(float));
+        for (int i = 0; i < size; ++i)
+        {
+            auto k = offset + p * size + i;
+            if (k < irLength && k < offset + length)
+                s.scratch[i] = ir[k] / n;
+        }
+        pffft_transform(s.setup, s.scratch, s.filters + p * n, s.work, PFFFT_FORWARD);
+    }
+
+    // leave the newest partition's multiply for the period end, share the rest out
+    auto callsPerPeriod = std::max(1, size / blockSize);
+    s.perCall = (s.partitions - 1 + callsPerPeriod - 1) / callsPerPeriod;
+}
+
+void PartitionedConvolver::reset()
+{
+    for (auto &s : stages)
+    {
+        auto n = 2 * s.size;
+        memset(s.input, 0, n * sizeof(float));
+        memset(s.delayLine, 0, n * s.partitions * sizeof(float));
+        memset(s.accum, 0, n * sizeof(float));
+        s.inputFill = 0;
+        s.newest = 0;
+        s.nextPartition = 1;
+    }
+    memset(output, 0, (outMask + 1) * sizeof(float));
+    time = 0;
+}
+
+void PartitionedConvolver::process(const float *in, float *out)
+{
+    for (auto &s : stages)
+    {
+        auto n = 2 * s.size;
+        memcpy(s.input + s.size + s.inputFill, in, blockSize * sizeof(float));
+        s.inputFill += blockSize;
+
+        // partition j multiplies the spectrum j periods old, for the period now filling
+        auto end = std::min(s.partitions, s.nextPartition + s.perCall);
+        for (; s.nextPartition < end; ++s.nextPartition)
+        {
+            auto slot = (s.newest - (s.nextPartition - 1) + s.partitions) % s.partitions;
+            pffft_zconvolve_accumulate(s.setup, s.delayLine + slot * n,
+                                       s.filters + s.nextPartition * n, s.accum, 1.f);
+        }
+
+        if (s.inputFill >= s.size)
+            runPeriod(s);
+    }
+
+    for (int i = 0; i < blockSize; ++i)
+    {
+        auto &o = output[(time + i) & outMask];
+        out[i] = o;
+        o = 0.f;
+    }
+    time += blockSize;
+}
+
+void PartitionedConvolver::runPeriod(Stage &s)
+{
+    auto n = 2 * s.size;
+
+    for (; s.nextPartition < s.partitions; ++s.nextPartition)
+    {
+        auto slot = (s.newest - (s.nextPartition - 1) + s.partitions) % s.partitions;
+        pffft_zconvolve_accumulate(s.setup, s.delayLine + slot * n,
+                                   s.filters + s.nextPartition * n, s.accum, 1.f);
+    }
+
+    // the new spectrum takes the slot of the one which just aged out
+    s.newest = (s.newest + 1) % s.partitions;
+    auto spectrum = s.delayLine + s.newest * n;
+    pffft_transform(s.setup, s.input, spectrum, s.work, PFFFT_FORWARD);
+    memcpy(s.input, s.input + s.size, s.size * sizeof(float));
+    s.inputFill = 0;
+
+    pffft_zconvolve_accumulate(s.setup, spectrum, s.filters, s.accum, 1.f);
+    pffft_transform(s.setup, s.accum, s.scratch, s.work, PFFFT_BACKWARD);
+    memset(s.accum, 0, n * sizeof(float));
+    s.nextPartition = 1;
+
+    /*
+     * Overlap-save: the back half is this period's input through the stage's slice of the IR,
+     * which lands offset samples later. Only the head can land in the block being output, and
+     * then only when it is a whole period long, which is where the latency comes from.
+     */
+    unsigned int base = time + blockSize - s.size + s.offset + latencySamples;
+    for (int i = 0; i < s.size; ++i)
+        output[(base + i) & outMask] += s.scratch[s.size + i];
+}
+} // namespace DSP
+} // namespace Surge
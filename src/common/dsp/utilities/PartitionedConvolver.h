@@ -0,0 +1,89 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_UTILITIES_PARTITIONEDCONVOLVER_H
+#define SURGE_SRC_COMMON_DSP_UTILITIES_PARTITIONEDCONVOLVER_H
+
+#include <vector>
+
+struct PFFFT_Setup;
+
+namespace Surge
+{
+namespace DSP
+{
+/*
+ * Mono FFT convolution with a long impulse response, partitioned so the cost is low and
+ * steady at a small block size. The IR is cut into up to three uniformly partitioned
+ * overlap-save stages of growing size: a head with partitions of the block size (so there
+ * is no latency), then 1024 sample partitions from 1024 on, then 8192 sample partitions
+ * for everything past 8192. An IR shorter than 1024 samples is a single uniform stage.
+ *
+ * Each stage keeps a frequency domain delay line of its input spectra. The multiplies for
+ * all but the newest partition are spread over the blocks of a stage's period; what is
+ * left at the period's end is one multiply and the pair of transforms.
+ *
+ * All allocation happens in the constructor, so build these off the audio thread and hand
+ * them over. process() must always be called with blockSize samples.
+ */
+class PartitionedConvolver
+{
+  public:
+    PartitionedConvolver(const float *ir, int irLength, int blockSize);
+    ~PartitionedConvolver();
+
+    PartitionedConvolver(const PartitionedConvolver &) = delete;
+    PartitionedConvolver &operator=(const PartitionedConvolver &) = delete;
+
+    void reset();
+
+    void process(const float *in, float *out);
+
+    // in samples; zero unless the block size is below the smallest transform pffft allows
+    int latency() const { return latencySamples; }
+    int irLength() const { return irLen; }
+
+  private:
+    struct Stage
+    {
+        int size{0}, offset{0}, partitions{0};
+        PFFFT_Setup *setup{nullptr};
+        float *input{nullptr}; // the last 2 * size samples in
+        float *filters{nullptr}, *delayLine{nullptr}; // partitions spectra of 2 * size each
+        float *accum{nullptr}, *work{nullptr}, *scratch{nullptr};
+        int inputFill{0}, newest{0}, nextPartition{1}, perCall{1};
+    };
+
+    void buildStage(Stage &s, const float *ir, int irLength, int size, int offset, int length);
+    void runPeriod(Stage &s);
+
+    std::vector<Stage> stages;
+    int blockSize, irLen, latencySamples{0};
+
+    float *output{nullptr}; // indexed by absolute time, wrapping on outMask
+    int outMask{0};
+    unsigned int time{0};
+};
+} // namespace DSP
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_DSP_UTILITIES_PARTITIONEDCONVOLVER_H
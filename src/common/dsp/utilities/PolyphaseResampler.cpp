@@ -0,0 +1,172 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "PolyphaseResampler.h"
+#include "globals.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace Surge
+{
+namespace DSP
+{
+namespace
+{
+// taps per phase when converting 1:1; a downsampling filter is stretched by down/up
+constexpr int baseTaps = 16;
+
+bool reduce(double inRate, double outRate, int &up, int &down)
+{
+    if (inRate <= 0 || outRate <= 0 || inRate > 1e6 || outRate > 1e6 ||
+        inRate != std::floor(inRate) || outRate != std::floor(outRate))
+        return false;
+
+    auto i = (int)inRate, o = (int)outRate;
+    auto g = std::gcd(i, o);
+    up = o / g;
+    down = i / g;
+    return up <= PolyphaseResampler::maxPhases && down <= PolyphaseResampler::maxPhases;
+}
+
+double bessel0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; ++k)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+} // namespace
+
+bool PolyphaseResampler::supports(double inRate, double outRate)
+{
+    int u, d;
+    return reduce(inRate, outRate, u, d);
+}
+
+PolyphaseResampler::PolyphaseResampler(int inRate, int outRate)
+{
+    if (!reduce(inRate, outRate, up, down))
+    {
+        up = 1;
+        down = 1;
+    }
+
+    // round up to a whole number of SSE registers
+    taps = baseTaps * std::max(1, (down + up - 1) / up);
+    taps = (taps + 3) & ~3;
+
+    /*
+     * The prototype runs at inRate * up. Cut off a little under the lower of the two Nyquists
+     * so the transition band sits below it, and window with a Kaiser (beta 8, about 80dB of
+     * stopband) over the whole length.
+     */
+    int n = taps * up;
+    double fc = 0.45 * std::min(1.0, (double)up / down) / up;
+    double beta = 8.0;
+    double center = 0.5 * (n - 1);
+    double i0b = bessel0(beta);
+
+    std::vector<double> proto(n);
+    for (int i = 0; i < n; ++i)
+    {
+        double x = i - center;
+        double sinc = (x == 0) ? 2.0 * fc : std::sin(2.0 * M_PI * fc * x) / (M_PI * x);
+        double r = x / (0.5 * n);
+        double w = bessel0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / i0b;
+        proto[i] = sinc * w;
+    }
+
+    // each phase sums to unity so DC passes untouched whichever phase lands
+    coefs.resize(up * taps);
+    for (int p = 0; p < up; ++p)
+    {
+        double sum = 0;
+        for (int k = 0; k < taps; ++k)
+            sum += proto[p + k * up];
+
+        for (int k = 0; k < taps; ++k)
+            coefs[p * taps + (taps - 1 - k)] = (float)(proto[p + k * up] / sum);
+    }
+
+    histL.resize(2 * taps);
+    histR.resize(2 * taps);
+    reset();
+}
+
+void PolyphaseResampler::reset()
+{
+    std::fill(histL.begin(), histL.end(), 0.f);
+    std::fill(histR.begin(), histR.end(), 0.f);
+    histPos = 0;
+    phase = 0;
+}
+
+double PolyphaseResampler::latency() const { return 0.5 * (taps * up - 1) / down; }
+
+int PolyphaseResampler::process(const float *inL, const float *inR, int nIn, float *outL,
+                                float *outR)
+{
+    int nOut = 0;
+    for (int i = 0; i < nIn; ++i)
+    {
+        histL[histPos] = histL[histPos + taps] = inL[i];
+        histR[histPos] = histR[histPos + taps] = inR[i];
+        histPos = (histPos + 1 == taps) ? 0 : histPos + 1;
+
+        // every output whose position falls between this input and the next is complete now
+        while (phase < up)
+        {
+            const float *c = &coefs[phase * taps];
+            const float *hl = &histL[histPos];
+            const float *hr = &histR[histPos];
+
+            auto accL = _mm_setzero_ps();
+            auto accR = _mm_setzero_ps();
+            for (int k = 0; k < taps; k += 4)
+            {
+                auto ck = _mm_loadu_ps(c + k);
+                accL = _mm_add_ps(accL, _mm_mul_ps(ck, _mm_loadu_ps(hl + k)));
+                accR = _mm_add_ps(accR, _mm_mul_ps(ck, _mm_loadu_ps(hr + k)));
+            }
+
+            // horizontal sums, leaving L in lane 0 and R in lane 1
+            auto lo = _mm_add_ps(_mm_unpacklo_ps(accL, accR), _mm_unpackhi_ps(accL, accR));
+            auto s = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+            float res alignas(16)[4];
+            _mm_store_ps(res, s);
+            outL[nOut] = res[0];
+            outR[nOut] = res[1];
+            nOut++;
+
+            phase += down;
+        }
+        phase -= up;
+    }
+    return nOut;
+}
+} // namespace DSP
+} // namespace Surge
@@ -0,0 +1,79 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_UTILITIES_POLYPHASERESAMPLER_H
+#define SURGE_SRC_COMMON_DSP_UTILITIES_POLYPHASERESAMPLER_H
+
+#include <vector>
+
+namespace Surge
+{
+namespace DSP
+{
+/*
+ * A stereo resampler between two fixed integer rates, for effects which run their own DSP at
+ * a fixed internal rate (Nimbus runs the clouds processor at 32k). The ratio is reduced to
+ * up/down and a windowed sinc lowpass is designed once at construction and split into `up`
+ * phases, so each output sample is one SIMD dot product of a phase against the input
+ * history. There is no fractional position, so nothing is interpolated per sample.
+ *
+ * Only ratios which reduce to a modest number of phases are supported, which covers the
+ * usual host rates against any of the usual internal rates; check supports() first and use
+ * a general resampler otherwise. Output runs the filter's group delay, latency(), behind the
+ * input.
+ */
+class PolyphaseResampler
+{
+  public:
+    static constexpr int maxPhases = 512;
+
+    static bool supports(double inRate, double outRate);
+
+    PolyphaseResampler(int inRate, int outRate);
+
+    void reset();
+
+    /*
+     * Consume all nIn frames and write whatever output they complete, returning how many
+     * frames that was. That is never more than maxOutputFrames(nIn).
+     */
+    int process(const float *inL, const float *inR, int nIn, float *outL, float *outR);
+
+    int maxOutputFrames(int nIn) const { return (int)(((long long)nIn * up) / down) + 1; }
+
+    // group delay in output frames
+    double latency() const;
+
+    int upFactor() const { return up; }
+    int downFactor() const { return down; }
+    int tapsPerPhase() const { return taps; }
+
+  private:
+    int up, down, taps;
+    std::vector<float> coefs; // up rows of taps, each ordered oldest to newest input
+    std::vector<float> histL, histR; // taps of history, twice over so a window is contiguous
+    int histPos{0}, phase{0};
+};
+} // namespace DSP
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_DSP_UTILITIES_POLYPHASERESAMPLER_H
@@ -475,7 +475,8 @@ void SurgefxAudioProcessorEditor::makeMenu()
             auto t = -1;
             c->QueryIntAttribute("i", &t);
             men.fxtype = t;
-            if (t == fxt_audio_input) // skip the "Audio In" effect
+            // skip the "Audio In" effect, and convolution which has nowhere to load an IR here
+            if (t == fxt_audio_input || t == fxt_convolution)
             {
                 c = c->NextSiblingElement();
                 continue;
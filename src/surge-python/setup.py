@@ -9,7 +9,16 @@ where <REPO_DIR> is the surge repo.
 
 This uses scikit-build, a tool for packaging Python extensions built
 with CMake. For more information see https://scikit-build.readthedocs.io
+
+To also build engines at other block sizes, for surgepy.createSurge(sampleRate, blockSize),
+list them in SURGEPY_EXTRA_BLOCK_SIZES, e.g.
+
+    $ SURGEPY_EXTRA_BLOCK_SIZES="64;128" python3 -m pip install <REPO_DIR>/src/surge-python
+
+Each one is a whole extra copy of the engine, so by default only the default block size is built.
 """
+import os
+
 from skbuild import setup
 
 
@@ -17,6 +26,11 @@ def just_surgepy(cmake_manifest):
     return [x for x in cmake_manifest if "surgepy" in x]
 
 
+def extra_block_sizes_args():
+    sizes = os.environ.get("SURGEPY_EXTRA_BLOCK_SIZES", "").strip()
+    return ["-DSURGE_EXTRA_BLOCK_SIZES=" + sizes] if sizes else []
+
+
 setup(
     name="surgepy",
     version="0.1.0",
@@ -33,6 +47,7 @@ setup(
         "-DSURGE_SKIP_VST3=TRUE",
         "-DSURGE_SKIP_ALSA=TRUE",
         "-DSURGE_SKIP_STANDALONE=TRUE",
-    ],
+    ]
+    + extra_block_sizes_args(),
     cmake_process_manifest_hook=just_surgepy,
 )
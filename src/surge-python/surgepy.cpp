@@ -354,6 +354,23 @@ class SurgePyPatchConverter
     SurgeSynthesizer *synth = nullptr;
 };
 
+/*
+ * The events renderEvents understands. Each event is one row of a float array, holding
+ * (sampleTime, type, channel, data1, data2); the data columns are MIDI style integers.
+ */
+enum SurgePyRenderEventType
+{
+    re_note_on = 0,     // data1 key, data2 velocity
+    re_note_off,        // data1 key, data2 release velocity
+    re_pitch_bend,      // data1 bend, -8192 to 8191
+    re_cc,              // data1 controller, data2 value
+    re_chan_aftertouch, // data1 value
+    re_poly_aftertouch, // data1 key, data2 value
+    re_all_notes_off,
+
+    n_render_event_types
+};
+
 static std::unordered_map<ControlGroup, SurgePyControlGroup> spysetup_cgMap;
 static std::unordered_map<modsources, SurgePyModSource> spysetup_msMap;
 
@@ -667,6 +684,34 @@ class SurgeSynthesizerWithPythonExtensions : public SurgeSynthesizer
         return isBipolarModulation((modsources)from.getModSource());
     }
 
+    void setProcessProfiling(bool b)
+    {
+        if (b && !processProfiling)
+            storage.processProfiler.addClient();
+        if (!b && processProfiling)
+            storage.processProfiler.removeClient();
+        processProfiling = b;
+    }
+
+    py::dict getProcessProfile(int nBlocks)
+    {
+        namespace prof = Surge::Profiling;
+
+        auto avg = storage.processProfiler.average(std::max(nBlocks, 1));
+        auto res = py::dict();
+        res["blocks"] = avg.block;
+        auto us = py::dict();
+        for (int s = 0; s < prof::n_process_stages; ++s)
+            us[prof::processStageName(s)] = avg.usec[s];
+        res["usec"] = us;
+        auto asleep = py::dict();
+        for (int f = 0; f < n_fx_slots; ++f)
+            asleep[prof::processStageName(prof::fxStage(f))] = avg.fxAsleep[f];
+        res["fx_asleep"] = asleep;
+        return res;
+    }
+    bool processProfiling{false};
+
     py::array_t<float> createMultiBlock(int nBlocks)
     {
         auto res = py::array_t<float>({2, nBlocks * BLOCK_SIZE},
@@ -749,6 +794,158 @@ class SurgeSynthesizerWithPythonExtensions : public SurgeSynthesizer
         }
     }
 
+    struct RenderEvent
+    {
+        int64_t sample;
+        int type, channel, data1, data2;
+    };
+
+    /*
+     * Render nSamples into a caller owned (2, n) float array, applying a time sorted array of
+     * events on the way, with the GIL released for the whole render. Notes start on their
+     * sample; other events land at the start of the block they fall in. The stream carries
+     * across calls: a block which runs past the end of one call supplies the start of the
+     * next, and event times are relative to the first sample of each call.
+     */
+    void renderEvents(const py::array_t<double, py::array::c_style | py::array::forcecast> &events,
+                      const py::array_t<float> &arr, int nSamples = -1)
+    {
+        auto buf = arr.request(true);
+
+        if (buf.itemsize != sizeof(float) || buf.ndim != 2 || buf.shape[0] != 2 ||
+            buf.strides[1] != sizeof(float))
+        {
+            throw std::invalid_argument(
+                "Output numpy array must be a float32 array of shape (2, n) with contiguous rows");
+        }
+
+        if (nSamples < 0)
+            nSamples = buf.shape[1];
+
+        if (nSamples > buf.shape[1])
+        {
+            std::ostringstream oss;
+            oss << "Asked to render " << nSamples << " samples into an array with room for "
+                << buf.shape[1];
+            throw std::invalid_argument(oss.str().c_str());
+        }
+
+        auto ebuf = events.request();
+        if (ebuf.size > 0 && (ebuf.ndim != 2 || ebuf.shape[1] != 5))
+        {
+            throw std::invalid_argument("Events must be an array of shape (n, 5) holding rows of "
+                                        "(sampleTime, type, channel, data1, data2)");
+        }
+
+        auto nEvents = ebuf.size > 0 ? ebuf.shape[0] : 0;
+        auto eptr = static_cast<const double *>(ebuf.ptr);
+
+        renderEventQueue.clear();
+        renderEventQueue.reserve(nEvents);
+
+        for (py::ssize_t i = 0; i < nEvents; ++i)
+        {
+            auto *row = eptr + i * 5;
+            auto ev = RenderEvent{(int64_t)row[0], (int)row[1], (int)row[2], (int)row[3],
+                                  (int)row[4]};
+
+            if (ev.sample < 0 || ev.sample >= nSamples)
+            {
+                std::ostringstream oss;
+                oss << "Event " << i << " at sample " << ev.sample
+                    << " is outside of the render range 0.." << nSamples - 1;
+                throw std::invalid_argument(oss.str().c_str());
+            }
+            if (i > 0 && ev.sample < renderEventQueue.back().sample)
+            {
+                std::ostringstream oss;
+                oss << "Events must be sorted by time; event " << i << " at sample " << ev.sample
+                    << " comes before its predecessor";
+                throw std::invalid_argument(oss.str().c_str());
+            }
+            if (ev.type < 0 || ev.type >= n_render_event_types)
+            {
+                std::ostringstream oss;
+                oss << "Event " << i << " has unknown type " << ev.type;
+                throw std::invalid_argument(oss.str().c_str());
+            }
+
+            renderEventQueue.push_back(ev);
+        }
+
+        auto ptr = static_cast<float *>(buf.ptr);
+        auto rowStride = buf.strides[0] / (py::ssize_t)sizeof(float);
+
+        py::gil_scoped_release release;
+        renderEventsInto(ptr, ptr + rowStride, nSamples);
+    }
+
+    void applyRenderEvent(const RenderEvent &ev)
+    {
+        auto ch = (char)ev.channel, d1 = (char)ev.data1, d2 = (char)ev.data2;
+
+        switch (ev.type)
+        {
+        case re_note_on:
+            playNote(ch, d1, d2, 0);
+            break;
+        case re_note_off:
+            releaseNote(ch, d1, d2);
+            break;
+        case re_pitch_bend:
+            pitchBend(ch, ev.data1);
+            break;
+        case re_cc:
+            channelController(ch, ev.data1, ev.data2);
+            break;
+        case re_chan_aftertouch:
+            channelAftertouch(ch, ev.data1);
+            break;
+        case re_poly_aftertouch:
+            polyAftertouch(ch, ev.data1, ev.data2);
+            break;
+        case re_all_notes_off:
+            allNotesOff();
+            break;
+        }
+    }
+
+    void renderEventsInto(float *dL, float *dR, int nSamples)
+    {
+        size_t nextEvent = 0;
+        int64_t pos = 0;
+
+        while (pos < nSamples)
+        {
+            if (renderOutputPos == BLOCK_SIZE)
+            {
+                while (nextEvent < renderEventQueue.size() &&
+                       renderEventQueue[nextEvent].sample < pos + BLOCK_SIZE)
+                {
+                    setBlockEventOffset((int)(renderEventQueue[nextEvent].sample - pos));
+                    applyRenderEvent(renderEventQueue[nextEvent++]);
+                }
+
+                process();
+                renderOutputPos = 0;
+            }
+
+            auto n = std::min((int64_t)(BLOCK_SIZE - renderOutputPos), nSamples - pos);
+            memcpy(dL + pos, output[0] + renderOutputPos, n * sizeof(float));
+            memcpy(dR + pos, output[1] + renderOutputPos, n * sizeof(float));
+            renderOutputPos += n;
+            pos += n;
+        }
+
+        // anything at the very end of a call which didn't start a new block goes out now
+        setBlockEventOffset(0);
+        while (nextEvent < renderEventQueue.size())
+            applyRenderEvent(renderEventQueue[nextEvent++]);
+    }
+
+    std::vector<RenderEvent> renderEventQueue;
+    int renderOutputPos{BLOCK_SIZE};
+
     py::dict getPatchAsPy()
     {
         auto pc = SurgePyPatchConverter(this);
@@ -906,8 +1103,20 @@ SurgeSynthesizer *createSurge(float sr)
     return surge;
 }
 
+/*
+ * Block size variants of the module are built against an engine with a different BLOCK_SIZE
+ * and can be loaded alongside this one, so their classes mustn't be registered globally.
+ */
+#if SURGEPY_BLOCK_SIZE_VARIANT
+#define SURGEPY_LOCAL_TYPES py::module_local(true)
+#else
+#define SURGEPY_LOCAL_TYPES py::module_local(false)
+#endif
+
 // Prefix _ if using shared object within a Python package built with scikit-build
-#ifdef SKBUILD
+#if defined(SURGEPY_MODULE_NAME)
+PYBIND11_MODULE(SURGEPY_MODULE_NAME, m)
+#elif defined(SKBUILD)
 PYBIND11_MODULE(_surgepy, m)
 #else
 PYBIND11_MODULE(surgepy, m)
@@ -917,12 +1126,12 @@ PYBIND11_MODULE(surgepy, m)
     m.def("createSurge", &createSurge, "Create a Surge XT instance", py::arg("sampleRate"));
     m.def(
         "getVersion", []() { return Surge::Build::FullVersionStr; }, "Get the version of Surge XT");
-    py::class_<SurgeSynthesizer::ID>(m, "SurgeSynthesizer_ID")
+    py::class_<SurgeSynthesizer::ID>(m, "SurgeSynthesizer_ID", SURGEPY_LOCAL_TYPES)
         .def(py::init<>())
         .def("getSynthSideId", &SurgeSynthesizer::ID::getSynthSideId)
         .def("__repr__", &SurgeSynthesizer::ID::toString);
 
-    py::class_<SurgeSynthesizerWithPythonExtensions>(m, "SurgeSynthesizer")
+    py::class_<SurgeSynthesizerWithPythonExtensions>(m, "SurgeSynthesizer", SURGEPY_LOCAL_TYPES)
         .def("__repr__",
              [](SurgeSynthesizerWithPythonExtensions &s) {
                  return std::string("<SurgeSynthesizer samplerate=") +
@@ -1016,6 +1225,18 @@ PYBIND11_MODULE(surgepy, m)
         .def("getOutput", &SurgeSynthesizerWithPythonExtensions::getOutput,
              "Retrieve the internal output buffer as a 2 * BLOCK_SIZE numpy array.")
 
+        .def("seedRNG", &SurgeSynthesizer::seedRNG,
+             "Seed this instance's random number generator, so that renders which draw random "
+             "values (drift, noise, random LFOs and so on) can be reproduced.",
+             py::arg("seed"))
+        .def("setProcessProfiling", &SurgeSynthesizerWithPythonExtensions::setProcessProfiling,
+             "Turn on or off recording the per-stage timings of each process() block",
+             py::arg("on"))
+        .def("getProcessProfile", &SurgeSynthesizerWithPythonExtensions::getProcessProfile,
+             "Get the mean per-stage timings, in microseconds, of the last nBlocks blocks run "
+             "with profiling on. 'blocks' holds how many blocks were actually averaged.",
+             py::arg("nBlocks") = 64)
+
         .def("createMultiBlock", &SurgeSynthesizerWithPythonExtensions::createMultiBlock,
              "Create a numpy array suitable to hold up to b blocks of Surge XT processing in "
              "processMultiBlock",
@@ -1026,6 +1247,16 @@ PYBIND11_MODULE(surgepy, m)
              "entire array, or starting at startBlock position in the output, populate nBlocks.",
              py::arg("val"), py::arg("startBlock") = 0, py::arg("nBlocks") = -1)
 
+        .def("renderEvents", &SurgeSynthesizerWithPythonExtensions::renderEvents,
+             "Render nSamples (default: the whole array) straight into a (2, n) float32 numpy "
+             "array, with the GIL released.\n"
+             "events is an (n, 5) array of rows (sampleTime, type, channel, data1, data2), sorted "
+             "by time, with type one of surgepy.constants.re_*. Note ons start on their sample "
+             "and other events apply at the start of the block their sample falls in. "
+             "Successive calls continue one stream, so "
+             "nSamples need not be a multiple of the block size.",
+             py::arg("events"), py::arg("output"), py::arg("nSamples") = -1)
+
         .def("getPatch", &SurgeSynthesizerWithPythonExtensions::getPatchAsPy,
              "Get a Python dictionary with the Surge XT parameters laid out in the logical patch "
              "format")
@@ -1047,29 +1278,29 @@ PYBIND11_MODULE(surgepy, m)
                       &SurgeSynthesizerWithPythonExtensions::getTuningApplicationMode,
                       &SurgeSynthesizerWithPythonExtensions::setTuningApplicationMode);
 
-    py::class_<SurgePyControlGroup>(m, "SurgeControlGroup")
+    py::class_<SurgePyControlGroup>(m, "SurgeControlGroup", SURGEPY_LOCAL_TYPES)
         .def("getId", &SurgePyControlGroup::getControlGroupId)
         .def("getName", &SurgePyControlGroup::getControlGroupName)
         .def("getEntries", &SurgePyControlGroup::getEntries)
         .def("__repr__", &SurgePyControlGroup::toString);
 
-    py::class_<SurgePyControlGroupEntry>(m, "SurgeControlGroupEntry")
+    py::class_<SurgePyControlGroupEntry>(m, "SurgeControlGroupEntry", SURGEPY_LOCAL_TYPES)
         .def("getEntry", &SurgePyControlGroupEntry::getEntry)
         .def("getScene", &SurgePyControlGroupEntry::getScene)
         .def("getParams", &SurgePyControlGroupEntry::getParams)
         .def("__repr__", &SurgePyControlGroupEntry::toString);
 
-    py::class_<SurgePyNamedParam>(m, "SurgeNamedParamId")
+    py::class_<SurgePyNamedParam>(m, "SurgeNamedParamId", SURGEPY_LOCAL_TYPES)
         .def("getName", &SurgePyNamedParam::getName)
         .def("getId", &SurgePyNamedParam::getID)
         .def("__repr__", &SurgePyNamedParam::toString);
 
-    py::class_<SurgePyModSource>(m, "SurgeModSource")
+    py::class_<SurgePyModSource>(m, "SurgeModSource", SURGEPY_LOCAL_TYPES)
         .def("getModSource", &SurgePyModSource::getModSource)
         .def("getName", &SurgePyModSource::getName)
         .def("__repr__", &SurgePyModSource::toString);
 
-    py::class_<SurgePyModRouting>(m, "SurgeModRouting")
+    py::class_<SurgePyModRouting>(m, "SurgeModRouting", SURGEPY_LOCAL_TYPES)
         .def("getSource", [](const SurgePyModRouting &r) { return r.source; })
         .def("getDest", [](const SurgePyModRouting &r) { return r.dest; })
         .def("getSourceScene", [](const SurgePyModRouting &r) { return r.source_scene; })
@@ -1087,6 +1318,8 @@ PYBIND11_MODULE(surgepy, m)
         m.def_submodule("constants", "Constants which are used to navigate Surge XT");
 
 #define C(x) m_const.attr(#x) = py::int_((int)(x));
+    C(BLOCK_SIZE);
+
     C(cg_GLOBAL);
     C(cg_OSC);
     C(cg_MIX);
@@ -1095,6 +1328,14 @@ PYBIND11_MODULE(surgepy, m)
     C(cg_LFO);
     C(cg_FX);
 
+    C(re_note_on);
+    C(re_note_off);
+    C(re_pitch_bend);
+    C(re_cc);
+    C(re_chan_aftertouch);
+    C(re_poly_aftertouch);
+    C(re_all_notes_off);
+
     C(ms_velocity);
     C(ms_releasevelocity);
     C(ms_keytrack);
@@ -1258,7 +1499,7 @@ PYBIND11_MODULE(surgepy, m)
         C(FilterType::fut_tripole);
     }
 
-    py::enum_<SurgeStorage::TuningApplicationMode>(m, "TuningApplicationMode")
+    py::enum_<SurgeStorage::TuningApplicationMode>(m, "TuningApplicationMode", SURGEPY_LOCAL_TYPES)
         .value("RETUNE_ALL", SurgeStorage::TuningApplicationMode::RETUNE_ALL)
         .value("RETUNE_MIDI_ONLY", SurgeStorage::TuningApplicationMode::RETUNE_MIDI_ONLY);
 }
\ No newline at end of file
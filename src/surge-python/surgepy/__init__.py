@@ -1 +1,43 @@
+import importlib
+
 from ._surgepy import *
+from ._surgepy import createSurge as _createSurge
+from ._surgepy import constants as _constants
+
+_EXTRA_BLOCK_SIZE_PREFIX = "_surgepy_bs"
+
+
+def availableBlockSizes():
+    """
+    The engine block sizes this install of surgepy can create. The first is the default,
+    the rest are any built with SURGE_EXTRA_BLOCK_SIZES.
+    """
+    import pkgutil
+
+    sizes = [_constants.BLOCK_SIZE]
+    for m in pkgutil.iter_modules(__path__):
+        if m.name.startswith(_EXTRA_BLOCK_SIZE_PREFIX):
+            bs = int(m.name[len(_EXTRA_BLOCK_SIZE_PREFIX) :])
+            if bs not in sizes:
+                sizes.append(bs)
+    return sizes
+
+
+def createSurge(sampleRate, blockSize=None):
+    """
+    Create a Surge XT instance. The engine block size is fixed when it is compiled, so
+    a blockSize other than the default picks one of the engines built at extra block sizes.
+    Objects from different block size engines can't be mixed.
+    """
+    if blockSize is None or blockSize == _constants.BLOCK_SIZE:
+        return _createSurge(sampleRate)
+
+    try:
+        variant = importlib.import_module("." + _EXTRA_BLOCK_SIZE_PREFIX + str(blockSize), __name__)
+    except ImportError:
+        raise ValueError(
+            "surgepy was not built with block size {}; available block sizes are {}".format(
+                blockSize, availableBlockSizes()
+            )
+        ) from None
+    return variant.createSurge(sampleRate)
@@ -53,3 +53,76 @@ def test_set_tuningApplicationMode():
     s = surgepy.createSurge(44100)
     s.tuningApplicationMode = surgepy.TuningApplicationMode.RETUNE_ALL
     assert s.tuningApplicationMode == surgepy.TuningApplicationMode.RETUNE_ALL
+
+
+def test_process_profile():
+    s = surgepy.createSurge(44100)
+    s.setProcessProfiling(True)
+    s.playNote(0, 60, 127, 0)
+    for _ in range(32):
+        s.process()
+    prof = s.getProcessProfile(16)
+    assert prof["blocks"] == 16
+    assert prof["usec"]["total"] > 0.0
+    assert prof["usec"]["scene_a_voices"] <= prof["usec"]["total"]
+    assert "fx_0" in prof["usec"]
+
+
+def test_render_events():
+    """
+    Rendering with events in one call should match playing the same note and processing
+    block by block, and a render split over calls should continue the same stream. Each
+    instance is seeded alike, since voices draw random values as they start.
+    """
+    bs = surgepy.createSurge(44100).getBlockSize()
+    c = surgepy.constants
+    events = np.array(
+        [
+            [0, c.re_note_on, 0, 60, 127],
+            [10 * bs + 3, c.re_note_off, 0, 60, 0],
+        ]
+    )
+    n = 40 * bs
+
+    s1 = surgepy.createSurge(44100)
+    s1.seedRNG(2112)
+    whole = np.zeros((2, n), dtype=np.float32)
+    s1.renderEvents(events, whole)
+    assert not np.all(whole == 0.0)
+
+    s2 = surgepy.createSurge(44100)
+    s2.seedRNG(2112)
+    ref = s2.createMultiBlock(40)
+    s2.playNote(0, 60, 127, 0)
+    s2.processMultiBlock(ref, 0, 10)
+    s2.releaseNote(0, 60, 0)
+    s2.processMultiBlock(ref, 10, 30)
+    assert np.allclose(whole, ref)
+
+    s3 = surgepy.createSurge(44100)
+    s3.seedRNG(2112)
+    split = np.zeros((2, n), dtype=np.float32)
+    first = 10 * bs - 5
+    s3.renderEvents(events[:1], split[:, :first])
+    later = events[1:].copy()
+    later[:, 0] -= first
+    s3.renderEvents(later, split[:, first:])
+    assert np.allclose(whole, split)
+
+
+def test_block_sizes():
+    """
+    Every block size this install was built with renders at that size. Without the package
+    wrapper (a bare surgepy module) only the default block size exists.
+    """
+    if not hasattr(surgepy, "availableBlockSizes"):
+        assert surgepy.createSurge(44100).getBlockSize() == surgepy.constants.BLOCK_SIZE
+        return
+
+    for bs in surgepy.availableBlockSizes():
+        s = surgepy.createSurge(44100, bs)
+        assert s.getBlockSize() == bs
+        buf = s.createMultiBlock(int(s.getSampleRate() / bs))
+        s.playNote(0, 60, 127, 0)
+        s.processMultiBlock(buf)
+        assert not np.all(buf == 0.0)
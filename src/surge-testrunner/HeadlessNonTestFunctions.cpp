@@ -21,11 +21,25 @@
  */
 #include "HeadlessUtils.h"
 #include "Player.h"
+#include "RTSafetyDetector.h"
+#include "ClassicOscillator.h"
+#include "HostBlockSpans.h"
+#include "Effect.h"
+#include "VocoderEffect.h"
+#include "FFTVocoder.h"
+#include "PartitionedConvolver.h"
+#include "airwindows/AirWindowsSIMD.h"
 #include "filesystem/import.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <iomanip>
 #include <sstream>
 #include <chrono>
 #include <deque>
+#include <numeric>
+#include <random>
+#include <thread>
 
 namespace Surge
 {
@@ -146,6 +160,61 @@ void statsFromPlayingEveryPatch()
     Surge::Headless::playOnEveryPatch(surge, scale, callBack);
 }
 
+int rtSafetyCheckEveryPatch()
+{
+    /*
+     * Play the same scale as the stats run on every patch, with the detector recording
+     * allocations and locks made doing audio thread work (process() and the note events the
+     * player sends), and report each distinct offending stack per patch. Returns the number
+     * of patches which weren't clean.
+     */
+    if (!RTSafety::isAvailable())
+    {
+        std::cout << "The real time safety detector needs a Linux build configured with "
+                  << "-DSURGE_RT_SAFETY_CHECKS=ON" << std::endl;
+        return 0;
+    }
+
+    auto surge = Surge::Headless::createSurge(44100);
+
+    Surge::Headless::playerEvents_t scale =
+        Surge::Headless::make120BPMCMajorQuarterNoteScale(0, 44100);
+
+    int nPatches{0}, nOffending{0};
+    RTSafety::arm();
+
+    auto callBack = [&](const Patch &p, const PatchCategory &pc, const float *data, int nSamples,
+                        int nChannels) -> void {
+        auto violations = RTSafety::collect();
+        nPatches++;
+
+        if (!violations.empty())
+        {
+            nOffending++;
+            std::cout << "cat/patch = " << pc.name << " / " << p.name << " : "
+                      << violations.size() << " offending call stack(s)\n";
+            for (const auto &v : violations)
+            {
+                std::cout << "  " << v.kind << " (" << v.count << " times)\n";
+                for (const auto &f : v.stack)
+                    std::cout << "      " << f << "\n";
+            }
+            std::cout << std::endl;
+        }
+
+        // re-arm for the next patch. Its load happens outside the audio thread scopes so isn't
+        // counted
+        RTSafety::arm();
+    };
+
+    Surge::Headless::playOnEveryPatch(surge, scale, callBack);
+    RTSafety::collect();
+
+    std::cout << nOffending << " of " << nPatches
+              << " patches allocated or locked on the audio thread" << std::endl;
+    return nOffending;
+}
+
 void standardCutoffCurve(int ft, int sft, std::ostream &os)
 {
     /*
@@ -614,6 +683,606 @@ void filterAnalyzer(int ft, int sft, std::ostream &os)
     }
 }
 
+void modulationEditStormBenchmark()
+{
+    /*
+     * Hammer the routing from a "UI" thread with depth changes, mutes, clears and the
+     * lock-and-read pass the editor does on every modulation repaint, while the audio thread
+     * renders a chord. Report the per-block render times alongside the longest the UI
+     * held modRoutingMutex, which is the stall the audio thread used to be exposed to.
+     */
+    auto surge = Surge::Headless::createSurge(48000);
+    auto &patch = surge->storage.getPatch();
+
+    std::vector<long> dests = {patch.scene[0].filterunit[0].cutoff.id,
+                               patch.scene[0].filterunit[0].resonance.id,
+                               patch.scene[0].osc[0].pitch.id, patch.scene[0].volume.id};
+    std::vector<modsources> sources = {ms_lfo1, ms_slfo1, ms_modwheel, ms_ctrl1};
+
+    for (int i = 0; i < 10; ++i)
+        surge->process();
+    for (auto n : {48, 52, 55, 59, 60, 64, 67, 71})
+        surge->playNote(0, n, 127, 0);
+
+    std::atomic<bool> storming{true};
+    std::atomic<int> edits{0};
+    std::atomic<int64_t> maxHoldNs{0};
+
+    std::thread ui([&]() {
+        std::default_random_engine gen(2112);
+        std::uniform_int_distribution<int> pick(0, 1023);
+
+        while (storming)
+        {
+            auto d = dests[pick(gen) % dests.size()];
+            auto m = sources[pick(gen) % sources.size()];
+
+            switch (pick(gen) % 4)
+            {
+            case 0:
+            case 1:
+                surge->setModDepth01(d, m, 0, 0, pick(gen) / 1024.f);
+                break;
+            case 2:
+                surge->muteModulation(d, m, 0, 0, pick(gen) % 2);
+                break;
+            case 3:
+                surge->clearModulation(d, m, 0, 0);
+                break;
+            }
+
+            // the editor's refresh walks every routing with the lock held
+            auto st = std::chrono::high_resolution_clock::now();
+            {
+                std::lock_guard<std::recursive_mutex> g(surge->storage.modRoutingMutex);
+                for (auto dd : dests)
+                    for (auto mm : sources)
+                        surge->getModDepth01(dd, mm, 0, 0);
+            }
+            auto hold = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::high_resolution_clock::now() - st)
+                            .count();
+            if (hold > maxHoldNs)
+                maxHoldNs = hold;
+
+            edits++;
+        }
+    });
+
+    int blocks = 10 * 48000 / BLOCK_SIZE;
+    std::vector<double> blockUs(blocks);
+    for (int i = 0; i < blocks; ++i)
+    {
+        auto st = std::chrono::high_resolution_clock::now();
+        surge->process();
+        auto et = std::chrono::high_resolution_clock::now();
+        blockUs[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(et - st).count() / 1000.0;
+    }
+
+    storming = false;
+    ui.join();
+
+    auto mean = std::accumulate(blockUs.begin(), blockUs.end(), 0.0) / blocks;
+    std::sort(blockUs.begin(), blockUs.end());
+
+    std::cout << "10 seconds of audio at 48k under " << edits << " routing edits\n"
+              << "  block budget     : " << BLOCK_SIZE * 1e6 / 48000 << "us\n"
+              << "  mean block       : " << mean << "us\n"
+              << "  99th percentile  : " << blockUs[(int)(blocks * 0.99)] << "us\n"
+              << "  worst block      : " << blockUs.back() << "us\n"
+              << "  longest UI hold  : " << maxHoldNs / 1000.0 << "us" << std::endl;
+}
+
+void hostBufferBenchmark()
+{
+    /*
+     * Drive a synth the way a plugin's process callback does, for a range of host buffer
+     * sizes: copy the main and both scene outputs out to host buffers and apply a note event
+     * every 100ms. We time the per sample loop the plugin used to have against the span loop
+     * in HostBlockSpans.h, first with the synth idle so the loop and the copies are all there
+     * is to measure, then with it playing to show what that's worth in practice.
+     */
+    constexpr int sampleRate = 48000, seconds = 20, nOut = 6;
+    const int64_t totalFrames = (int64_t)seconds * sampleRate;
+
+    std::vector<int64_t> eventAt;
+    for (int64_t e = 0; e < totalFrames; e += sampleRate / 10)
+        eventAt.push_back(e);
+
+    auto run = [&](int bufferSize, bool spans, bool playing) {
+        auto surge = Surge::Headless::createSurge(sampleRate);
+        surge->activateExtraOutputs = true;
+        for (int i = 0; i < 10; ++i)
+            surge->process();
+
+        std::vector<std::vector<float>> host(nOut, std::vector<float>(bufferSize));
+        const float *synthOut[nOut] = {surge->output[0],      surge->output[1],
+                                       surge->sceneout[0][0], surge->sceneout[0][1],
+                                       surge->sceneout[1][0], surge->sceneout[1][1]};
+        size_t nextEvent = 0;
+        int noteCount = 0;
+        int blockPos = 0;
+
+        auto applyEvent = [&](int offset) {
+            surge->setBlockEventOffset(offset);
+            if (noteCount++ % 2 == 0)
+                surge->playNote(0, 60, 127, 0);
+            else
+                surge->releaseNote(0, 60, 0);
+            nextEvent++;
+        };
+
+        auto st = std::chrono::high_resolution_clock::now();
+        for (int64_t bufferStart = 0; bufferStart + bufferSize <= totalFrames;
+             bufferStart += bufferSize)
+        {
+            if (spans)
+            {
+                auto startBlock = [&](int f) {
+                    while (nextEvent < eventAt.size() &&
+                           eventAt[nextEvent] < bufferStart + f + BLOCK_SIZE)
+                    {
+                        applyEvent((int)(eventAt[nextEvent] - bufferStart - f));
+                    }
+                    if (playing)
+                        surge->process();
+                };
+                auto copySpan = [&](int f, int pos, int n) {
+                    for (int c = 0; c < nOut; ++c)
+                        Surge::copyHostSpan(host[c].data() + f, synthOut[c] + pos, n);
+                };
+                Surge::forEachHostBlockSpan(blockPos, bufferSize, startBlock, copySpan);
+            }
+            else
+            {
+                for (int f = 0; f < bufferSize; ++f)
+                {
+                    while (nextEvent < eventAt.size() && eventAt[nextEvent] == bufferStart + f)
+                        applyEvent(0);
+
+                    if (blockPos == 0 && playing)
+                        surge->process();
+
+                    for (int c = 0; c < nOut; ++c)
+                        host[c][f] = synthOut[c][blockPos];
+
+                    blockPos = (blockPos + 1) & (BLOCK_SIZE - 1);
+                }
+            }
+        }
+        auto et = std::chrono::high_resolution_clock::now();
+
+        auto frames = (totalFrames / bufferSize) * bufferSize;
+        return std::chrono::duration<double, std::nano>(et - st).count() / frames;
+    };
+
+    std::cout << "ns per sample frame, " << nOut << " output channels, BLOCK_SIZE=" << BLOCK_SIZE
+              << "\n"
+              << "buffer    idle: per-sample   spans   speedup |  playing: per-sample   spans\n";
+    for (auto bs : {1, 7, 16, 32, 48, 64, 100, 128, 256, 441, 480, 512, 1000, 1024, 2048, 4096})
+    {
+        auto idleSample = run(bs, false, false);
+        auto idleSpan = run(bs, true, false);
+        auto playSample = run(bs, false, true);
+        auto playSpan = run(bs, true, true);
+
+        std::cout << std::setw(6) << bs << std::fixed << std::setprecision(2) << std::setw(20)
+                  << idleSample << std::setw(8) << idleSpan << std::setw(9)
+                  << idleSample / idleSpan << "x |" << std::setw(20) << playSample
+                  << std::setw(8) << playSpan << std::endl;
+    }
+}
+
+void cpuPerVoiceBenchmark()
+{
+    /*
+     * The block size is fixed when the engine is compiled, so to compare block sizes build
+     * with SURGE_EXTRA_BLOCK_SIZES and run this in each surge-testrunner-bs<size> as well as
+     * here. We report the wall time per second of audio for a growing held chord on the
+     * default patch, and that divided by the voice count, so per block overheads show up as
+     * the gap between the sizes at low polyphony.
+     */
+    constexpr int sampleRate = 48000, seconds = 10;
+    const int blocks = seconds * sampleRate / BLOCK_SIZE;
+
+    std::cout << "BLOCK_SIZE=" << BLOCK_SIZE << ", " << seconds << " seconds at " << sampleRate
+              << "\n"
+              << "voices    us per audio second    us per voice\n";
+    for (auto nv : {0, 1, 2, 4, 8, 16, 32, 64})
+    {
+        auto surge = Surge::Headless::createSurge(sampleRate);
+        surge->storage.getPatch().polylimit.val.i = std::max(nv, 1);
+        for (int i = 0; i < 10; ++i)
+            surge->process();
+        for (int v = 0; v < nv; ++v)
+            surge->playNote(0, 36 + v, 127, 0);
+
+        auto st = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < blocks; ++i)
+            surge->process();
+        auto et = std::chrono::high_resolution_clock::now();
+
+        auto usPerSecond = std::chrono::duration<double, std::micro>(et - st).count() / seconds;
+        std::cout << std::setw(6) << nv << std::fixed << std::setprecision(1) << std::setw(25)
+                  << usPerSecond << std::setw(16);
+        if (nv > 0)
+            std::cout << usPerSecond / nv;
+        else
+            std::cout << "-";
+        std::cout << std::endl;
+    }
+}
+
+void measureFXTails()
+{
+    /*
+     * For every fx type at its default settings, feed a second of noise then silence and
+     * watch the output against fx_silence_floor. The tail is how long until the output goes
+     * quiet for good and the gap is the longest quiet stretch before then. Effects with no
+     * ringout decay sleep once they've been quiet for their hold, so the hold has to be longer
+     * than the gap. We call process() directly so sleeping doesn't cut the measurement short.
+     */
+    constexpr int sampleRate = 48000, inSeconds = 1, outSeconds = 30;
+    const int inBlocks = inSeconds * sampleRate / BLOCK_SIZE;
+    const int outBlocks = outSeconds * sampleRate / BLOCK_SIZE;
+    const float blockSec = 1.f * BLOCK_SIZE / sampleRate;
+
+    std::cout << std::setw(20) << "fx" << std::setw(10) << "ringout" << std::setw(10) << "tail s"
+              << std::setw(10) << "gap s" << std::setw(10) << "hold s" << std::endl;
+
+    for (int t = fxt_off + 1; t < n_fx_types; ++t)
+    {
+        auto surge = Surge::Headless::createSurge(sampleRate);
+        for (int i = 0; i < 10; ++i)
+            surge->process();
+
+        auto *pt = &(surge->storage.getPatch().fx[0].type);
+        surge->setParameter01(surge->idForParameter(pt), 1.f * t / (pt->val_max.i - pt->val_min.i),
+                              false);
+        for (int i = 0; i < 10; ++i)
+            surge->process();
+
+        auto &fx = surge->fx[0];
+        if (!fx)
+            continue;
+
+        std::default_random_engine gen(t);
+        std::uniform_real_distribution<float> noise(-0.25f, 0.25f);
+        float L alignas(16)[BLOCK_SIZE], R alignas(16)[BLOCK_SIZE];
+
+        for (int b = 0; b < inBlocks; ++b)
+        {
+            for (int i = 0; i < BLOCK_SIZE; ++i)
+            {
+                L[i] = noise(gen);
+                R[i] = noise(gen);
+            }
+            fx->process(L, R);
+        }
+
+        int lastLoud = -1, gap = 0, longestGap = 0;
+        for (int b = 0; b < outBlocks; ++b)
+        {
+            std::fill(L, L + BLOCK_SIZE, 0.f);
+            std::fill(R, R + BLOCK_SIZE, 0.f);
+            fx->process(L, R);
+
+            float sum = 0.f;
+            for (int i = 0; i < BLOCK_SIZE; ++i)
+                sum += L[i] * L[i] + R[i] * R[i];
+
+            if (sum >= fx_silence_floor * fx_silence_floor * 2 * BLOCK_SIZE)
+            {
+                longestGap = std::max(longestGap, gap);
+                gap = 0;
+                lastLoud = b;
+            }
+            else
+            {
+                gap++;
+            }
+        }
+
+        std::cout << std::setw(20) << fx_type_names[t] << std::setw(10) << fx->get_ringout_decay()
+                  << std::fixed << std::setprecision(2) << std::setw(10);
+        if (lastLoud == outBlocks - 1)
+            std::cout << "never";
+        else
+            std::cout << (lastLoud + 1) * blockSec;
+        std::cout << std::setw(10) << longestGap * blockSec << std::setw(10)
+                  << fx->get_sleep_hold_seconds() << std::endl;
+    }
+}
+
+void parallelSceneBenchmark(const std::string &patchName)
+{
+    /*
+     * Render the same layered performance serially and with parallel scene rendering
+     * and report the wall time of each. If no patch is given we use the default patch in dual mode
+     * with a few unison voices per scene so both scenes have something to chew on.
+     */
+    auto timeRender = [&patchName](bool parallel) {
+        auto surge = Surge::Headless::createSurge(48000);
+        if (!patchName.empty())
+        {
+            surge->loadPatchByPath(patchName.c_str(), -1, "RUNTIME");
+        }
+        else
+        {
+            for (int s = 0; s < n_scenes; ++s)
+            {
+                for (int o = 0; o < n_oscs; ++o)
+                {
+                    auto &osc = surge->storage.getPatch().scene[s].osc[o];
+                    osc.p[ClassicOscillator::co_unison_voices].val.i = 4;
+                }
+            }
+        }
+
+        surge->storage.getPatch().scenemode.val.i = sm_dual;
+        surge->storage.getPatch().polylimit.val.i = 32;
+        surge->setParallelSceneRendering(parallel);
+
+        for (int i = 0; i < 10; ++i)
+            surge->process();
+
+        for (auto n : {48, 52, 55, 59, 60, 64, 67, 71})
+            surge->playNote(0, n, 127, 0);
+
+        int blocks = 30 * 48000 / BLOCK_SIZE;
+        auto st = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < blocks; ++i)
+            surge->process();
+        auto et = std::chrono::high_resolution_clock::now();
+
+        return std::make_pair(
+            std::chrono::duration_cast<std::chrono::microseconds>(et - st).count() / 1000.0,
+            (int)surge->polydisplay);
+    };
+
+    auto serial = timeRender(false);
+    auto parallel = timeRender(true);
+
+    std::cout << "30 seconds of audio at 48k, " << serial.second << " voices\n"
+              << "  serial scenes   : " << serial.first << "ms\n"
+              << "  parallel scenes : " << parallel.first << "ms\n"
+              << "  speedup         : " << serial.first / parallel.first << "x" << std::endl;
+}
+
+void airwindowsSIMDBenchmark()
+{
+    /*
+     * For each Airwindows algorithm with a SIMD kernel, time it against the scalar port on
+     * the same noise, at its default parameters, and show the worst difference between them.
+     */
+    constexpr int sampleRate = 48000, blocks = 20 * sampleRate / BLOCK_SIZE;
+    auto reg = AirWinBaseClass::pluginRegistry();
+
+    std::vector<float> inL(blocks * BLOCK_SIZE), inR(blocks * BLOCK_SIZE);
+    std::default_random_engine gen(2112);
+    std::uniform_real_distribution<float> noise(-1.f, 1.f);
+    for (size_t i = 0; i < inL.size(); ++i)
+    {
+        inL[i] = noise(gen);
+        inR[i] = noise(gen);
+    }
+
+    std::cout << std::setw(16) << "airwindows" << std::setw(14) << "scalar ns/s" << std::setw(14)
+              << "simd ns/s" << std::setw(10) << "speedup" << std::setw(14) << "max diff"
+              << std::endl;
+
+    for (const auto &name : Surge::AirWindows::simdKernelNames())
+    {
+        auto r = std::find_if(reg.begin(), reg.end(), [&](auto &e) { return e.name == name; });
+        if (r == reg.end())
+            continue;
+
+        auto scalar = r->create(r->id, sampleRate, 2);
+        auto kernel = Surge::AirWindows::createSIMDKernel(name);
+
+        std::vector<float> scalarL(inL.size()), scalarR(inL.size());
+        std::vector<float> simdL(inL.size()), simdR(inL.size());
+
+        auto time = [&](auto &&f, std::vector<float> &outL, std::vector<float> &outR) {
+            auto st = std::chrono::high_resolution_clock::now();
+            for (int b = 0; b < blocks; ++b)
+            {
+                float *in[2] = {inL.data() + b * BLOCK_SIZE, inR.data() + b * BLOCK_SIZE};
+                float *out[2] = {outL.data() + b * BLOCK_SIZE, outR.data() + b * BLOCK_SIZE};
+                f(in, out);
+            }
+            auto et = std::chrono::high_resolution_clock::now();
+            return std::chrono::duration<double, std::nano>(et - st).count() / inL.size();
+        };
+
+        auto scalarNs = time(
+            [&](float **in, float **out) { scalar->processReplacing(in, out, BLOCK_SIZE); },
+            scalarL, scalarR);
+        auto simdNs = time(
+            [&](float **in, float **out) { kernel->process(scalar.get(), in, out, BLOCK_SIZE); },
+            simdL, simdR);
+
+        float maxDiff = 0.f;
+        for (size_t i = 0; i < inL.size(); ++i)
+            maxDiff = std::max({maxDiff, std::fabs(scalarL[i] - simdL[i]),
+                                std::fabs(scalarR[i] - simdR[i])});
+
+        std::cout << std::setw(16) << name << std::fixed << std::setprecision(2) << std::setw(14)
+                  << scalarNs << std::setw(14) << simdNs << std::setw(9) << scalarNs / simdNs
+                  << "x" << std::scientific << std::setw(14) << maxDiff << std::defaultfloat
+                  << std::endl;
+    }
+}
+
+void vocoderBenchmark()
+{
+    /*
+     * Time the vocoder's process() alone on noise, across the band counts of the filter bank
+     * and of the FFT engine. The modulator is whatever the last synth block left on the audio
+     * input, which is noise too.
+     */
+    constexpr int sampleRate = 48000, blocks = 10 * sampleRate / BLOCK_SIZE;
+    auto surge = Surge::Headless::createSurge(sampleRate);
+    auto *pt = &(surge->storage.getPatch().fx[0].type);
+    surge->setParameter01(surge->idForParameter(pt),
+                          1.f * fxt_vocoder / (pt->val_max.i - pt->val_min.i), false);
+
+    std::default_random_engine gen(2112);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    for (int i = 0; i < 10; ++i)
+    {
+        for (int s = 0; s < BLOCK_SIZE; ++s)
+        {
+            surge->input[0][s] = noise(gen);
+            surge->input[1][s] = noise(gen);
+        }
+        surge->process();
+    }
+
+    std::vector<float> carrier(2 * BLOCK_SIZE * blocks);
+    for (auto &c : carrier)
+        c = noise(gen);
+
+    std::cout << std::setw(14) << "engine" << std::setw(8) << "bands" << std::setw(14)
+              << "ns/sample" << std::endl;
+
+    for (auto engine : {VocoderEffect::ve_filterbank, VocoderEffect::ve_fft})
+    {
+        for (int bp = 4; bp <= n_vocoder_bands; bp += 4)
+        {
+            auto &nb = surge->storage.getPatch().fx[0].p[VocoderEffect::voc_num_bands];
+            nb.deform_type = engine;
+            nb.val.i = bp;
+            for (int i = 0; i < 70; ++i)
+                surge->process(); // picks up the band count on its next setvars
+
+            auto *fx = surge->fx[0].get();
+            auto st = std::chrono::high_resolution_clock::now();
+            for (int b = 0; b < blocks; ++b)
+                fx->process(carrier.data() + 2 * b * BLOCK_SIZE,
+                            carrier.data() + (2 * b + 1) * BLOCK_SIZE);
+            auto et = std::chrono::high_resolution_clock::now();
+
+            auto ns = std::chrono::duration<double, std::nano>(et - st).count() /
+                      (blocks * BLOCK_SIZE);
+            std::cout << std::setw(14)
+                      << (engine == VocoderEffect::ve_fft ? "fft" : "filter bank")
+                      << std::setw(8)
+                      << (engine == VocoderEffect::ve_fft ? FFTVocoder::bandsForParam(bp) : bp)
+                      << std::fixed << std::setprecision(2) << std::setw(14) << ns
+                      << std::defaultfloat << std::endl;
+        }
+    }
+}
+
+void convolutionBenchmark()
+{
+    /*
+     * Time the convolution reverb's stereo convolver pair on IRs of decaying noise from one to
+     * ten seconds: how long the loader thread takes to partition the IR, the mean cost per
+     * sample, and the worst single block, which is where the big partitions' transforms land.
+     */
+    constexpr int sampleRate = 48000, blocks = 10 * sampleRate / BLOCK_SIZE;
+    constexpr double blockBudgetUs = 1e6 * BLOCK_SIZE / sampleRate;
+
+    std::default_random_engine gen(2112);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+
+    std::vector<float> input(2 * BLOCK_SIZE * blocks);
+    for (auto &i : input)
+        i = noise(gen);
+
+    std::cout << std::setw(10) << "IR secs" << std::setw(12) << "build ms" << std::setw(12)
+              << "ns/sample" << std::setw(16) << "worst block us" << std::setw(14)
+              << "% of block" << std::endl;
+
+    for (int secs = 1; secs <= 10; ++secs)
+    {
+        std::vector<float> irL(secs * sampleRate), irR(secs * sampleRate);
+        for (int i = 0; i < irL.size(); ++i)
+        {
+            auto env = std::exp(-6.9 * i / irL.size()) * 0.05;
+            irL[i] = noise(gen) * env;
+            irR[i] = noise(gen) * env;
+        }
+
+        auto bt = std::chrono::high_resolution_clock::now();
+        auto convL = Surge::DSP::PartitionedConvolver(irL.data(), irL.size(), BLOCK_SIZE);
+        auto convR = Surge::DSP::PartitionedConvolver(irR.data(), irR.size(), BLOCK_SIZE);
+        auto be = std::chrono::high_resolution_clock::now();
+
+        float outL alignas(16)[BLOCK_SIZE], outR alignas(16)[BLOCK_SIZE];
+        double worst = 0;
+        auto st = std::chrono::high_resolution_clock::now();
+        for (int b = 0; b < blocks; ++b)
+        {
+            auto bs = std::chrono::high_resolution_clock::now();
+            convL.process(input.data() + 2 * b * BLOCK_SIZE, outL);
+            convR.process(input.data() + (2 * b + 1) * BLOCK_SIZE, outR);
+            auto bf = std::chrono::high_resolution_clock::now();
+            worst = std::max(worst, std::chrono::duration<double, std::micro>(bf - bs).count());
+        }
+        auto et = std::chrono::high_resolution_clock::now();
+
+        auto buildMs = std::chrono::duration<double, std::milli>(be - bt).count();
+        auto ns = std::chrono::duration<double, std::nano>(et - st).count() /
+                  (blocks * BLOCK_SIZE);
+        std::cout << std::setw(10) << secs << std::fixed << std::setprecision(2)
+                  << std::setw(12) << buildMs << std::setw(12) << ns << std::setw(16) << worst
+                  << std::setw(14) << 100.0 * worst / blockBudgetUs << std::defaultfloat
+                  << std::endl;
+    }
+}
+
+void parallelFXBenchmark()
+{
+    /*
+     * Load heavy effects into both insert chains and all four sends of a dual patch and
+     * render it with the fx graph serial and parallel. Nimbus draws on a shared RNG, so it
+     * shows the cost of chains which have to stay together.
+     */
+    auto timeRender = [](bool parallel) {
+        auto surge = Surge::Headless::createSurge(48000);
+        surge->storage.getPatch().scenemode.val.i = sm_dual;
+        surge->setParallelFXRendering(parallel);
+
+        std::vector<std::pair<int, int>> slotTypes = {
+            {fxslot_ains1, fxt_spring_reverb}, {fxslot_bins1, fxt_tape},
+            {fxslot_send1, fxt_reverb2},       {fxslot_send2, fxt_nimbus},
+            {fxslot_send3, fxt_spring_reverb}, {fxslot_send4, fxt_chow}};
+        for (auto [slot, type] : slotTypes)
+        {
+            auto *pt = &(surge->storage.getPatch().fx[slot].type);
+            surge->setParameter01(surge->idForParameter(pt),
+                                  1.f * type / (pt->val_max.i - pt->val_min.i), false);
+            for (int i = 0; i < 10; ++i)
+                surge->process();
+        }
+        for (int s = 0; s < n_scenes; ++s)
+            for (int i = 0; i < n_send_slots; ++i)
+                surge->storage.getPatch().scene[s].send_level[i].val.f = 0.5f;
+
+        for (auto n : {48, 55, 60, 64})
+            surge->playNote(0, n, 127, 0);
+
+        int blocks = 30 * 48000 / BLOCK_SIZE;
+        auto st = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < blocks; ++i)
+            surge->process();
+        auto et = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration_cast<std::chrono::microseconds>(et - st).count() / 1000.0;
+    };
+
+    auto serial = timeRender(false);
+    auto parallel = timeRender(true);
+
+    std::cout << "30 seconds of audio at 48k, 2 insert chains and 4 sends\n"
+              << "  serial fx   : " << serial << "ms\n"
+              << "  parallel fx : " << parallel << "ms\n"
+              << "  speedup     : " << serial / parallel << "x" << std::endl;
+}
+
 void generateNLFeedbackNorms()
 {
     /*
@@ -32,8 +32,18 @@ namespace NonTest
 void initializePatchDB();
 void restreamTemplatesWithModifications();
 void statsFromPlayingEveryPatch();
+int rtSafetyCheckEveryPatch();
 void filterAnalyzer(int ft, int fst, std::ostream &os);
 void generateNLFeedbackNorms();
+void parallelSceneBenchmark(const std::string &patchName);
+void parallelFXBenchmark();
+void airwindowsSIMDBenchmark();
+void vocoderBenchmark();
+void convolutionBenchmark();
+void modulationEditStormBenchmark();
+void hostBufferBenchmark();
+void cpuPerVoiceBenchmark();
+void measureFXTails();
 [[noreturn]] void performancePlay(const std::string &patchName, int mode);
 } // namespace NonTest
 } // namespace Headless
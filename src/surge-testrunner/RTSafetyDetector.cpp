@@ -0,0 +1,329 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "RTSafetyDetector.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#if SURGE_RT_SAFETY_CHECKS && defined(__GLIBC__)
+#define SURGE_RT_SAFETY_HOOKS 1
+#else
+#define SURGE_RT_SAFETY_HOOKS 0
+#endif
+
+#if SURGE_RT_SAFETY_HOOKS
+#include <atomic>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "DebugHelpers.h"
+
+extern "C"
+{
+    void *__libc_malloc(size_t);
+    void *__libc_calloc(size_t, size_t);
+    void *__libc_realloc(void *, size_t);
+    void *__libc_memalign(size_t, size_t);
+    void __libc_free(void *);
+}
+#endif
+
+namespace Surge
+{
+namespace Headless
+{
+namespace RTSafety
+{
+#if SURGE_RT_SAFETY_HOOKS
+namespace detail
+{
+enum Kind
+{
+    k_malloc,
+    k_free,
+    k_lock,
+    k_wait,
+};
+
+const char *kindNames[] = {"malloc", "free", "mutex lock", "mutex wait"};
+
+constexpr int maxFrames = 32;
+constexpr int maxRecords = 1024;
+
+/*
+ * Records are deduplicated by stack as they come in, so a per-block allocation costs one
+ * record however long the patch plays. The audio thread and any WorkerPool threads helping it
+ * record concurrently: a new stack claims its slot with a fetch_add on nRecords and publishes
+ * it through ready once filled, and counts are atomic. Two threads can both miss each other's
+ * not yet published record for the same stack, so collect(), which runs once they have all
+ * returned, merges any duplicates.
+ */
+struct Record
+{
+    Kind kind;
+    std::atomic<int> count;
+    int nFrames;
+    void *frames[maxFrames];
+    std::atomic<bool> ready;
+};
+Record records[maxRecords];
+std::atomic<int> nRecords{0}, nDropped{0};
+
+std::atomic<bool> armed{false};
+thread_local bool inHook{false};
+
+inline bool shouldRecord()
+{
+    return Surge::Debug::audioThreadScopeDepth > 0 && !inHook &&
+           armed.load(std::memory_order_relaxed);
+}
+
+inline bool sameStack(const Record &r, Kind k, int n, void *const *frames)
+{
+    return r.kind == k && r.nFrames == n && memcmp(r.frames, frames, n * sizeof(void *)) == 0;
+}
+
+void record(Kind k)
+{
+    inHook = true;
+
+    void *frames[maxFrames];
+    int n = backtrace(frames, maxFrames);
+
+    bool found{false};
+    int claimed = std::min(nRecords.load(std::memory_order_acquire), maxRecords);
+    for (int i = 0; i < claimed && !found; ++i)
+    {
+        auto &r = records[i];
+        if (r.ready.load(std::memory_order_acquire) && sameStack(r, k, n, frames))
+        {
+            r.count.fetch_add(1, std::memory_order_relaxed);
+            found = true;
+        }
+    }
+
+    if (!found)
+    {
+        auto slot = nRecords.fetch_add(1, std::memory_order_acq_rel);
+        if (slot < maxRecords)
+        {
+            auto &r = records[slot];
+            r.kind = k;
+            r.count.store(1, std::memory_order_relaxed);
+            r.nFrames = n;
+            memcpy(r.frames, frames, n * sizeof(void *));
+            r.ready.store(true, std::memory_order_release);
+        }
+        else
+        {
+            nDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    inHook = false;
+}
+
+std::string demangleFrame(const char *sym)
+{
+    // glibc gives us "binary(mangled+0x12) [0xaddr]"
+    std::string s(sym);
+    auto open = s.find('('), plus = s.find('+', open);
+    if (open == std::string::npos || plus == std::string::npos || plus == open + 1)
+        return s;
+
+    auto mangled = s.substr(open + 1, plus - open - 1);
+    int status{0};
+    char *dm = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+    if (status != 0 || !dm)
+        return s;
+
+    std::string res = std::string(dm) + " " + s.substr(plus, s.find(')', plus) - plus);
+    free(dm);
+    return res;
+}
+} // namespace detail
+
+bool isAvailable() { return true; }
+
+void arm()
+{
+    // the first backtrace loads the unwinder, which allocates, so get that out of the way
+    void *frames[4];
+    backtrace(frames, 4);
+
+    // nothing records while disarmed, so these can be reset without racing anyone
+    int claimed = std::min(detail::nRecords.load(), detail::maxRecords);
+    for (int i = 0; i < claimed; ++i)
+        detail::records[i].ready = false;
+
+    detail::nRecords = 0;
+    detail::nDropped = 0;
+    detail::armed = true;
+}
+
+std::vector<Violation> collect()
+{
+    detail::armed = false;
+
+    std::vector<Violation> res;
+    int claimed = std::min(detail::nRecords.load(), detail::maxRecords);
+    for (int i = 0; i < claimed; ++i)
+    {
+        auto &r = detail::records[i];
+        if (!r.ready)
+            continue;
+
+        // fold in the records of any other thread which raced this one to the same stack
+        int count = r.count;
+        for (int j = i + 1; j < claimed; ++j)
+        {
+            auto &o = detail::records[j];
+            if (o.ready && detail::sameStack(o, r.kind, r.nFrames, r.frames))
+            {
+                count += o.count;
+                o.ready = false;
+            }
+        }
+
+        Violation v;
+        v.kind = detail::kindNames[r.kind];
+        v.count = count;
+
+        char **syms = backtrace_symbols(r.frames, r.nFrames);
+        // frame 0 is record() and frame 1 the hook itself
+        for (int f = 2; f < r.nFrames; ++f)
+            v.stack.push_back(syms ? detail::demangleFrame(syms[f]) : "?");
+        free(syms);
+
+        res.push_back(v);
+    }
+
+    if (detail::nDropped > 0)
+    {
+        Violation v;
+        v.kind = "dropped";
+        v.count = detail::nDropped;
+        v.stack.push_back("record table full; further distinct stacks were not kept");
+        res.push_back(v);
+    }
+    return res;
+}
+#else
+bool isAvailable() { return false; }
+void arm() {}
+std::vector<Violation> collect() { return {}; }
+#endif
+} // namespace RTSafety
+} // namespace Headless
+} // namespace Surge
+
+#if SURGE_RT_SAFETY_HOOKS
+/*
+ * The interposed symbols. Since they're defined in the executable they win over libc's for
+ * everything in the process, including the C++ runtime's operator new and std::mutex.
+ */
+using namespace Surge::Headless::RTSafety::detail;
+
+static int (*libcMutexLock)(pthread_mutex_t *){nullptr};
+__attribute__((constructor)) static void resolveMutexLock()
+{
+    libcMutexLock = (int (*)(pthread_mutex_t *))dlsym(RTLD_NEXT, "pthread_mutex_lock");
+}
+
+extern "C"
+{
+    void *malloc(size_t sz)
+    {
+        if (shouldRecord())
+            record(k_malloc);
+        return __libc_malloc(sz);
+    }
+
+    void *calloc(size_t n, size_t sz)
+    {
+        if (shouldRecord())
+            record(k_malloc);
+        return __libc_calloc(n, sz);
+    }
+
+    void *realloc(void *p, size_t sz)
+    {
+        if (shouldRecord())
+            record(k_malloc);
+        return __libc_realloc(p, sz);
+    }
+
+    void *memalign(size_t align, size_t sz)
+    {
+        if (shouldRecord())
+            record(k_malloc);
+        return __libc_memalign(align, sz);
+    }
+
+    void *aligned_alloc(size_t align, size_t sz) { return memalign(align, sz); }
+
+    int posix_memalign(void **res, size_t align, size_t sz)
+    {
+        auto p = memalign(align, sz);
+        if (!p)
+            return ENOMEM;
+        *res = p;
+        return 0;
+    }
+
+    void free(void *p)
+    {
+        if (p && shouldRecord())
+            record(k_free);
+        __libc_free(p);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t *m)
+    {
+        if (shouldRecord())
+        {
+            // an uncontended lock is still a hazard, but a wait is the one that bites
+            if (pthread_mutex_trylock(m) == 0)
+            {
+                record(k_lock);
+                return 0;
+            }
+            record(k_wait);
+        }
+
+        if (libcMutexLock)
+            return libcMutexLock(m);
+
+        // only before our constructor has run, so there's nobody to contend with anyway
+        int res;
+        while ((res = pthread_mutex_trylock(m)) == EBUSY)
+            sched_yield();
+        return res;
+    }
+}
+#endif
@@ -0,0 +1,64 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2023, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_SURGE_TESTRUNNER_RTSAFETYDETECTOR_H
+#define SURGE_SRC_SURGE_TESTRUNNER_RTSAFETYDETECTOR_H
+
+#include <string>
+#include <vector>
+
+namespace Surge
+{
+namespace Headless
+{
+/*
+ * The real time safety detector. In a build configured with SURGE_RT_SAFETY_CHECKS the test
+ * runner interposes malloc and friends and pthread_mutex_lock, and while the calling thread is
+ * doing audio thread work (process(), note and controller events, external parameter changes
+ * and WorkerPool tasks; see Surge::Debug::AudioThreadScope) records the call stack of every
+ * allocation, free and lock it makes. Recording never allocates; the stacks are
+ * symbolized when collected, off the audio thread.
+ *
+ * Interposition needs glibc, so on other platforms (or without the build flag) isAvailable()
+ * is false and nothing is ever recorded.
+ */
+namespace RTSafety
+{
+struct Violation
+{
+    std::string kind; // "malloc", "free", "mutex lock", "mutex wait" ...
+    int count{0};     // how many times this exact stack was hit
+    std::vector<std::string> stack;
+};
+
+bool isAvailable();
+
+// Start recording. Any previous records are discarded
+void arm();
+
+// Stop recording and return the distinct offending stacks seen since arm()
+std::vector<Violation> collect();
+} // namespace RTSafety
+} // namespace Headless
+} // namespace Surge
+
+#endif // SURGE_SRC_SURGE_TESTRUNNER_RTSAFETYDETECTOR_H
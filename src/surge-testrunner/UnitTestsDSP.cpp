@@ -20,7 +20,9 @@
  * https://github.com/surge-synthesizer/surge
  */
 #include <iostream>
+#include <chrono>
 #include <algorithm>
+#include <random>
 
 #include "HeadlessUtils.h"
 #include "Player.h"
@@ -32,6 +34,9 @@
 #include "samplerate.h"
 
 #include "SSEComplex.h"
+#include "PolyphaseResampler.h"
+#include "PartitionedConvolver.h"
+#include "SurgeMemoryPools.h"
 #include <complex>
 #include "sst/basic-blocks/mechanics/simd-ops.h"
 
@@ -465,6 +470,36 @@ TEST_CASE("Every Oscillator Plays", "[dsp]")
     }
 }
 
+TEST_CASE("Twist Voices Come From The Pool", "[dsp]")
+{
+    auto surge = Surge::Headless::createSurge(48000, true);
+    surge->storage.getPatch().scene[0].osc[0].queue_type = ot_twist;
+    for (int q = 0; q < 10; ++q)
+        surge->process();
+
+    auto pools = surge->storage.memoryPools.get();
+    auto before = pools->audioThreadAllocations();
+
+    // a fast arpeggio, which used to build a plaits voice and two resamplers per note
+    float sumAbsOut = 0;
+    for (int n = 0; n < 32; ++n)
+    {
+        surge->playNote(0, 48 + (n * 7) % 24, 127, 0);
+        for (int q = 0; q < 4; ++q)
+        {
+            surge->process();
+            for (int s = 0; s < BLOCK_SIZE; ++s)
+                sumAbsOut += fabs(surge->output[0][s]);
+        }
+        surge->releaseNote(0, 48 + (n * 7) % 24, 0);
+    }
+    for (int q = 0; q < 500; ++q)
+        surge->process();
+
+    REQUIRE(sumAbsOut > 1);
+    REQUIRE(pools->audioThreadAllocations() == before);
+}
+
 TEST_CASE("Untuned is 2^x", "[dsp]")
 {
     auto surge = Surge::Headless::createSurge(44100);
@@ -769,4 +804,315 @@ TEST_CASE("Reverb1 White Noise Blast", "[dsp]")
         }
         since++;
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Parallel Scenes Match Serial Scenes", "[dsp]")
+{
+    /*
+     * Both scenes play noise, which draws from the RNG every sample, so the scenes rendering
+     * at the same time on two threads would show up as different output here.
+     */
+    auto render = [](bool parallel) {
+        auto surge = Surge::Headless::createSurge(44100);
+        surge->storage.getPatch().scenemode.val.i = sm_dual;
+        surge->setParallelSceneRendering(parallel);
+
+        for (int s = 0; s < n_scenes; ++s)
+        {
+            auto &scene = surge->storage.getPatch().scene[s];
+            scene.mute_noise.val.b = false;
+            scene.level_noise.val.f = 0.8f;
+            scene.drift.val.f = 0.5f;
+        }
+
+        surge->seedRNG(2112);
+        surge->playNote(0, 60, 127, 0);
+        surge->playNote(0, 64, 127, 0);
+
+        std::vector<float> res;
+        for (int i = 0; i < 300; ++i)
+        {
+            if (i == 200)
+                surge->releaseNote(0, 60, 0);
+            surge->process();
+            res.insert(res.end(), surge->output[0], surge->output[0] + BLOCK_SIZE);
+            res.insert(res.end(), surge->output[1], surge->output[1] + BLOCK_SIZE);
+        }
+        return res;
+    };
+
+    auto serial = render(false);
+    auto parallel = render(true);
+
+    REQUIRE(serial.size() == parallel.size());
+    for (size_t i = 0; i < serial.size(); ++i)
+    {
+        INFO("Sample " << i);
+        REQUIRE(serial[i] == parallel[i]);
+    }
+}
+
+TEST_CASE("Scene Noise Is Uncorrelated", "[dsp]")
+{
+    /*
+     * Each scene's generator is seeded once, apart from the other, and then runs free. Seeds
+     * handed out next to each other, or a reseed every block, show up here as correlation
+     * between the scenes or between neighbouring blocks of the same scene.
+     */
+    auto surge = Surge::Headless::createSurge(44100);
+    auto &patch = surge->storage.getPatch();
+    patch.scenemode.val.i = sm_dual;
+    patch.fx_bypass.val.i = fxb_no_fx;
+
+    for (int s = 0; s < n_scenes; ++s)
+    {
+        auto &scene = patch.scene[s];
+        scene.mute_o1.val.b = true;
+        scene.mute_o2.val.b = true;
+        scene.mute_o3.val.b = true;
+        scene.mute_noise.val.b = false;
+        scene.level_noise.val.f = 1.f;
+        scene.noise_colour.val.f = 0.f;
+        scene.drift.val.f = 0.f;
+        scene.filterunit[0].type.val.i = sst::filters::fut_none;
+        scene.filterunit[1].type.val.i = sst::filters::fut_none;
+        scene.wsunit.type.val.i = (int)sst::waveshapers::WaveshaperType::wst_none;
+    }
+
+    surge->seedRNG(2112);
+    surge->playNote(0, 60, 127, 0);
+
+    // let the envelopes settle before listening
+    for (int i = 0; i < 50; ++i)
+        surge->process();
+
+    constexpr int nBlocks = 400;
+    std::vector<float> out[n_scenes];
+    for (int i = 0; i < nBlocks; ++i)
+    {
+        surge->process();
+        for (int s = 0; s < n_scenes; ++s)
+        {
+            auto *so = surge->sceneout[s][0];
+            out[s].insert(out[s].end(), so, so + BLOCK_SIZE);
+        }
+    }
+
+    // b is compared lag samples later than a
+    auto correlation = [](const std::vector<float> &a, const std::vector<float> &b, int lag) {
+        double sa = 0, sb = 0, saa = 0, sbb = 0, sab = 0;
+        auto n = a.size() - lag;
+        for (size_t i = 0; i < n; ++i)
+        {
+            double x = a[i], y = b[i + lag];
+            sa += x;
+            sb += y;
+            saa += x * x;
+            sbb += y * y;
+            sab += x * y;
+        }
+        auto cov = sab / n - (sa / n) * (sb / n);
+        auto va = saa / n - (sa / n) * (sa / n), vb = sbb / n - (sb / n) * (sb / n);
+        REQUIRE(va > 0);
+        REQUIRE(vb > 0);
+        return cov / std::sqrt(va * vb);
+    };
+
+    // with nBlocks * BLOCK_SIZE samples, independent noise stays well inside this
+    constexpr double maxCorrelation = 0.1;
+
+    SECTION("Scene To Scene")
+    {
+        for (int lag = 0; lag < 4; ++lag)
+        {
+            INFO("Lag " << lag);
+            REQUIRE(std::fabs(correlation(out[0], out[1], lag)) < maxCorrelation);
+            REQUIRE(std::fabs(correlation(out[1], out[0], lag)) < maxCorrelation);
+        }
+    }
+
+    SECTION("Block To Block")
+    {
+        for (int s = 0; s < n_scenes; ++s)
+        {
+            INFO("Scene " << s);
+            REQUIRE(std::fabs(correlation(out[s], out[s], BLOCK_SIZE)) < maxCorrelation);
+        }
+    }
+}
+
+TEST_CASE("Polyphase Resampler", "[dsp]")
+{
+    using Surge::DSP::PolyphaseResampler;
+
+    REQUIRE(PolyphaseResampler::supports(44100, 32000));
+    REQUIRE(PolyphaseResampler::supports(32000, 96000));
+    REQUIRE(!PolyphaseResampler::supports(44100.5, 32000));
+    REQUIRE(!PolyphaseResampler::supports(44101, 32000));
+
+    for (auto rates : {std::make_pair(44100, 32000), std::make_pair(48000, 32000),
+                       std::make_pair(96000, 32000), std::make_pair(32000, 44100),
+                       std::make_pair(32000, 48000)})
+    {
+        DYNAMIC_SECTION("Sines from " << rates.first << " to " << rates.second)
+        {
+            auto inR = rates.first, outR = rates.second;
+            auto rs = PolyphaseResampler(inR, outR);
+
+            std::vector<float> iL(inR), iR(inR), oL(outR + 64), oR(outR + 64);
+            for (int i = 0; i < inR; ++i)
+            {
+                iL[i] = sin(2.0 * M_PI * 1000.0 * i / inR);
+                iR[i] = 0.5 * cos(2.0 * M_PI * 1500.0 * i / inR);
+            }
+
+            int nOut = 0;
+            for (int i = 0; i < inR; i += BLOCK_SIZE)
+            {
+                auto n = std::min(BLOCK_SIZE, inR - i);
+                auto gen = rs.process(&iL[i], &iR[i], n, &oL[nOut], &oR[nOut]);
+                REQUIRE(gen <= rs.maxOutputFrames(n));
+                nOut += gen;
+            }
+            REQUIRE(std::abs(nOut - outR) <= 1);
+
+            // one second in gives one second out, running latency() frames behind
+            for (int m = 1000; m < nOut - 100; ++m)
+            {
+                auto t = (m - rs.latency()) / outR;
+                INFO("Sample " << m);
+                REQUIRE(oL[m] == Approx(sin(2.0 * M_PI * 1000.0 * t)).margin(1e-3));
+                REQUIRE(oR[m] == Approx(0.5 * cos(2.0 * M_PI * 1500.0 * t)).margin(1e-3));
+            }
+        }
+    }
+
+    SECTION("Rejects Aliases When Downsampling")
+    {
+        auto rs = PolyphaseResampler(48000, 32000);
+        std::vector<float> i(48000), o(32001);
+        for (int s = 0; s < 48000; ++s)
+            i[s] = sin(2.0 * M_PI * 20000.0 * s / 48000);
+
+        auto n = rs.process(i.data(), i.data(), 48000, o.data(), o.data());
+        float mx = 0;
+        for (int s = 1000; s < n; ++s)
+            mx = std::max(mx, std::fabs(o[s]));
+        REQUIRE(mx < 1e-3);
+    }
+}
+
+TEST_CASE("Polyphase Resampler Benchmark", "[dsp][.]")
+{
+    // Nimbus's round trip to its 32k processor, a block at a time, against libsamplerate
+    static constexpr int nBlocks = 100000;
+
+    for (auto hostR : {44100, 48000, 96000})
+    {
+        std::vector<float> iL(BLOCK_SIZE), iR(BLOCK_SIZE);
+        for (int i = 0; i < BLOCK_SIZE; ++i)
+        {
+            iL[i] = sin(2.0 * M_PI * 440.0 * i / hostR);
+            iR[i] = cos(2.0 * M_PI * 440.0 * i / hostR);
+        }
+
+        float eL[BLOCK_SIZE << 3], eR[BLOCK_SIZE << 3], oL[BLOCK_SIZE << 3], oR[BLOCK_SIZE << 3];
+        auto to = Surge::DSP::PolyphaseResampler(hostR, 32000);
+        auto from = Surge::DSP::PolyphaseResampler(32000, hostR);
+
+        auto st = std::chrono::high_resolution_clock::now();
+        for (int b = 0; b < nBlocks; ++b)
+        {
+            auto n = to.process(iL.data(), iR.data(), BLOCK_SIZE, eL, eR);
+            from.process(eL, eR, n, oL, oR);
+        }
+        auto polyNs = std::chrono::duration<double, std::nano>(
+                          std::chrono::high_resolution_clock::now() - st)
+                          .count();
+
+        // libsamplerate wants interleaved frames, as Nimbus's fallback path gives it
+        float inI[BLOCK_SIZE][2], eI[BLOCK_SIZE << 3][2], oI[BLOCK_SIZE << 3][2];
+        for (int i = 0; i < BLOCK_SIZE; ++i)
+        {
+            inI[i][0] = iL[i];
+            inI[i][1] = iR[i];
+        }
+
+        int error;
+        auto srcTo = src_new(SRC_SINC_FASTEST, 2, &error);
+        auto srcFrom = src_new(SRC_SINC_FASTEST, 2, &error);
+        REQUIRE(srcTo);
+        REQUIRE(srcFrom);
+
+        st = std::chrono::high_resolution_clock::now();
+        for (int b = 0; b < nBlocks; ++b)
+        {
+            SRC_DATA d;
+            d.end_of_input = 0;
+            d.src_ratio = 32000.0 / hostR;
+            d.data_in = &inI[0][0];
+            d.data_out = &eI[0][0];
+            d.input_frames = BLOCK_SIZE;
+            d.output_frames = BLOCK_SIZE << 3;
+            src_process(srcTo, &d);
+
+            SRC_DATA o;
+            o.end_of_input = 0;
+            o.src_ratio = hostR / 32000.0;
+            o.data_in = &eI[0][0];
+            o.data_out = &oI[0][0];
+            o.input_frames = d.output_frames_gen;
+            o.output_frames = BLOCK_SIZE << 3;
+            src_process(srcFrom, &o);
+        }
+        auto srcNs = std::chrono::duration<double, std::nano>(
+                         std::chrono::high_resolution_clock::now() - st)
+                         .count();
+
+        src_delete(srcTo);
+        src_delete(srcFrom);
+
+        std::cout << hostR << " <-> 32000: polyphase " << polyNs / nBlocks
+                  << " ns/block, libsamplerate " << srcNs / nBlocks << " ns/block ("
+                  << srcNs / polyNs << "x)" << std::endl;
+    }
+}
+
+TEST_CASE("Partitioned Convolver", "[dsp]")
+{
+    // lengths which stop in the head, the 1024 stage and the 8192 stage
+    for (auto len : {1, 300, 5000, 20000})
+    {
+        DYNAMIC_SECTION("Matches Direct Convolution With IR Length " << len)
+        {
+            std::minstd_rand gen(len);
+            std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+            std::vector<float> ir(len);
+            for (int i = 0; i < len; ++i)
+                ir[i] = dist(gen) * exp(-3.0 * i / len);
+
+            auto conv = Surge::DSP::PartitionedConvolver(ir.data(), len, BLOCK_SIZE);
+            REQUIRE(conv.irLength() == len);
+
+            int n = ((len + 12000) / BLOCK_SIZE + 1) * BLOCK_SIZE;
+            std::vector<float> in(n), out(n);
+            for (auto &x : in)
+                x = dist(gen);
+
+            for (int i = 0; i < n; i += BLOCK_SIZE)
+                conv.process(&in[i], &out[i]);
+
+            auto lat = conv.latency();
+            for (int m = lat; m < n; m += 7)
+            {
+                double ref = 0;
+                for (int k = 0; k < len && k <= m - lat; ++k)
+                    ref += ir[k] * in[m - lat - k];
+
+                INFO("Sample " << m);
+                REQUIRE(out[m] == Approx(ref).margin(1e-3));
+            }
+        }
+    }
+}
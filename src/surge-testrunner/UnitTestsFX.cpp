@@ -23,6 +23,8 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <random>
+#include <thread>
 
 #include "HeadlessUtils.h"
 #include "Player.h"
@@ -32,6 +34,10 @@
 
 #include "UnitTestUtilities.h"
 #include "AudioInputEffect.h"
+#include "ConvolutionEffect.h"
+#include "VocoderEffect.h"
+#include "FFTVocoder.h"
+#include "airwindows/AirWindowsSIMD.h"
 
 using namespace Surge::Test;
 
@@ -116,6 +122,55 @@ TEST_CASE("Airwindows Loud", "[fx]")
     }
 }
 
+TEST_CASE("Airwindows SIMD Kernels Match Scalar", "[fx]")
+{
+    auto reg = AirWinBaseClass::pluginRegistry();
+
+    for (const auto &name : Surge::AirWindows::simdKernelNames())
+    {
+        auto r = std::find_if(reg.begin(), reg.end(), [&](auto &e) { return e.name == name; });
+        REQUIRE(r != reg.end());
+
+        for (auto p0 : {0.f, 0.1f, 0.2f, 0.5f, 0.8f, 1.f})
+        {
+            DYNAMIC_SECTION("Airwindows " << name << " with first param " << p0)
+            {
+                auto scalar = r->create(r->id, 48000, 2);
+                auto kernel = Surge::AirWindows::createSIMDKernel(name);
+                REQUIRE(kernel);
+
+                float params[] = {p0, 0.3f, 0.9f, 0.8f};
+                for (int i = 0; i < scalar->paramCount && i < 4; ++i)
+                    scalar->setParameter(i, params[i]);
+
+                // noise past full scale so the clippers and folders all get a workout
+                std::default_random_engine gen(2112);
+                std::uniform_real_distribution<float> noise(-1.2f, 1.2f);
+                float inL[BLOCK_SIZE], inR[BLOCK_SIZE];
+                float sL[BLOCK_SIZE], sR[BLOCK_SIZE], vL[BLOCK_SIZE], vR[BLOCK_SIZE];
+                float *in[2] = {inL, inR}, *sOut[2] = {sL, sR}, *vOut[2] = {vL, vR};
+
+                for (int b = 0; b < 1000; ++b)
+                {
+                    for (int i = 0; i < BLOCK_SIZE; ++i)
+                    {
+                        inL[i] = noise(gen);
+                        inR[i] = 0.3f * noise(gen);
+                    }
+                    scalar->processReplacing(in, sOut, BLOCK_SIZE);
+                    kernel->process(scalar.get(), in, vOut, BLOCK_SIZE);
+
+                    for (int i = 0; i < BLOCK_SIZE; ++i)
+                    {
+                        REQUIRE(vL[i] == Approx(sL[i]).margin(1e-6));
+                        REQUIRE(vR[i] == Approx(sR[i]).margin(1e-6));
+                    }
+                }
+            }
+        }
+    }
+}
+
 TEST_CASE("Move FX With Assigned Modulation", "[fx]")
 {
     auto step = [](auto surge) {
@@ -276,6 +331,131 @@ TEST_CASE("Move FX With Assigned Modulation", "[fx]")
     }
 }
 
+TEST_CASE("FX Sleep Once Their Tail Has Decayed", "[fx]")
+{
+    auto setupSlotZero = [](int type) {
+        auto surge = Surge::Headless::createSurge(44100);
+        for (int i = 0; i < 10; ++i)
+            surge->process();
+
+        auto *pt = &(surge->storage.getPatch().fx[0].type);
+        auto did = surge->idForParameter(pt);
+        surge->setParameter01(did, 1.f * type / (pt->val_max.i - pt->val_min.i), false);
+        for (int i = 0; i < 10; ++i)
+            surge->process();
+        REQUIRE(surge->fx[0]);
+        return surge;
+    };
+    auto blocksFor = [](float seconds) { return (int)(seconds * 44100 / BLOCK_SIZE); };
+
+    SECTION("Combulator Sleeps And Wakes")
+    {
+        // combulator can't say how long it rings for, so it used to run forever
+        auto surge = setupSlotZero(fxt_combulator);
+        REQUIRE(surge->fx[0]->get_ringout_decay() < 0);
+
+        surge->playNote(0, 60, 127, 0);
+        for (int i = 0; i < blocksFor(0.5); ++i)
+            surge->process();
+        REQUIRE(!surge->fx[0]->isSleeping());
+
+        surge->releaseNote(0, 60, 0);
+        for (int i = 0; i < blocksFor(20); ++i)
+            surge->process();
+        REQUIRE(surge->fx[0]->isSleeping());
+
+        // and asleep, a silent scene stays silent
+        for (int i = 0; i < 10; ++i)
+        {
+            surge->process();
+            for (int s = 0; s < BLOCK_SIZE; ++s)
+                REQUIRE(fabs(surge->output[0][s]) < 1e-4);
+        }
+
+        surge->playNote(0, 60, 127, 0);
+        float rms = 0.f;
+        for (int i = 0; i < 20; ++i)
+        {
+            surge->process();
+            for (int s = 0; s < BLOCK_SIZE; ++s)
+                rms += surge->output[0][s] * surge->output[0][s];
+        }
+        REQUIRE(!surge->fx[0]->isSleeping());
+        REQUIRE(rms > 1e-3);
+    }
+
+    SECTION("Audio Input Never Sleeps")
+    {
+        auto surge = setupSlotZero(fxt_audio_input);
+        for (int i = 0; i < blocksFor(2); ++i)
+            surge->process();
+        REQUIRE(!surge->fx[0]->isSleeping());
+    }
+}
+
+TEST_CASE("Parallel FX Match Serial FX", "[fx]")
+{
+    /*
+     * Fill both insert chains and all the sends, with some of the effects on the shared RNG,
+     * and check the parallel graph renders the same bits as the serial one. Both renders seed
+     * the RNGs the same way so the noise matches too. The two Airwindows slots run Tape Dust,
+     * which draws from the global rand() every sample, in different chains.
+     */
+    auto reg = AirWinBaseClass::pluginRegistry();
+    auto tapeDust = std::find_if(reg.begin(), reg.end(),
+                                 [](auto &e) { return e.name == "Tape Dust"; }) -
+                    reg.begin();
+    REQUIRE(tapeDust < (int)reg.size());
+
+    auto render = [tapeDust](bool parallel) {
+        auto surge = Surge::Headless::createSurge(44100);
+        surge->storage.getPatch().scenemode.val.i = sm_dual;
+        surge->setParallelFXRendering(parallel);
+
+        setFX(surge, fxslot_ains1, fxt_reverb2);
+        setFX(surge, fxslot_ains2, fxt_combulator);
+        setFX(surge, fxslot_bins1, fxt_distortion);
+        setFX(surge, fxslot_bins2, fxt_airwindows);
+        setFX(surge, fxslot_send1, fxt_delay);
+        setFX(surge, fxslot_send2, fxt_reverb2);
+        setFX(surge, fxslot_send3, fxt_airwindows);
+        setFX(surge, fxslot_send4, fxt_combulator);
+        for (auto slot : {fxslot_bins2, fxslot_send3})
+            surge->storage.getPatch().fx[slot].p[0].val.i = tapeDust;
+        for (int i = 0; i < 10; ++i)
+            surge->process();
+        for (int s = 0; s < n_scenes; ++s)
+            for (int i = 0; i < n_send_slots; ++i)
+                surge->storage.getPatch().scene[s].send_level[i].val.f = 0.5f;
+
+        surge->seedRNG(2112);
+        srand(2112);
+        surge->playNote(0, 60, 127, 0);
+        surge->playNote(0, 67, 127, 0);
+
+        std::vector<float> res;
+        for (int i = 0; i < 500; ++i)
+        {
+            if (i == 300)
+                surge->releaseNote(0, 60, 0);
+            surge->process();
+            res.insert(res.end(), surge->output[0], surge->output[0] + BLOCK_SIZE);
+            res.insert(res.end(), surge->output[1], surge->output[1] + BLOCK_SIZE);
+        }
+        return res;
+    };
+
+    auto serial = render(false);
+    auto parallel = render(true);
+
+    REQUIRE(serial.size() == parallel.size());
+    for (size_t i = 0; i < serial.size(); ++i)
+    {
+        INFO("Sample " << i);
+        REQUIRE(serial[i] == parallel[i]);
+    }
+}
+
 TEST_CASE("Reverb 2 at High Sample Rate", "[fx]")
 {
     SECTION("Make Reverb 2")
@@ -414,6 +594,308 @@ TEST_CASE("Nimbus at High Sample Rate", "[fx]")
     }
 }
 
+TEST_CASE("Vocoder FFT Mode", "[fx]")
+{
+    for (auto sr : {44100, 96000})
+    {
+        for (auto bands : {4, 12, 20})
+        {
+            DYNAMIC_SECTION("FFT Vocoder at " << sr << " with band param " << bands)
+            {
+                auto surge = Surge::Headless::createSurge(sr);
+                REQUIRE(surge);
+                surge->process_input = true;
+
+                Surge::Test::setFX(surge, 0, fxt_vocoder);
+
+                auto &nb = surge->storage.getPatch().fx[0].p[VocoderEffect::voc_num_bands];
+                nb.deform_type = VocoderEffect::ve_fft;
+                nb.val.i = bands;
+                REQUIRE(nb.get_display() ==
+                        std::to_string(FFTVocoder::bandsForParam(bands)) + " bands");
+
+                // noise on the audio input as the modulator, a chord as the carrier
+                std::default_random_engine gen(2112);
+                std::uniform_real_distribution<float> noise(-0.3f, 0.3f);
+
+                for (auto n : {48, 55, 60})
+                    surge->playNote(0, n, 127, 0);
+
+                auto maxAmp = 0.f;
+                for (int i = 0; i < sr / BLOCK_SIZE; ++i)
+                {
+                    for (int s = 0; s < BLOCK_SIZE; ++s)
+                    {
+                        surge->input[0][s] = noise(gen);
+                        surge->input[1][s] = noise(gen);
+                    }
+                    surge->process();
+
+                    for (int s = 0; s < BLOCK_SIZE; ++s)
+                    {
+                        REQUIRE(std::isfinite(surge->output[0][s]));
+                        REQUIRE(std::isfinite(surge->output[1][s]));
+                        maxAmp = std::max(maxAmp, std::fabs(surge->output[0][s]));
+                    }
+                }
+                REQUIRE(maxAmp > 0.01);
+            }
+        }
+    }
+
+    SECTION("Both Engines Follow The Modulator Spectrum")
+    {
+        /*
+         * Vocode the same chord with dark and with bright noise and compare the output energy
+         * below and above 1kHz. Each engine has to move that balance the way the modulator
+         * does, and the two have to agree on the direction.
+         */
+        auto lowToHigh = [](int engine, bool darkModulator) {
+            auto sr = 44100;
+            auto surge = Surge::Headless::createSurge(sr);
+            REQUIRE(surge);
+            surge->seedRNG(2112);
+            surge->process_input = true;
+
+            Surge::Test::setFX(surge, 0, fxt_vocoder);
+
+            auto &nb = surge->storage.getPatch().fx[0].p[VocoderEffect::voc_num_bands];
+            nb.deform_type = engine;
+            nb.val.i = 20;
+
+            std::default_random_engine gen(2112);
+            std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+
+            // two pole one-pole cascades, lowpassed at 300Hz or highpassed at 3kHz
+            auto modA = 1.f - std::exp(-2.f * M_PI * (darkModulator ? 300.f : 3000.f) / sr);
+            auto splitA = 1.f - std::exp(-2.f * M_PI * 1000.f / sr);
+            float m1{0.f}, m2{0.f}, split1{0.f}, split2{0.f};
+            double lowE{0}, highE{0};
+
+            for (auto n : {48, 55, 60})
+                surge->playNote(0, n, 127, 0);
+
+            for (int i = 0; i < sr / BLOCK_SIZE; ++i)
+            {
+                for (int s = 0; s < BLOCK_SIZE; ++s)
+                {
+                    auto x = noise(gen);
+                    m1 += modA * (x - m1);
+                    m2 += modA * (m1 - m2);
+                    auto m = darkModulator ? m2 : x - m2;
+                    surge->input[0][s] = m;
+                    surge->input[1][s] = m;
+                }
+                surge->process();
+
+                for (int s = 0; s < BLOCK_SIZE; ++s)
+                {
+                    auto y = surge->output[0][s];
+                    split1 += splitA * (y - split1);
+                    split2 += splitA * (split1 - split2);
+
+                    // skip the first quarter second, which covers the FFT latency
+                    if (i > sr / BLOCK_SIZE / 4)
+                    {
+                        lowE += split2 * split2;
+                        highE += (y - split2) * (y - split2);
+                    }
+                }
+            }
+
+            REQUIRE(lowE > 0);
+            REQUIRE(highE > 0);
+            return lowE / highE;
+        };
+
+        for (auto engine : {VocoderEffect::ve_filterbank, VocoderEffect::ve_fft})
+        {
+            INFO("Vocoder engine " << engine);
+            auto dark = lowToHigh(engine, true);
+            auto bright = lowToHigh(engine, false);
+            REQUIRE(dark > 4 * bright);
+        }
+
+        auto shiftIIR = lowToHigh(VocoderEffect::ve_filterbank, true) /
+                        lowToHigh(VocoderEffect::ve_filterbank, false);
+        auto shiftFFT =
+            lowToHigh(VocoderEffect::ve_fft, true) / lowToHigh(VocoderEffect::ve_fft, false);
+
+        // the band layouts differ, so the engines only have to land within 20dB of each other
+        REQUIRE(std::fabs(std::log10(shiftIIR / shiftFFT)) < 2);
+    }
+
+    SECTION("Switching Engines Starts From Silence")
+    {
+        auto surge = Surge::Headless::createSurge(44100);
+        REQUIRE(surge);
+        surge->process_input = true;
+
+        Surge::Test::setFX(surge, 0, fxt_vocoder);
+        auto &nb = surge->storage.getPatch().fx[0].p[VocoderEffect::voc_num_bands];
+
+        std::default_random_engine gen(2112);
+        std::uniform_real_distribution<float> noise(-0.3f, 0.3f);
+
+        for (auto n : {48, 55, 60})
+            surge->playNote(0, n, 127, 0);
+
+        auto run = [&](int blocks) {
+            for (int i = 0; i < blocks; ++i)
+            {
+                for (int s = 0; s < BLOCK_SIZE; ++s)
+                {
+                    surge->input[0][s] = noise(gen);
+                    surge->input[1][s] = noise(gen);
+                }
+                surge->process();
+            }
+        };
+
+        auto silentAfterSwitch = [&](int engine) {
+            for (int s = 0; s < BLOCK_SIZE; ++s)
+            {
+                surge->input[0][s] = 0.f;
+                surge->input[1][s] = 0.f;
+            }
+
+            nb.deform_type = engine;
+
+            auto maxAmp = 0.f;
+            for (int i = 0; i < 50; ++i)
+            {
+                surge->process();
+                for (int s = 0; s < BLOCK_SIZE; ++s)
+                    maxAmp = std::max(maxAmp, std::fabs(surge->output[0][s]));
+            }
+            return maxAmp;
+        };
+
+        /*
+         * Let each engine build up envelopes on live input, then switch with the modulator
+         * silenced. Whatever the engine we switch to had left over from its last run must
+         * not leak through, so the chord stays gated.
+         */
+        for (auto engine : {VocoderEffect::ve_fft, VocoderEffect::ve_filterbank,
+                            VocoderEffect::ve_fft, VocoderEffect::ve_filterbank})
+        {
+            INFO("Switching to engine " << engine);
+            nb.deform_type = engine;
+            run(200);
+            nb.deform_type = 1 - engine;
+            run(200);
+            REQUIRE(silentAfterSwitch(engine) < 1e-3);
+        }
+    }
+}
+
+TEST_CASE("Convolution FX", "[fx]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    Surge::Test::setFX(surge, 0, fxt_convolution);
+    auto *fx = dynamic_cast<ConvolutionEffect *>(surge->fx[0].get());
+    REQUIRE(fx);
+
+    auto &fxs = surge->storage.getPatch().fx[0];
+    fxs.p[ConvolutionEffect::cnv_mix].val.f = 1.f;
+
+    auto waitForLoad = [&]() {
+        for (int i = 0; i < 5000 && !fx->isLoaded(); ++i)
+        {
+            surge->process();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        REQUIRE(fx->isLoaded());
+        fx->init();
+        fx->suspend();
+    };
+
+    // pffft can't go below 16 sample partitions, which costs the smallest block sizes latency
+    auto lat = std::max(0, 16 - BLOCK_SIZE);
+
+    auto impulseResponse = [&](int n, std::vector<float> &L, std::vector<float> &R) {
+        L.assign(n, 0.f);
+        R.assign(n, 0.f);
+        L[0] = R[0] = 1.f;
+        for (int i = 0; i < n; i += BLOCK_SIZE)
+            fx->process(&L[i], &R[i]);
+    };
+
+    SECTION("Plays The Loaded IR")
+    {
+        auto fn = std::string("resources/test-data/wav/SQUARE-C2.wav");
+        std::vector<std::vector<float>> ch;
+        int rate;
+        REQUIRE(surge->storage.load_wav_channels(string_to_path(fn), ch, rate, "Test"));
+        REQUIRE(ch.size() == 2);
+        REQUIRE(rate == 44100);
+
+        surge->setFxFilePath(0, fn);
+        REQUIRE(fxs.file_path == fn);
+        waitForLoad();
+
+        double e0 = 0, e1 = 0;
+        for (int i = 0; i < ch[0].size(); ++i)
+        {
+            e0 += ch[0][i] * ch[0][i];
+            e1 += ch[1][i] * ch[1][i];
+        }
+        auto norm = 1.0 / sqrt(std::max(e0, e1));
+
+        std::vector<float> L, R;
+        impulseResponse(8192, L, R);
+        for (int i = 0; i < ch[0].size(); ++i)
+        {
+            INFO("Sample " << i);
+            REQUIRE(L[i + lat] == Approx(ch[0][i] * norm).margin(1e-4));
+            REQUIRE(R[i + lat] == Approx(ch[1][i] * norm).margin(1e-4));
+        }
+        for (int i = ch[0].size() + lat; i < L.size(); ++i)
+            REQUIRE(L[i] == Approx(0).margin(1e-4));
+
+        SECTION("And Clears It")
+        {
+            surge->setFxFilePath(0, "");
+            waitForLoad();
+
+            impulseResponse(1024, L, R);
+            for (auto v : L)
+                REQUIRE(v == 0.f);
+        }
+    }
+
+    SECTION("Keeps The Last IR When A File Fails")
+    {
+        surge->setFxFilePath(0, "resources/test-data/wav/SQUARE-C2.wav");
+        waitForLoad();
+        surge->setFxFilePath(0, "resources/test-data/wav/does-not-exist.wav");
+        waitForLoad();
+
+        std::vector<float> L, R;
+        impulseResponse(1024, L, R);
+        REQUIRE(std::fabs(L[lat]) > 0.01);
+    }
+
+    SECTION("A Respawned Effect Picks Up The Slot's IR")
+    {
+        // tear the effect down while its load is still in flight, then bring a new one up
+        surge->setFxFilePath(0, "resources/test-data/wav/SQUARE-C2.wav");
+        Surge::Test::setFX(surge, 0, fxt_off);
+        Surge::Test::setFX(surge, 0, fxt_convolution);
+
+        fx = dynamic_cast<ConvolutionEffect *>(surge->fx[0].get());
+        REQUIRE(fx);
+        fxs.p[ConvolutionEffect::cnv_mix].val.f = 1.f;
+        waitForLoad();
+
+        std::vector<float> L, R;
+        impulseResponse(1024, L, R);
+        REQUIRE(std::fabs(L[lat]) > 0.01);
+    }
+}
+
 TEST_CASE("Scenes Output Data", "[fx]")
 {
     SECTION("Providing data")
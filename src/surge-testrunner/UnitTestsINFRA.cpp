@@ -25,6 +25,7 @@
 #include "HeadlessUtils.h"
 #include "BiquadFilter.h"
 #include "MemoryPool.h"
+#include "ActiveVoiceList.h"
 
 #include "sst/plugininfra/strnatcmp.h"
 
@@ -180,6 +181,161 @@ TEST_CASE("Memory Pool Works", "[infra]")
         REQUIRE(CountAlloc<3>::alloc == 160);
         REQUIRE(CountAlloc<3>::ct == 0);
     }
+
+    SECTION("Background Refill Keeps The Audio Thread From Allocating")
+    {
+        {
+            auto pool = std::make_unique<Surge::Memory::MemoryPool<CountAlloc<4>, 8, 4, 500>>();
+            int wakes = 0;
+            pool->enableBackgroundRefill(
+                16, 64, []() { return new CountAlloc<4>(); }, [&wakes]() { wakes++; });
+            // starting below the low watermark asks for a refill straight away
+            REQUIRE(wakes == 1);
+
+            std::deque<CountAlloc<4> *> tmp;
+            for (int round = 0; round < 10; ++round)
+            {
+                // stand in for the refill thread, which only runs when woken
+                if (wakes > 0)
+                    pool->backgroundRefill();
+                wakes = 0;
+                for (int i = 0; i < 20; ++i)
+                    tmp.push_back(pool->getItem());
+                // and is woken at most once per refill however far a block drains the pool
+                REQUIRE(wakes <= 1);
+            }
+            REQUIRE(pool->audioThreadAllocations == 0);
+
+            // returns past the high watermark go back to be freed off thread
+            for (auto *q : tmp)
+                pool->returnItem(q);
+            REQUIRE(pool->position == 64);
+            REQUIRE(CountAlloc<4>::ct > 64);
+            pool->backgroundRefill();
+            REQUIRE(CountAlloc<4>::ct >= 64);
+            REQUIRE(CountAlloc<4>::ct < 64 + 16);
+
+            // and without the refill running a burst does allocate, and is counted
+            for (int i = 0; i < 100; ++i)
+                tmp.push_back(pool->getItem());
+            REQUIRE(pool->audioThreadAllocations > 0);
+            for (int i = 0; i < 100; ++i)
+                pool->returnItem(tmp[tmp.size() - 1 - i]);
+        }
+        REQUIRE(CountAlloc<4>::ct == 0);
+    }
+}
+
+TEST_CASE("Active Voice List Works", "[infra]")
+{
+    struct V
+    {
+        int i;
+    };
+    std::array<V, 16> vs;
+    for (int i = 0; i < 16; ++i)
+        vs[i].i = i;
+
+    SECTION("Erase While Iterating Keeps Order")
+    {
+        Surge::ActiveVoiceList<V, 16> l;
+        for (auto &v : vs)
+            l.push_back(&v);
+        REQUIRE(l.size() == 16);
+
+        auto iter = l.begin();
+        while (iter != l.end())
+        {
+            if ((*iter)->i % 3 == 0)
+                iter = l.erase(iter);
+            else
+                iter++;
+        }
+
+        REQUIRE(l.size() == 10);
+        int last = -1;
+        for (auto v : l)
+        {
+            REQUIRE(v->i % 3 != 0);
+            REQUIRE(v->i > last);
+            last = v->i;
+        }
+        REQUIRE(l.front()->i == 1);
+        REQUIRE(l.back()->i == 14);
+    }
+
+    SECTION("Remove And Clear")
+    {
+        Surge::ActiveVoiceList<V, 16> l;
+        l.push_back(&vs[4]);
+        l.push_back(&vs[7]);
+        l.push_back(&vs[9]);
+        l.remove(&vs[7]);
+        REQUIRE(l.size() == 2);
+        REQUIRE(l.front() == &vs[4]);
+        REQUIRE(l.back() == &vs[9]);
+        l.clear();
+        REQUIRE(l.empty());
+    }
+}
+
+TEST_CASE("Process Profiler", "[infra]")
+{
+    namespace prof = Surge::Profiling;
+
+    SECTION("Idle Unless Someone Is Listening")
+    {
+        auto surge = Surge::Headless::createSurge(44100, false);
+        surge->playNote(0, 60, 127, 0);
+        for (int i = 0; i < 20; ++i)
+            surge->process();
+        REQUIRE(surge->storage.processProfiler.blocksProfiled() == 0);
+        REQUIRE(surge->storage.processProfiler.average(16).block == 0);
+    }
+
+    SECTION("Stages Add Up")
+    {
+        auto surge = Surge::Headless::createSurge(44100, false);
+        auto &profiler = surge->storage.processProfiler;
+        profiler.addClient();
+
+        surge->playNote(0, 60, 127, 0);
+        for (int i = 0; i < 2000; ++i)
+            surge->process();
+        REQUIRE(profiler.blocksProfiled() == 2000);
+
+        auto avg = profiler.average(prof::ProcessProfiler::ringSize);
+        REQUIRE(avg.block == prof::ProcessProfiler::ringSize);
+        REQUIRE(avg.usec[prof::pst_total] > 0.f);
+        REQUIRE(avg.usec[prof::voiceStage(0)] > 0.f);
+        REQUIRE(avg.usec[prof::oscStage(0, 0)] > 0.f);
+        REQUIRE(avg.usec[prof::oscStage(0, 0)] <= avg.usec[prof::voiceStage(0)]);
+        REQUIRE(avg.usec[prof::voiceStage(1)] == 0.f);
+
+        float parts = 0;
+        for (int s = 0; s < prof::pst_total; ++s)
+            if (s < prof::pst_osc_first || s >= prof::pst_filterchain_first)
+                parts += avg.usec[s];
+        REQUIRE(parts <= avg.usec[prof::pst_total]);
+
+        prof::ProcessProfile latest[4];
+        REQUIRE(profiler.latest(latest, 4) == 4);
+        REQUIRE(latest[0].block == 1999);
+        REQUIRE(latest[3].block == 1996);
+
+        profiler.removeClient();
+        surge->process();
+        REQUIRE(profiler.blocksProfiled() == 2000);
+    }
+
+    SECTION("Stage Names")
+    {
+        REQUIRE(std::string(prof::processStageName(prof::pst_processControl)) ==
+                "process_control");
+        REQUIRE(std::string(prof::processStageName(prof::oscStage(1, 2))) == "scene_b_osc_3");
+        REQUIRE(std::string(prof::processStageName(prof::fxStage(7))) == "fx_7");
+        REQUIRE(std::string(prof::processStageName(prof::pst_total)) == "total");
+    }
 }
 
 TEST_CASE("strnatcmp With Spaces", "[infra]")
@@ -23,6 +23,9 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
 
 #include "HeadlessUtils.h"
 #include "Player.h"
@@ -966,4 +969,202 @@ TEST_CASE("Two Surge XTs", "[formula]")
             s2->process();
         }
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Formula Inputs Written Every Block", "[formula]")
+{
+    auto evaluate = [](SurgeStorage *storage, FormulaModulatorStorage *fs,
+                       Surge::Formula::EvaluatorState &es, int ip, float fp) {
+        float r[Surge::Formula::max_formula_outputs];
+        Surge::Formula::valueAt(ip, fp, storage, fs, &es, r);
+        return r[0];
+    };
+
+    SECTION("Changed Inputs Reach The Script")
+    {
+        SurgeStorage storage;
+        FormulaModulatorStorage fs;
+        fs.setFormula(R"FN(
+function process(state)
+    state.output = state.deform
+    return state
+end)FN");
+        Surge::Formula::EvaluatorState es;
+        Surge::Formula::prepareForEvaluation(&storage, &fs, es, true);
+        es.released = false;
+
+        for (auto d : {0.2f, 0.2f, 0.7f, -0.4f, -0.4f, 0.f})
+        {
+            es.deform = d;
+            REQUIRE(evaluate(&storage, &fs, es, 0, 0.1) == Approx(d));
+        }
+        Surge::Formula::cleanEvaluatorState(es);
+    }
+
+    SECTION("Inputs A Script Overwrites Come Back")
+    {
+        SurgeStorage storage;
+        FormulaModulatorStorage fs;
+        fs.setFormula(R"FN(
+function init(state)
+    state.subscriptions["macros"] = { true, false, true }
+    return state
+end
+
+function process(state)
+    state.output = state.deform + state.macros[1] + (state.macros[2] or 0) + state.macros[3]
+    state.deform = 0.9
+    state.macros[1] = 0.9
+    state.macros[2] = 0.9
+    return state
+end)FN");
+        Surge::Formula::EvaluatorState es;
+        Surge::Formula::prepareForEvaluation(&storage, &fs, es, true);
+        es.released = false;
+        es.deform = 0.1;
+        for (int i = 0; i < n_customcontrollers; ++i)
+            es.macrovalues[i] = 0.f;
+        es.macrovalues[0] = 0.2;
+        es.macrovalues[2] = 0.3;
+
+        // nothing moves, but every block the script has to see the real inputs again
+        for (int i = 0; i < 4; ++i)
+        {
+            INFO("Block " << i);
+            REQUIRE(evaluate(&storage, &fs, es, 0, 0.1) == Approx(0.6));
+        }
+        Surge::Formula::cleanEvaluatorState(es);
+    }
+
+    SECTION("Retrigger Requests Last One Block")
+    {
+        SurgeStorage storage;
+        FormulaModulatorStorage fs;
+        fs.setFormula(R"FN(
+function process(state)
+    state.saw_retrigger = state.retrigger_AEG and 1 or 0
+    state.retrigger_AEG = state.phase < 0.5
+    state.output = 0
+    return state
+end)FN");
+        Surge::Formula::EvaluatorState es;
+        Surge::Formula::prepareForEvaluation(&storage, &fs, es, true);
+        es.released = false;
+
+        for (auto p : {0.1f, 0.2f, 0.7f, 0.3f})
+        {
+            evaluate(&storage, &fs, es, 0, p);
+            REQUIRE(es.retrigger_AEG == (p < 0.5));
+
+            auto c = Surge::Formula::extractModStateKeyForTesting("saw_retrigger", es);
+            auto v = std::get_if<float>(&c);
+            REQUIRE(v);
+            REQUIRE(*v == 0);
+        }
+        Surge::Formula::cleanEvaluatorState(es);
+    }
+
+    SECTION("A New Table From Process Gets Every Input")
+    {
+        SurgeStorage storage;
+        FormulaModulatorStorage fs;
+        fs.setFormula(R"FN(
+function process(state)
+    return { output = state.deform, calls = (state.calls or 0) + 1 }
+end)FN");
+        Surge::Formula::EvaluatorState es;
+        Surge::Formula::prepareForEvaluation(&storage, &fs, es, true);
+        es.released = false;
+        es.deform = 0.4;
+
+        for (int i = 0; i < 5; ++i)
+        {
+            REQUIRE(evaluate(&storage, &fs, es, 0, 0.1 * i) == Approx(0.4));
+            REQUIRE(es.isvalid);
+        }
+        Surge::Formula::cleanEvaluatorState(es);
+    }
+
+    SECTION("Number Returns Keep Evaluating")
+    {
+        SurgeStorage storage;
+        FormulaModulatorStorage fs;
+        fs.setFormula(R"FN(
+function process(state)
+    return state.phase
+end)FN");
+        Surge::Formula::EvaluatorState es;
+        Surge::Formula::prepareForEvaluation(&storage, &fs, es, true);
+        es.released = false;
+
+        for (auto p : {0.1f, 0.35f, 0.6f, 0.85f})
+        {
+            REQUIRE(evaluate(&storage, &fs, es, 0, p) == Approx(p));
+        }
+        Surge::Formula::cleanEvaluatorState(es);
+    }
+}
+
+TEST_CASE("Formula Evaluation Benchmark", "[formula][.]")
+{
+    // 6 voice formula LFOs on each of 32 voices, evaluated once a block as the synth would
+    static constexpr int nLFO = 6, nVoices = 32, nBlocks = 2000;
+
+    SurgeStorage storage;
+    std::array<FormulaModulatorStorage, nLFO> fs;
+    for (auto &f : fs)
+    {
+        f.setFormula(R"FN(
+function init(state)
+    state.subscriptions["voice"] = true
+    state.subscriptions["lfo_params"] = true
+    return state
+end
+
+function process(state)
+    state.output = math.sin(state.phase * 2 * math.pi) * state.amplitude * state.velocity / 127
+    return state
+end)FN");
+    }
+
+    auto states = std::make_unique<Surge::Formula::EvaluatorState[]>(nLFO * nVoices);
+    for (int i = 0; i < nLFO * nVoices; ++i)
+    {
+        auto &es = states[i];
+        Surge::Formula::initEvaluatorState(es);
+        es.isVoice = true;
+        es.velocity = 64 + i % 64;
+        es.amp = 1.f;
+        es.deform = 0.f;
+        es.del = es.a = es.h = es.dec = es.s = es.r = 0.f;
+        es.rate = es.phase = es.tempo = es.songpos = 0.f;
+        es.released = false;
+        Surge::Formula::prepareForEvaluation(&storage, &fs[i % nLFO], es, false);
+        REQUIRE(es.isvalid);
+    }
+
+    float r[Surge::Formula::max_formula_outputs];
+    auto dPhase = 2.f * BLOCK_SIZE / storage.samplerate;
+    auto st = std::chrono::high_resolution_clock::now();
+    for (int b = 0; b < nBlocks; ++b)
+    {
+        auto phase = b * dPhase;
+        for (int i = 0; i < nLFO * nVoices; ++i)
+        {
+            Surge::Formula::valueAt((int)phase, phase - (int)phase, &storage, &fs[i % nLFO],
+                                    &states[i], r);
+        }
+    }
+    auto et = std::chrono::high_resolution_clock::now();
+
+    auto ns = std::chrono::duration<double, std::nano>(et - st).count();
+    std::cout << "Formula valueAt: " << ns / (nBlocks * nLFO * nVoices) << " ns per evaluation, "
+              << ns / nBlocks / 1000.0 << " us per block for " << nLFO * nVoices << " evaluators"
+              << std::endl;
+
+    for (int i = 0; i < nLFO * nVoices; ++i)
+    {
+        REQUIRE(states[i].isvalid);
+        Surge::Formula::cleanEvaluatorState(states[i]);
+    }
+}
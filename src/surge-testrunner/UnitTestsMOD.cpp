@@ -24,6 +24,7 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <array>
 
 #include "HeadlessUtils.h"
 #include "Player.h"
@@ -32,6 +33,7 @@
 
 #include "UnitTestUtilities.h"
 #include "ModControl.h"
+#include "VoiceLFOBank.h"
 
 using namespace Surge::Test;
 
@@ -1431,4 +1433,164 @@ TEST_CASE("Mod LFO Is Well Behaved", "[mod]")
             }
         }
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Modulation Routing Snapshots Follow Edits", "[mod]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    auto &patch = surge->storage.getPatch();
+    auto cutoff = patch.scene[0].filterunit[0].cutoff.id;
+    auto cutoffInScene = patch.scene[0].filterunit[0].cutoff.param_id_in_scene;
+
+    // what the audio thread sees for lfo1 -> cutoff in the snapshot it picks up next block
+    auto routingSeenByAudio = [&]() -> const ModulationRouting * {
+        surge->process();
+        for (const auto &r : surge->storage.audioModRouting->voice[0])
+            if (r.source_id == ms_lfo1 && r.destination_id == cutoffInScene)
+                return &r;
+        return nullptr;
+    };
+
+    SECTION("Set, Mute And Clear")
+    {
+        REQUIRE(!routingSeenByAudio());
+
+        surge->setModDepth01(cutoff, ms_lfo1, 0, 0, 0.3);
+        auto r = routingSeenByAudio();
+        REQUIRE(r);
+        REQUIRE(!r->muted);
+        REQUIRE(r->depth == patch.scene[0].modulation_voice.back().depth);
+
+        surge->muteModulation(cutoff, ms_lfo1, 0, 0, true);
+        r = routingSeenByAudio();
+        REQUIRE(r);
+        REQUIRE(r->muted);
+
+        surge->clearModulation(cutoff, ms_lfo1, 0, 0);
+        REQUIRE(!routingSeenByAudio());
+    }
+
+    SECTION("The Audio Thread Keeps Its Snapshot Until The Next Block")
+    {
+        surge->process();
+        auto *held = surge->storage.audioModRouting;
+        auto heldSize = held->voice[0].size();
+
+        surge->setModDepth01(cutoff, ms_lfo1, 0, 0, 0.3);
+        surge->setModDepth01(cutoff, ms_lfo1, 0, 0, 0.4);
+        REQUIRE(surge->storage.audioModRouting == held);
+        REQUIRE(held->voice[0].size() == heldSize);
+
+        surge->process();
+        REQUIRE(surge->storage.audioModRouting != held);
+        REQUIRE(surge->storage.audioModRouting->voice[0].size() == heldSize + 1);
+    }
+
+    SECTION("A Batch Publishes Once As It Ends")
+    {
+        auto resonance = patch.scene[0].filterunit[0].resonance.id;
+        auto *before = surge->storage.publishedModRouting.load();
+        {
+            SurgeStorage::ModulationRoutingBatch batch(surge->storage);
+            surge->setModDepth01(cutoff, ms_lfo1, 0, 0, 0.3);
+            surge->setModDepth01(resonance, ms_lfo1, 0, 0, 0.2);
+            surge->clearModulation(cutoff, ms_lfo1, 0, 0);
+            REQUIRE(surge->storage.publishedModRouting.load() == before);
+        }
+        auto *after = surge->storage.publishedModRouting.load();
+        REQUIRE(after != before);
+        REQUIRE(after->voice[0].size() == patch.scene[0].modulation_voice.size());
+        REQUIRE(!routingSeenByAudio());
+    }
+}
+
+TEST_CASE("Voice LFO Bank Matches Scalar LFOs", "[mod]")
+{
+    for (auto shape : {lt_sine, lt_tri, lt_ramp, lt_square})
+    {
+        for (auto uni : {false, true})
+        {
+            DYNAMIC_SECTION("Shape " << shape << (uni ? " Unipolar" : " Bipolar"))
+            {
+                auto surge = Surge::Headless::createSurge(44100);
+                REQUIRE(surge);
+
+                auto &patch = surge->storage.getPatch();
+                auto lfostorage = &(patch.scene[0].lfo[0]);
+                lfostorage->shape.val.i = shape;
+                lfostorage->unipolar.val.b = uni;
+                lfostorage->deform.deform_type = type_1;
+                lfostorage->trigmode.val.i = lm_keytrigger;
+                lfostorage->delay.deactivated = false;
+                REQUIRE(VoiceLFOBank::canBatch(*lfostorage));
+
+                patch.copy_scenedata(patch.scenedata[0], 0);
+
+                // one short of two SSE registers, so the padding lanes get exercised
+                static constexpr int nLanes = 7;
+                std::vector<std::array<pdata, n_scene_params>> localcopy(nLanes);
+                auto ss = std::make_unique<StepSequencerStorage>();
+                std::array<std::unique_ptr<LFOModulationSource>, nLanes> scalar, banked;
+                LFOModulationSource *bankedLanes[nLanes];
+
+                for (int i = 0; i < nLanes; ++i)
+                {
+                    auto &lc = localcopy[i];
+                    std::copy(patch.scenedata[0], patch.scenedata[0] + n_scene_params, lc.begin());
+                    lc[lfostorage->rate.param_id_in_scene].f = -1.f + 0.7f * i;
+                    lc[lfostorage->deform.param_id_in_scene].f = -1.f + 0.3f * i;
+                    lc[lfostorage->start_phase.param_id_in_scene].f = 0.13f * i;
+                    lc[lfostorage->magnitude.param_id_in_scene].f = 0.4f + 0.1f * i;
+
+                    for (auto *l : {&scalar[i], &banked[i]})
+                    {
+                        *l = std::make_unique<LFOModulationSource>();
+                        (*l)->assign(&(surge->storage), lfostorage, lc.data(), nullptr, ss.get(),
+                                     nullptr, nullptr);
+                        (*l)->setIsVoice(true);
+                        (*l)->attack();
+                    }
+                    bankedLanes[i] = banked[i].get();
+                }
+
+                VoiceLFOBank bank;
+                for (int b = 0; b < 3000; ++b)
+                {
+                    if (b == 2000)
+                    {
+                        for (int i = 0; i < nLanes; ++i)
+                        {
+                            scalar[i]->release();
+                            banked[i]->release();
+                        }
+                    }
+
+                    for (auto &l : scalar)
+                        l->process_block();
+                    bank.processSlot(*lfostorage, bankedLanes, nLanes);
+
+                    for (int i = 0; i < nLanes; ++i)
+                    {
+                        INFO("Block " << b << " lane " << i);
+                        REQUIRE(banked[i]->processedByBank);
+                        banked[i]->processedByBank = false;
+
+                        REQUIRE(banked[i]->getPhase() == scalar[i]->getPhase());
+                        for (int o = 0; o < 3; ++o)
+                        {
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64)
+                            REQUIRE(banked[i]->get_output(o) == scalar[i]->get_output(o));
+#else
+                            // ARM compilers may fuse the multiply-adds differently on each path
+                            REQUIRE(banked[i]->get_output(o) ==
+                                    Approx(scalar[i]->get_output(o)).margin(1e-6));
+#endif
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -23,6 +23,7 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <limits>
 
 #include "HeadlessUtils.h"
 #include "catch2/catch_amalgamated.hpp"
@@ -553,3 +554,174 @@ TEST_CASE("Zero Size Loops", "[mseg]")
  *    - unsplit
  *  - each of those with loop preservation also
  */
+
+// timeToSegment as it was before the time index, scanning every segment from the first
+int scanTimeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &amountAlongSegment)
+{
+    if (ms->totalDuration < MSEGStorage::minimumDuration)
+        return -1;
+
+    if (ignoreLoops)
+    {
+        if (t >= ms->totalDuration)
+        {
+            double nup = t / ms->totalDuration;
+            t -= (int)nup * ms->totalDuration;
+            if (t < 0)
+                t += ms->totalDuration;
+        }
+
+        for (int i = 0; i < ms->n_activeSegments; ++i)
+        {
+            if (t >= ms->segmentStart[i] && t < ms->segmentEnd[i])
+            {
+                amountAlongSegment = t - ms->segmentStart[i];
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    int ls = (ms->loop_start >= 0 ? ms->loop_start : 0);
+
+    if (t <= ms->durationToLoopEnd)
+    {
+        for (int i = 0; i < ms->n_activeSegments; ++i)
+            if (t >= ms->segmentStart[i] && t <= ms->segmentEnd[i])
+            {
+                amountAlongSegment = t - ms->segmentStart[i];
+                return i;
+            }
+    }
+    else if (ms->loop_start > ms->loop_end && ms->loop_start >= 0 && ms->loop_end >= 0)
+    {
+        amountAlongSegment = ms->segments[ms->loop_end].duration;
+        return ms->loop_end;
+    }
+    else
+    {
+        double nt = t - ms->durationToLoopEnd;
+        double nup = nt / ms->durationLoopStartToLoopEnd;
+        nt -= (int)nup * ms->durationLoopStartToLoopEnd;
+        if (nt < 0)
+            nt += ms->durationLoopStartToLoopEnd;
+        nt += ms->segmentStart[ls];
+
+        for (int i = 0; i < ms->n_activeSegments; ++i)
+            if (nt >= ms->segmentStart[i] && nt <= ms->segmentEnd[i])
+            {
+                amountAlongSegment = nt - ms->segmentStart[i];
+                return i;
+            }
+    }
+    return 0;
+}
+
+TEST_CASE("Dense MSEG Lookup Matches A Full Scan", "[mseg]")
+{
+    srand(8675309);
+    auto r01 = []() { return (float)rand() / (float)RAND_MAX; };
+
+    for (auto editMode : {MSEGStorage::ENVELOPE, MSEGStorage::LFO})
+    {
+        for (int trial = 0; trial < 20; ++trial)
+        {
+            DYNAMIC_SECTION("Mode " << editMode << " trial " << trial)
+            {
+                MSEGStorage ms;
+                ms.editMode = editMode;
+                ms.loopMode = MSEGStorage::LoopMode::LOOP;
+                ms.endpointMode = MSEGStorage::EndpointMode::FREE;
+                ms.n_activeSegments = (trial == 0) ? max_msegs : 1 + rand() % max_msegs;
+
+                float total = 0;
+                for (int i = 0; i < ms.n_activeSegments; ++i)
+                {
+                    auto &s = ms.segments[i];
+                    // some zero length segments, which only the loop search can land on
+                    s.duration =
+                        (i > 0 && rand() % 7 == 0) ? 0.f : 0.01f + r01() * (i % 5 ? 0.1f : 2.f);
+                    s.type = MSEGStorage::segment::LINEAR;
+                    s.v0 = r01() * 2 - 1;
+                    total += s.duration;
+                }
+                if (editMode == MSEGStorage::LFO)
+                {
+                    for (int i = 0; i < ms.n_activeSegments; ++i)
+                        ms.segments[i].duration /= std::max(total, 1e-3f);
+                }
+                if (trial % 3 == 1)
+                {
+                    ms.loop_start = rand() % ms.n_activeSegments;
+                    ms.loop_end = rand() % ms.n_activeSegments;
+                }
+
+                resetCP(&ms);
+                Surge::MSEG::rebuildCache(&ms);
+
+                for (int i = 0; i < 5000; ++i)
+                {
+                    double t = (i % 10 == 0) ? ms.segmentEnd[rand() % ms.n_activeSegments]
+                                             : r01() * ms.totalDuration * 3;
+                    for (auto ignoreLoops : {true, false})
+                    {
+                        float along = -1, scanAlong = -1;
+                        auto idx = Surge::MSEG::timeToSegment(&ms, t, ignoreLoops, along);
+                        auto scanIdx = scanTimeToSegment(&ms, t, ignoreLoops, scanAlong);
+                        INFO("t=" << t << " ignoreLoops=" << ignoreLoops);
+                        REQUIRE(idx == scanIdx);
+                        REQUIRE(along == scanAlong);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Cached Segment Curves Match Recomputed Curves", "[mseg]")
+{
+    using seg = MSEGStorage::segment;
+    auto types = {seg::LINEAR, seg::SCURVE, seg::SINE, seg::SAWTOOTH, seg::TRIANGLE, seg::SQUARE,
+                  seg::STAIRS, seg::SMOOTH_STAIRS, seg::QUAD_BEZIER, seg::BUMP, seg::HOLD};
+
+    for (auto type : types)
+    {
+        DYNAMIC_SECTION("Segment Type " << type)
+        {
+            MSEGStorage ms;
+            ms.editMode = MSEGStorage::ENVELOPE;
+            ms.loopMode = MSEGStorage::LoopMode::LOOP;
+            ms.endpointMode = MSEGStorage::EndpointMode::FREE;
+            ms.n_activeSegments = 21;
+
+            for (int i = 0; i < ms.n_activeSegments; ++i)
+            {
+                auto &s = ms.segments[i];
+                s.duration = 0.1f + 0.03f * (i % 4);
+                s.type = type;
+                s.v0 = (i % 2) ? 0.8f : -0.6f;
+                s.cpduration = 0.5f;
+                // sweeps the whole range, including the step boundaries of the waveforms
+                s.cpv = -1.f + 0.1f * i;
+            }
+            Surge::MSEG::rebuildCache(&ms);
+
+            // Forget the cached terms, so valueAt has to work them out from the control point
+            auto uncached = ms;
+            uncached.segmentCurveCpv.fill(std::numeric_limits<float>::quiet_NaN());
+
+            for (auto df : {-0.7f, 0.f, 0.4f})
+            {
+                auto cached = runMSEG(&ms, 0.0131, ms.totalDuration * 2, df);
+                auto recomputed = runMSEG(&uncached, 0.0131, ms.totalDuration * 2, df);
+
+                REQUIRE(cached.size() == recomputed.size());
+                for (size_t i = 0; i < cached.size(); ++i)
+                {
+                    INFO("deform " << df << " phase " << cached[i].phase);
+                    REQUIRE(cached[i].v == recomputed[i].v);
+                }
+            }
+        }
+    }
+}
@@ -23,8 +23,13 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
+#include "HeadlessUtils.h"
 #include "PatchDB.h"
+#include "SurgeStorage.h"
 
 #include "catch2/catch_amalgamated.hpp"
 
@@ -150,34 +155,172 @@ TEST_CASE("Simple Query Parse", "[query]")
     // ADDRESS ["init sine" OR dx pad] drops the pad
 }
 
-TEST_CASE("SQL Generation", "[query]")
+TEST_CASE("FTS Match Generation", "[query]")
 {
     SECTION("Simplest of All")
     {
         auto t = Surge::PatchStorage::PatchDBQueryParser::parseQuery("init");
-        auto s = Surge::PatchStorage::PatchDB::sqlWhereClauseFor(t);
-        REQUIRE(s == "( p.search_over LIKE '%init%' )");
+        auto s = Surge::PatchStorage::PatchDB::ftsMatchExpressionFor(t);
+        REQUIRE(s == "{name tags fragments} : \"init\"*");
     }
 
     SECTION("Duple")
     {
         auto t = Surge::PatchStorage::PatchDBQueryParser::parseQuery("init sine");
-        auto s = Surge::PatchStorage::PatchDB::sqlWhereClauseFor(t);
-        REQUIRE(s == "( ( p.search_over LIKE '%init%' ) AND ( p.search_over LIKE '%sine%' ) )");
+        auto s = Surge::PatchStorage::PatchDB::ftsMatchExpressionFor(t);
+        REQUIRE(s == "( {name tags fragments} : \"init\"* ) AND "
+                     "( {name tags fragments} : \"sine\"* )");
     }
 
     SECTION("Single Quote")
     {
         auto t = Surge::PatchStorage::PatchDBQueryParser::parseQuery("init 'sine");
-        auto s = Surge::PatchStorage::PatchDB::sqlWhereClauseFor(t);
-        REQUIRE(s == "( ( p.search_over LIKE '%init%' ) AND ( p.search_over LIKE '%''sine%' ) )");
+        auto s = Surge::PatchStorage::PatchDB::ftsMatchExpressionFor(t);
+        REQUIRE(s == "( {name tags fragments} : \"init\"* ) AND "
+                     "( {name tags fragments} : \"'sine\"* )");
     }
 
-    SECTION("Lots of Single Quotes Quote")
+    SECTION("Double Quotes in a Term")
     {
-        auto t = Surge::PatchStorage::PatchDBQueryParser::parseQuery("in'it' ''sine");
-        auto s = Surge::PatchStorage::PatchDB::sqlWhereClauseFor(t);
-        REQUIRE(s ==
-                "( ( p.search_over LIKE '%in''it''%' ) AND ( p.search_over LIKE '%''''sine%' ) )");
+        auto t = Surge::PatchStorage::PatchDBQueryParser::parseQuery("in\"it");
+        auto s = Surge::PatchStorage::PatchDB::ftsMatchExpressionFor(t);
+        REQUIRE(s == "{name tags fragments} : \"in\"\"it\"*");
     }
-}
\ No newline at end of file
+
+    SECTION("Keywords")
+    {
+        auto t = Surge::PatchStorage::PatchDBQueryParser::parseQuery(
+            "(pad OR atmosphere) AND (AUTHOR=bacon OR CAT=Keys)");
+        auto s = Surge::PatchStorage::PatchDB::ftsMatchExpressionFor(t);
+        REQUIRE(s == "( ( {name tags fragments} : \"pad\"* ) OR "
+                     "( {name tags fragments} : \"atmosphere\"* ) ) AND "
+                     "( ( author : \"bacon\"* ) OR ( category : \"Keys\"* ) )");
+    }
+
+    SECTION("Unsearchable Terms Match Everything")
+    {
+        auto t = Surge::PatchStorage::PatchDBQueryParser::parseQuery("init ''");
+        auto s = Surge::PatchStorage::PatchDB::ftsMatchExpressionFor(t);
+        REQUIRE(s == "{name tags fragments} : \"init\"*");
+
+        t = Surge::PatchStorage::PatchDBQueryParser::parseQuery("init OR ''");
+        REQUIRE(Surge::PatchStorage::PatchDB::ftsMatchExpressionFor(t).empty());
+    }
+
+    SECTION("Invalid Queries Match Nothing")
+    {
+        auto t = std::make_unique<Surge::PatchStorage::PatchDBQueryParser::Token>();
+        auto s = Surge::PatchStorage::PatchDB::ftsMatchExpressionFor(t);
+        REQUIRE(s == "\"\"");
+    }
+}
+
+TEST_CASE("Patch Search Over An Indexed DB", "[query]")
+{
+    // save a handful of patches and index them into a database of their own
+    auto surge = Surge::Headless::createSurge(44100);
+    auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    auto dir = fs::temp_directory_path() / fs::path{"surge-query-test-" + std::to_string(stamp)};
+    fs::create_directories(dir);
+
+    struct P
+    {
+        std::string name, author, category, tag;
+    };
+    std::vector<P> patches = {{"SubBass Growl", "bacon", "Basses", "dark"},
+                              {"Glass Pad", "Jacky", "Pads", "airy"},
+                              {"Init Sine", "", "Templates", "simple"},
+                              {"Café Keys", "bacon", "Keys", "vintage"}};
+
+    auto savedDataPath = surge->storage.userDataPath;
+    surge->storage.userDataPath = dir;
+    auto db = std::make_unique<Surge::PatchStorage::PatchDB>(&surge->storage);
+    surge->storage.userDataPath = savedDataPath;
+
+    db->prepareForWrites();
+    for (auto &p : patches)
+    {
+        auto &patch = surge->storage.getPatch();
+        patch.name = p.name;
+        patch.author = p.author;
+        patch.category = p.category;
+        patch.tags = {SurgePatch::Tag(p.tag)};
+
+        auto fxp = dir / string_to_path(p.name + ".fxp");
+        surge->savePatchToPath(fxp, false);
+        db->considerFXPForLoad(fxp, p.name, p.category, Surge::PatchStorage::PatchDB::USER);
+    }
+
+    std::atomic<bool> drained{false};
+    db->doAfterCurrentQueueDrained([&drained]() { drained = true; });
+    for (int i = 0; i < 1000 && !drained; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    REQUIRE(drained);
+
+    auto names = [&db](const std::string &q) {
+        std::vector<std::string> res;
+        for (auto &r : db->queryFromQueryString(q))
+            res.push_back(r.name);
+        std::sort(res.begin(), res.end());
+        return res;
+    };
+    using v = std::vector<std::string>;
+
+    REQUIRE(db->readAllPatchPathsWithIdAndModTime().size() == patches.size());
+    REQUIRE(names("glass") == v{"Glass Pad"});
+    REQUIRE(names("gro") == v{"SubBass Growl"});
+    REQUIRE(names("dark") == v{"SubBass Growl"});
+    REQUIRE(names("cafe") == v{"Café Keys"});
+
+    // a term from the middle of a word still finds it
+    REQUIRE(names("bass") == v{"SubBass Growl"});
+    REQUIRE(names("ass") == v{"Glass Pad", "SubBass Growl"});
+
+    REQUIRE(names("AUTHOR=bacon") == v{"Café Keys", "SubBass Growl"});
+    REQUIRE(names("AUTHOR=jac") == v{"Glass Pad"});
+    REQUIRE(names("CAT=pads") == v{"Glass Pad"});
+    REQUIRE(names("keys AUTHOR=bacon") == v{"Café Keys"});
+    REQUIRE(names("pad OR sine") == v{"Glass Pad", "Init Sine"});
+    REQUIRE(names("(pad OR sine) AND AUTHOR=jacky") == v{"Glass Pad"});
+
+    // no author is no reason to drop out of a search
+    REQUIRE(names("init") == v{"Init Sine"});
+    REQUIRE(names("init sine") == v{"Init Sine"});
+    REQUIRE(db->queryFromQueryString("init")[0].author.empty());
+
+    REQUIRE(names("nothinglikethis").empty());
+    auto invalid = std::make_unique<Surge::PatchStorage::PatchDBQueryParser::Token>();
+    REQUIRE(db->queryFromQueryString(invalid).empty());
+
+    db.reset();
+    fs::remove_all(dir);
+}
+
+TEST_CASE("Patch Query Benchmark", "[query][.]")
+{
+    // index the factory and third party patches, then time type-ahead style queries against them
+    auto surge = Surge::Headless::createSurge(44100);
+    surge->storage.initializePatchDb();
+
+    std::atomic<bool> drained{false};
+    surge->storage.patchDB->doAfterCurrentQueueDrained([&drained]() { drained = true; });
+    for (int i = 0; i < 6000 && !drained; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    REQUIRE(drained);
+
+    REQUIRE(!surge->storage.patchDB->queryFromQueryString("init").empty());
+
+    static constexpr int nRuns = 200;
+    for (auto q : {"p", "pa", "pad", "init sine", "bass OR lead", "AUTHOR=ja", "CAT=keys e"})
+    {
+        size_t found = 0;
+        auto st = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < nRuns; ++i)
+            found = surge->storage.patchDB->queryFromQueryString(q).size();
+        auto et = std::chrono::high_resolution_clock::now();
+
+        auto us = std::chrono::duration<double, std::micro>(et - st).count() / nRuns;
+        std::cout << "Query [" << q << "]: " << found << " patches in " << us << " us"
+                  << std::endl;
+    }
+}
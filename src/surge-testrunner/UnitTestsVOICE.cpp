@@ -327,3 +327,100 @@ TEST_CASE("Play and release Frequency and Note ID", "[voice]")
         }
     }
 }
+
+TEST_CASE("Notes Start On Their Sample Within A Block", "[voice]")
+{
+    auto onsetFor = [](int offset) {
+        auto s = surgeOnSine();
+        for (int i = 0; i < 10; ++i)
+            s->process();
+
+        s->setBlockEventOffset(offset);
+        s->playNote(0, 60, 127, 0);
+
+        std::vector<float> out;
+        for (int i = 0; i < 4; ++i)
+        {
+            s->process();
+            out.insert(out.end(), s->output[0], s->output[0] + BLOCK_SIZE);
+        }
+
+        for (int i = 0; i < (int)out.size(); ++i)
+            if (std::fabs(out[i]) > 1e-6)
+                return i;
+        return -1;
+    };
+
+    auto onset0 = onsetFor(0);
+    REQUIRE(onset0 >= 0);
+    REQUIRE(onset0 < BLOCK_SIZE / 4);
+
+    for (auto offset : {1, BLOCK_SIZE / 2, BLOCK_SIZE - 1})
+    {
+        INFO("Playing at offset " << offset);
+        auto onset = onsetFor(offset);
+        REQUIRE(onset >= offset);
+        REQUIRE(onset <= onset0 + offset);
+    }
+}
+
+TEST_CASE("Envelopes Start With Notes Within A Block", "[voice]")
+{
+    // a linear, digital attack which takes a few dozen blocks, so the gain ramp is easy to follow
+    auto setup = []() {
+        auto s = surgeOnSine();
+        s->seedRNG(2112);
+        s->storage.getPatch().scene[0].osc[0].retrigger.val.b = true;
+
+        auto &aeg = s->storage.getPatch().scene[0].adsr[0];
+        aeg.mode.val.b = false;
+        aeg.a_s.val.i = 1;
+        aeg.a.val.f = log2(0.02f);
+        for (int i = 0; i < 10; ++i)
+            s->process();
+        return s;
+    };
+
+    auto renderFrom = [](std::shared_ptr<SurgeSynthesizer> s, int offset, int nBlocks,
+                         float *firstBlockEnv) {
+        s->setBlockEventOffset(offset);
+        s->playNote(0, 60, 127, 0);
+
+        std::vector<float> out;
+        for (int i = 0; i < nBlocks; ++i)
+        {
+            s->process();
+            if (i == 0)
+            {
+                REQUIRE(!s->voices[0].empty());
+                *firstBlockEnv = s->voices[0].front()->modsources[ms_ampeg]->get_output(0);
+            }
+            out.insert(out.end(), s->output[0], s->output[0] + BLOCK_SIZE);
+        }
+        return out;
+    };
+
+    const int nBlocks = 12;
+    float env0, envOff;
+    auto ref = renderFrom(setup(), 0, nBlocks, &env0);
+    REQUIRE(env0 > 0.f);
+
+    for (auto offset : {1, BLOCK_SIZE / 2, BLOCK_SIZE - 1})
+    {
+        INFO("Playing at offset " << offset);
+        auto out = renderFrom(setup(), offset, nBlocks, &envOff);
+
+        // the envelope has only run for the part of the first block the note sounded in
+        REQUIRE(envOff == Approx(env0 * (BLOCK_SIZE - offset) / BLOCK_SIZE).margin(1e-6));
+
+        // and from the second block on the note is the offset zero one moved along
+        float peak = 0.f, maxDiff = 0.f;
+        for (int i = BLOCK_SIZE; i + offset < (int)out.size(); ++i)
+        {
+            peak = std::max(peak, std::fabs(ref[i]));
+            maxDiff = std::max(maxDiff, std::fabs(out[i + offset] - ref[i]));
+        }
+        REQUIRE(peak > 0.05f);
+        REQUIRE(maxDiff < peak * 0.01f);
+    }
+}
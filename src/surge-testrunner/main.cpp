@@ -51,6 +51,10 @@ int main(int argc, char **argv)
         {
             Surge::Headless::NonTest::statsFromPlayingEveryPatch();
         }
+        if (strcmp(argv[2], "--rt-safety-check") == 0)
+        {
+            return Surge::Headless::NonTest::rtSafetyCheckEveryPatch() > 0 ? 1 : 0;
+        }
         if (strcmp(argv[2], "--restream-templates") == 0)
         {
             Surge::Headless::NonTest::restreamTemplatesWithModifications();
@@ -69,6 +73,42 @@ int main(int argc, char **argv)
             Surge::Headless::NonTest::filterAnalyzer(std::atoi(argv[3]), std::atoi(argv[4]),
                                                      std::cout);
         }
+        if (strcmp(argv[2], "--parallel-scene-benchmark") == 0)
+        {
+            Surge::Headless::NonTest::parallelSceneBenchmark(argc > 3 ? argv[3] : "");
+        }
+        if (strcmp(argv[2], "--parallel-fx-benchmark") == 0)
+        {
+            Surge::Headless::NonTest::parallelFXBenchmark();
+        }
+        if (strcmp(argv[2], "--airwindows-simd-benchmark") == 0)
+        {
+            Surge::Headless::NonTest::airwindowsSIMDBenchmark();
+        }
+        if (strcmp(argv[2], "--vocoder-benchmark") == 0)
+        {
+            Surge::Headless::NonTest::vocoderBenchmark();
+        }
+        if (strcmp(argv[2], "--convolution-benchmark") == 0)
+        {
+            Surge::Headless::NonTest::convolutionBenchmark();
+        }
+        if (strcmp(argv[2], "--mod-edit-storm") == 0)
+        {
+            Surge::Headless::NonTest::modulationEditStormBenchmark();
+        }
+        if (strcmp(argv[2], "--host-buffer-benchmark") == 0)
+        {
+            Surge::Headless::NonTest::hostBufferBenchmark();
+        }
+        if (strcmp(argv[2], "--cpu-per-voice") == 0)
+        {
+            Surge::Headless::NonTest::cpuPerVoiceBenchmark();
+        }
+        if (strcmp(argv[2], "--fx-tails") == 0)
+        {
+            Surge::Headless::NonTest::measureFXTails();
+        }
         if (strcmp(argv[2], "--performance") == 0)
         {
             Surge::Headless::NonTest::performancePlay(argv[3], std::atoi(argv[4]));
@@ -85,8 +125,30 @@ int main(int argc, char **argv)
                    "'--non-test' and\n"
                 << "then use the options below\n\n"
                 << "   --non-test --stats-from-every-patch    # play every patch and show RMS\n"
+                << "   --non-test --rt-safety-check           # play every patch and report "
+                   "audio thread\n"
+                << "                                          # allocations and locks (needs "
+                   "SURGE_RT_SAFETY_CHECKS)\n"
                 << "   --non-test --filter-analyzer ft fst    # analyze filter type/subtype for "
                    "response\n"
+                << "   --non-test --parallel-scene-benchmark [patch] # time serial vs parallel "
+                   "scene rendering\n"
+                << "   --non-test --parallel-fx-benchmark     # time serial vs parallel fx "
+                   "chains\n"
+                << "   --non-test --airwindows-simd-benchmark # scalar vs SIMD airwindows "
+                   "kernels\n"
+                << "   --non-test --vocoder-benchmark         # filter bank vs FFT vocoder "
+                   "across band counts\n"
+                << "   --non-test --convolution-benchmark     # convolution reverb cost for 1 "
+                   "to 10 second IRs\n"
+                << "   --non-test --mod-edit-storm            # block times under a storm of "
+                   "routing edits\n"
+                << "   --non-test --host-buffer-benchmark     # host output loop cost across "
+                   "buffer sizes\n"
+                << "   --non-test --cpu-per-voice             # render cost per voice at this "
+                   "build's BLOCK_SIZE\n"
+                << "   --non-test --fx-tails                  # measure each fx type's tail for "
+                   "its sleep hold\n"
                 << "\n"
                 << "If you exclude the `--non-test` argument, standard catch2 arguments, below, "
                    "apply\n\n";
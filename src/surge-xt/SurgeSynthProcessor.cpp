@@ -26,6 +26,7 @@
 #include "version.h"
 #include "sst/plugininfra/cpufeatures.h"
 #include "globals.h"
+#include "HostBlockSpans.h"
 #include "UserDefaults.h"
 #include "UnitConversions.h"
 
@@ -519,10 +520,26 @@ void SurgeSynthProcessor::processBlock(juce::AudioBuffer<float> &buffer,
         inputIsLatent = true;
     }
 
-    for (int i = 0; i < buffer.getNumSamples(); i++)
+    auto outL = mainOutput.getWritePointer(0);
+    auto outR = mainOutput.getWritePointer(1);
+
+    float *sAL{nullptr}, *sAR{nullptr}, *sBL{nullptr}, *sBR{nullptr};
+    if (sceneAOutput.getNumChannels() == 2)
+    {
+        sAL = sceneAOutput.getWritePointer(0);
+        sAR = sceneAOutput.getWritePointer(1);
+    }
+    if (sceneBOutput.getNumChannels() == 2)
     {
-        while (i == nextMidi)
+        sBL = sceneBOutput.getWritePointer(0);
+        sBR = sceneBOutput.getWritePointer(1);
+    }
+
+    auto startBlock = [&](int i) {
+        // apply the events for the block we're about to render up front, each at its offset
+        while (nextMidi >= 0 && nextMidi < i + BLOCK_SIZE)
         {
+            surge->setBlockEventOffset(nextMidi - i);
             applyMidi(*midiIt);
             midiIt++;
 
@@ -536,10 +553,7 @@ void SurgeSynthProcessor::processBlock(juce::AudioBuffer<float> &buffer,
             }
         }
 
-        auto outL = mainOutput.getWritePointer(0, i);
-        auto outR = mainOutput.getWritePointer(1, i);
-
-        if (blockPos == 0 && incL && incR)
+        if (incL && incR)
         {
             surge->process_input = true;
 
@@ -550,11 +564,8 @@ void SurgeSynthProcessor::processBlock(juce::AudioBuffer<float> &buffer,
             }
             else
             {
-                auto inL = incL + i;
-                auto inR = incR + i;
-
-                memcpy(&(surge->input[0][0]), inL, BLOCK_SIZE * sizeof(float));
-                memcpy(&(surge->input[1][0]), inR, BLOCK_SIZE * sizeof(float));
+                memcpy(&(surge->input[0][0]), incL + i, BLOCK_SIZE * sizeof(float));
+                memcpy(&(surge->input[1][0]), incR + i, BLOCK_SIZE * sizeof(float));
             }
         }
         else
@@ -562,53 +573,44 @@ void SurgeSynthProcessor::processBlock(juce::AudioBuffer<float> &buffer,
             surge->process_input = false;
         }
 
-        if (blockPos == 0)
-        {
-            surge->process();
-            surge->time_data.ppqPos +=
-                (double)BLOCK_SIZE * surge->time_data.tempo / (60. * surge->storage.samplerate);
-        }
+        surge->process();
+        surge->time_data.ppqPos +=
+            (double)BLOCK_SIZE * surge->time_data.tempo / (60. * surge->storage.samplerate);
+    };
 
+    auto copySpan = [&](int i, int pos, int n) {
         if (inputIsLatent && incL && incR)
         {
-            inputLatentBuffer[0][blockPos] = incL[i];
-            inputLatentBuffer[1][blockPos] = incR[i];
+            Surge::copyHostSpan(inputLatentBuffer[0] + pos, incL + i, n);
+            Surge::copyHostSpan(inputLatentBuffer[1] + pos, incR + i, n);
         }
 
-        *outL = surge->output[0][blockPos];
-        *outR = surge->output[1][blockPos];
+        Surge::copyHostSpan(outL + i, surge->output[0] + pos, n);
+        Surge::copyHostSpan(outR + i, surge->output[1] + pos, n);
 
         if (surge->activateExtraOutputs)
         {
-            if (sceneAOutput.getNumChannels() == 2)
+            if (sAL && sAR)
             {
-                auto sAL = sceneAOutput.getWritePointer(0, i);
-                auto sAR = sceneAOutput.getWritePointer(1, i);
-
-                if (sAL && sAR)
-                {
-                    *sAL = surge->sceneout[0][0][blockPos];
-                    *sAR = surge->sceneout[0][1][blockPos];
-                }
+                Surge::copyHostSpan(sAL + i, surge->sceneout[0][0] + pos, n);
+                Surge::copyHostSpan(sAR + i, surge->sceneout[0][1] + pos, n);
             }
 
-            if (sceneBOutput.getNumChannels() == 2)
+            if (sBL && sBR)
             {
-                auto sBL = sceneBOutput.getWritePointer(0, i);
-                auto sBR = sceneBOutput.getWritePointer(1, i);
-
-                if (sBL && sBR)
-                {
-                    *sBL = surge->sceneout[1][0][blockPos];
-                    *sBR = surge->sceneout[1][1][blockPos];
-                }
+                Surge::copyHostSpan(sBL + i, surge->sceneout[1][0] + pos, n);
+                Surge::copyHostSpan(sBR + i, surge->sceneout[1][1] + pos, n);
             }
         }
+    };
 
-        blockPos = (blockPos + 1) & (BLOCK_SIZE - 1);
-    }
+    Surge::forEachHostBlockSpan(blockPos, buffer.getNumSamples(), startBlock, copySpan);
 
-    // This should, in theory, never happen, but better safe than sorry
+    /*
+     * Events after the last block boundary in this buffer, which happens when a block straddles
+     * the end of it, land here and take effect from the top of the next block.
+     */
+    surge->setBlockEventOffset(0);
     while (midiIt != midiMessages.cend())
     {
         applyMidi(*midiIt);
@@ -834,85 +836,73 @@ clap_process_status SurgeSynthProcessor::clap_direct_process(const clap_process
             haveSceneOut = false;
     }
 
-    for (int s = 0; s < process->frames_count; ++s)
-    {
-        if (blockPos == 0)
+    auto startBlock = [&](int s) {
+        while (nextevtime >= 0 && nextevtime < s + BLOCK_SIZE && currev < evtsz)
         {
-            while (nextevtime >= 0 && nextevtime < s + BLOCK_SIZE && currev < evtsz)
+            auto evt = ev->get(ev, currev);
+
+            surge->setBlockEventOffset((int)evt->time - s);
+            process_clap_event(evt);
+
+            currev++;
+            if (currev < evtsz)
+            {
+                nextevtime = ev->get(ev, currev)->time;
+            }
+            else
             {
-                auto evt = ev->get(ev, currev);
-
-                process_clap_event(evt);
-
-                currev++;
-                if (currev < evtsz)
-                {
-                    nextevtime = ev->get(ev, currev)->time;
-                }
-                else
-                {
-                    nextevtime = -1;
-                }
+                nextevtime = -1;
             }
         }
 
-        if (blockPos == 0)
+        if (inL && inR)
         {
-            if (inL && inR)
-            {
-                memcpy(&(surge->input[0][0]), inL, BLOCK_SIZE * sizeof(float));
-                memcpy(&(surge->input[1][0]), inR, BLOCK_SIZE * sizeof(float));
-                inL += BLOCK_SIZE;
-                inR += BLOCK_SIZE;
-            }
-            surge->process();
-            surge->time_data.ppqPos +=
-                (double)BLOCK_SIZE * surge->time_data.tempo / (60. * surge->storage.samplerate);
+            memcpy(&(surge->input[0][0]), inL, BLOCK_SIZE * sizeof(float));
+            memcpy(&(surge->input[1][0]), inR, BLOCK_SIZE * sizeof(float));
+            inL += BLOCK_SIZE;
+            inR += BLOCK_SIZE;
+        }
+        surge->process();
+        surge->time_data.ppqPos +=
+            (double)BLOCK_SIZE * surge->time_data.tempo / (60. * surge->storage.samplerate);
 
-            if (surge->hostNoteEndedDuringBlockCount > 0)
+        if (surge->hostNoteEndedDuringBlockCount > 0)
+        {
+            auto ov = process->out_events;
+            for (int v = 0; v < surge->hostNoteEndedDuringBlockCount; ++v)
             {
-                auto ov = process->out_events;
-                for (int v = 0; v < surge->hostNoteEndedDuringBlockCount; ++v)
-                {
-                    auto evt = clap_event_note();
-                    evt.header.size = sizeof(clap_event_note);
-                    evt.header.type = (uint16_t)CLAP_EVENT_NOTE_END;
-                    evt.header.time = s;
-                    evt.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
-                    evt.header.flags = 0;
-
-                    evt.port_index = 0;
-                    evt.channel = surge->endedHostNoteOriginalChannel[v];
-                    evt.key = surge->endedHostNoteOriginalKey[v];
-                    evt.note_id = surge->endedHostNoteIds[v];
-                    evt.velocity = 0.0;
-
-                    ov->try_push(ov, reinterpret_cast<const clap_event_header *>(&evt));
-                }
+                auto evt = clap_event_note();
+                evt.header.size = sizeof(clap_event_note);
+                evt.header.type = (uint16_t)CLAP_EVENT_NOTE_END;
+                evt.header.time = s;
+                evt.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+                evt.header.flags = 0;
+
+                evt.port_index = 0;
+                evt.channel = surge->endedHostNoteOriginalChannel[v];
+                evt.key = surge->endedHostNoteOriginalKey[v];
+                evt.note_id = surge->endedHostNoteIds[v];
+                evt.velocity = 0.0;
+
+                ov->try_push(ov, reinterpret_cast<const clap_event_header *>(&evt));
             }
         }
-        *outL = surge->output[0][blockPos];
-        *outR = surge->output[1][blockPos];
-        outL++;
-        outR++;
+    };
+
+    auto copySpan = [&](int s, int pos, int n) {
+        Surge::copyHostSpan(outL + s, surge->output[0] + pos, n);
+        Surge::copyHostSpan(outR + s, surge->output[1] + pos, n);
 
         if (haveSceneOut)
         {
-            *sceneAL = surge->sceneout[0][0][blockPos];
-            *sceneAR = surge->sceneout[0][1][blockPos];
-            *sceneBL = surge->sceneout[1][0][blockPos];
-            *sceneBR = surge->sceneout[1][1][blockPos];
-
-            sceneAL++;
-            sceneAR++;
-            sceneBL++;
-            sceneBR++;
+            Surge::copyHostSpan(sceneAL + s, surge->sceneout[0][0] + pos, n);
+            Surge::copyHostSpan(sceneAR + s, surge->sceneout[0][1] + pos, n);
+            Surge::copyHostSpan(sceneBL + s, surge->sceneout[1][0] + pos, n);
+            Surge::copyHostSpan(sceneBR + s, surge->sceneout[1][1] + pos, n);
         }
+    };
 
-        // TO DO: Scene Output
-
-        blockPos = (blockPos + 1) & (BLOCK_SIZE - 1);
-    }
+    Surge::forEachHostBlockSpan(blockPos, process->frames_count, startBlock, copySpan);
 
     // just in case
     while (currev < evtsz)
@@ -25,8 +25,13 @@
 #include <juce_core/juce_core.h>
 #include <juce_events/juce_events.h>
 #include <juce_audio_devices/juce_audio_devices.h>
+#include <juce_audio_formats/juce_audio_formats.h>
 #include <CLI11/CLI11.hpp>
 
+#include <deque>
+#include <fstream>
+#include <mutex>
+
 #include "version.h"
 
 #include "SurgeSynthProcessor.h"
@@ -171,6 +176,285 @@ struct SurgePlayback : juce::MidiInputCallback, juce::AudioIODeviceCallback
     }
 };
 
+/*
+ * Offline rendering. Each job is a patch, an event source (a standard MIDI file or a plain
+ * text event list) and an output WAV. Jobs go in a queue and a pool of threads each pull a
+ * job, run it on its own SurgeSynthesizer as fast as the CPU allows, and write the result.
+ */
+struct OfflinePluginLayer : SurgeSynthesizer::PluginLayer
+{
+    void surgeParameterUpdated(const SurgeSynthesizer::ID &, float) override {}
+    void surgeMacroUpdated(long, float) override {}
+};
+
+struct RenderJob
+{
+    std::string patch, events, output;
+};
+
+struct RenderEvent
+{
+    int64_t sample;
+    juce::MidiMessage message;
+};
+
+/*
+ * A text event list has one event per line, in seconds:
+ *
+ *     <time> on <channel> <key> <velocity>
+ *     <time> off <channel> <key> <velocity>
+ *     <time> cc <channel> <controller> <value>
+ *     <time> bend <channel> <value, -8192..8191>
+ *
+ * with channels 1-16 and # starting a comment.
+ */
+bool readEventList(const std::string &path, double sampleRate, std::vector<RenderEvent> &events)
+{
+    std::ifstream ifs(path);
+    if (!ifs.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(ifs, line))
+    {
+        auto hash = line.find('#');
+        if (hash != std::string::npos)
+            line = line.substr(0, hash);
+
+        std::istringstream iss(line);
+        double t;
+        std::string type;
+        int ch, a, b{0};
+        if (!(iss >> t >> type >> ch >> a))
+            continue;
+        iss >> b;
+
+        auto sample = (int64_t)std::round(t * sampleRate);
+        if (type == "on")
+            events.push_back({sample, juce::MidiMessage::noteOn(ch, a, (juce::uint8)b)});
+        else if (type == "off")
+            events.push_back({sample, juce::MidiMessage::noteOff(ch, a, (juce::uint8)b)});
+        else if (type == "cc")
+            events.push_back({sample, juce::MidiMessage::controllerEvent(ch, a, b)});
+        else if (type == "bend")
+            events.push_back({sample, juce::MidiMessage::pitchWheel(ch, a + 8192)});
+    }
+    return true;
+}
+
+bool readMidiFile(const std::string &path, double sampleRate, std::vector<RenderEvent> &events)
+{
+    juce::File f(path);
+    juce::FileInputStream fis(f);
+    if (!fis.openedOk())
+        return false;
+
+    juce::MidiFile mf;
+    if (!mf.readFrom(fis))
+        return false;
+
+    mf.convertTimestampTicksToSeconds();
+
+    for (int t = 0; t < mf.getNumTracks(); ++t)
+    {
+        auto track = mf.getTrack(t);
+        for (auto ev : *track)
+        {
+            auto &m = ev->message;
+            if (m.isMetaEvent() || m.isSysEx())
+                continue;
+
+            events.push_back({(int64_t)std::round(m.getTimeStamp() * sampleRate), m});
+        }
+    }
+    return true;
+}
+
+void applyRenderMidi(SurgeSynthesizer *surge, const juce::MidiMessage &m)
+{
+    const int ch = m.getChannel() - 1;
+
+    if (m.isNoteOn())
+        surge->playNote(ch, m.getNoteNumber(), m.getVelocity(), 0, -1);
+    else if (m.isNoteOff())
+        surge->releaseNote(ch, m.getNoteNumber(), m.getVelocity());
+    else if (m.isChannelPressure())
+        surge->channelAftertouch(ch, m.getChannelPressureValue());
+    else if (m.isAftertouch())
+        surge->polyAftertouch(ch, m.getNoteNumber(), m.getAfterTouchValue());
+    else if (m.isPitchWheel())
+        surge->pitchBend(ch, m.getPitchWheelValue() - 8192);
+    else if (m.isController())
+        surge->channelController(ch, m.getControllerNumber(), m.getControllerValue());
+    else if (m.isProgramChange())
+        surge->programChange(ch, m.getProgramChangeNumber());
+}
+
+// construction touches the user data area on disk, so we make synths one at a time
+std::mutex synthConstructionMutex;
+
+bool renderOneJob(const RenderJob &job, int sampleRate, float tailSeconds)
+{
+    std::vector<RenderEvent> events;
+    auto ext = juce::File(job.events).getFileExtension().toLowerCase();
+    bool isMidiFile = (ext == ".mid" || ext == ".midi");
+    bool readOK = isMidiFile ? readMidiFile(job.events, sampleRate, events)
+                             : readEventList(job.events, sampleRate, events);
+    if (!readOK)
+    {
+        PRINTERR("Unable to read events from " << job.events);
+        return false;
+    }
+    std::stable_sort(events.begin(), events.end(),
+                     [](const auto &a, const auto &b) { return a.sample < b.sample; });
+
+    OfflinePluginLayer layer;
+    std::unique_ptr<SurgeSynthesizer> surge;
+    {
+        std::lock_guard<std::mutex> g(synthConstructionMutex);
+        surge = std::make_unique<SurgeSynthesizer>(&layer);
+    }
+    surge->setSamplerate(sampleRate);
+    surge->time_data.tempo = 120;
+    surge->time_data.ppqPos = 0;
+
+    if (!job.patch.empty() && !surge->loadPatchByPath(job.patch.c_str(), -1, "Render"))
+    {
+        PRINTERR("Unable to load patch " << job.patch);
+        return false;
+    }
+
+    juce::File outFile(job.output);
+    outFile.deleteFile();
+    auto fos = outFile.createOutputStream();
+    if (!fos)
+    {
+        PRINTERR("Unable to open " << job.output << " for writing");
+        return false;
+    }
+
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer(
+        wav.createWriterFor(fos.get(), sampleRate, 2, 24, {}, 0));
+    if (!writer)
+    {
+        PRINTERR("Unable to create a WAV writer for " << job.output);
+        return false;
+    }
+    fos.release(); // the writer owns the stream now
+
+    int64_t lastEvent = events.empty() ? 0 : events.back().sample;
+    int64_t totalSamples = lastEvent + (int64_t)(tailSeconds * sampleRate);
+    int64_t totalBlocks = (totalSamples + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // let the patch settle before the first event, like a host would
+    for (int i = 0; i < 4; ++i)
+        surge->process();
+
+    size_t nextEvent = 0;
+    const float *outputs[2] = {surge->output[0], surge->output[1]};
+    for (int64_t b = 0; b < totalBlocks; ++b)
+    {
+        auto blockEnd = (b + 1) * BLOCK_SIZE;
+        while (nextEvent < events.size() && events[nextEvent].sample < blockEnd)
+        {
+            surge->setBlockEventOffset((int)(events[nextEvent].sample - b * BLOCK_SIZE));
+            applyRenderMidi(surge.get(), events[nextEvent].message);
+            nextEvent++;
+        }
+
+        surge->process();
+        surge->time_data.ppqPos +=
+            (double)BLOCK_SIZE * surge->time_data.tempo / (60. * surge->storage.samplerate);
+
+        writer->writeFromFloatArrays(outputs, 2, BLOCK_SIZE);
+    }
+    writer.reset();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto wallSeconds = std::chrono::duration<double>(end - start).count();
+    auto audioSeconds = (double)(totalBlocks * BLOCK_SIZE) / sampleRate;
+
+    LOG(BASIC, "Rendered " << job.output << " : " << std::fixed << std::setprecision(2)
+                           << audioSeconds << "s of audio in " << wallSeconds << "s ("
+                           << audioSeconds / std::max(wallSeconds, 1e-6) << "x realtime)");
+    return true;
+}
+
+/*
+ * A render list has one job per line: patch, event file and output WAV separated by tabs.
+ * An empty patch field renders with the init patch.
+ */
+bool readRenderList(const std::string &path, std::deque<RenderJob> &jobs)
+{
+    std::ifstream ifs(path);
+    if (!ifs.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(ifs, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        auto t1 = line.find('\t');
+        auto t2 = (t1 == std::string::npos) ? t1 : line.find('\t', t1 + 1);
+        if (t2 == std::string::npos)
+        {
+            PRINTERR("Render list lines need three tab separated fields: " << line);
+            return false;
+        }
+        jobs.push_back({line.substr(0, t1), line.substr(t1 + 1, t2 - t1 - 1), line.substr(t2 + 1)});
+    }
+    return true;
+}
+
+int renderOffline(std::deque<RenderJob> jobs, int sampleRate, int threads, float tailSeconds)
+{
+    std::mutex queueMutex;
+    std::atomic<int> failures{0};
+    auto nJobs = jobs.size();
+
+    threads = std::max(1, std::min(threads, (int)nJobs));
+    LOG(BASIC, "Rendering " << nJobs << " job(s) at " << sampleRate << "Hz on " << threads
+                            << " thread(s)");
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i)
+    {
+        workers.emplace_back([&]() {
+            while (true)
+            {
+                RenderJob job;
+                {
+                    std::lock_guard<std::mutex> g(queueMutex);
+                    if (jobs.empty())
+                        return;
+                    job = jobs.front();
+                    jobs.pop_front();
+                }
+
+                if (!renderOneJob(job, sampleRate, tailSeconds))
+                    failures++;
+            }
+        });
+    }
+
+    for (auto &w : workers)
+        w.join();
+
+    auto wallSeconds =
+        std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    LOG(BASIC, "Finished " << nJobs - failures << " of " << nJobs << " job(s) in " << std::fixed
+                           << std::setprecision(2) << wallSeconds << "s");
+
+    return failures > 0 ? 6 : 0;
+}
+
 void isQuitPressed()
 {
     std::string res;
@@ -228,8 +512,51 @@ int main(int argc, char **argv)
     std::string initPatch{};
     app.add_flag("--init-patch", initPatch, "Choose this file (by path) as the initial patch");
 
+    std::string renderEvents{};
+    app.add_flag("--render-events", renderEvents,
+                 "Render offline: play this MIDI file or text event list through the "
+                 "--init-patch into --render-out, rather than using audio and MIDI devices");
+
+    std::string renderOut{};
+    app.add_flag("--render-out", renderOut, "The WAV file written by --render-events");
+
+    std::string renderList{};
+    app.add_flag("--render-list", renderList,
+                 "Render offline every job in this file. One job per line: patch, event file "
+                 "and output WAV, tab separated");
+
+    int renderThreads{(int)std::thread::hardware_concurrency()};
+    app.add_flag("--render-threads", renderThreads,
+                 "Number of jobs to render concurrently. Defaults to the number of cores");
+
+    float renderTail{2.f};
+    app.add_flag("--render-tail", renderTail,
+                 "Seconds to keep rendering after the last event. Defaults to 2");
+
     CLI11_PARSE(app, argc, argv);
 
+    if (!renderEvents.empty() || !renderList.empty())
+    {
+        std::deque<RenderJob> jobs;
+        if (!renderEvents.empty())
+        {
+            if (renderOut.empty())
+            {
+                PRINTERR("--render-events needs a --render-out file");
+                exit(3);
+            }
+            jobs.push_back({initPatch, renderEvents, renderOut});
+        }
+        if (!renderList.empty() && !readRenderList(renderList, jobs))
+        {
+            PRINTERR("Unable to read render list " << renderList);
+            exit(3);
+        }
+
+        return renderOffline(jobs, sampleRate > 0 ? sampleRate : 48000, renderThreads,
+                             renderTail);
+    }
+
     if (listDevices)
     {
         listAudioDevices();
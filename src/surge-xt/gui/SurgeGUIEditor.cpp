@@ -467,6 +467,9 @@ SurgeGUIEditor::~SurgeGUIEditor()
     populateDawExtraState(synth); // If I must die, leave my state for future generations
     synth->storage.getPatch().dawExtraState.isPopulated = isPop;
     synth->storage.removeErrorListener(this);
+
+    if (processProfilerClient)
+        synth->storage.processProfiler.removeClient();
 }
 
 void SurgeGUIEditor::forceLFODisplayRebuild() { lfoDisplay->repaint(); }
@@ -901,6 +904,46 @@ void SurgeGUIEditor::idle()
                 vuInvalid = true;
             }
 
+            bool showCPU = Surge::Storage::getUserDefaultValue(
+                &(synth->storage), Surge::Storage::ShowCPUUsage, false);
+
+            if (showCPU != processProfilerClient)
+            {
+                if (showCPU)
+                    synth->storage.processProfiler.addClient();
+                else
+                    synth->storage.processProfiler.removeClient();
+
+                processProfilerClient = showCPU;
+                processProfileCheckEvery = 0;
+            }
+
+            if (showCPU && ++processProfileCheckEvery >= 10)
+            {
+                namespace prof = Surge::Profiling;
+
+                processProfileCheckEvery = 0;
+                auto avg = synth->storage.processProfiler.average(64);
+
+                // the voice stages contain the oscillators, so leave them and the total out
+                int hottest = -1;
+                for (int s = 0; s < prof::n_process_stages; ++s)
+                {
+                    if (s == prof::pst_total ||
+                        (s >= prof::pst_voices_first && s < prof::pst_osc_first))
+                        continue;
+                    if (avg.usec[s] > 0.f && (hottest < 0 || avg.usec[s] > avg.usec[hottest]))
+                        hottest = s;
+                }
+
+                std::string hot = hottest >= 0 ? prof::processStageName(hottest) : "";
+                if (hot != vu[0]->getHottestStage())
+                {
+                    vu[0]->setHottestStage(hot);
+                    vuInvalid = true;
+                }
+            }
+
             if (vuInvalid)
             {
                 vu[0]->repaint();
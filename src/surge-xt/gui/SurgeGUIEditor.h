@@ -571,6 +571,10 @@ class SurgeGUIEditor : public Surge::GUI::IComponentTagValue::Listener,
     int processRunningCheckEvery{0};
     std::unique_ptr<juce::Component> noProcessingOverlay{nullptr};
 
+    // while the CPU meter is shown we also profile process() to name its most expensive stage
+    bool processProfilerClient{false};
+    int processProfileCheckEvery{0};
+
   public:
     std::shared_ptr<SurgeImageStore> bitmapStore = nullptr;
     // made public so that EffectChooser can get to it!
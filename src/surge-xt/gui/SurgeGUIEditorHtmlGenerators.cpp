@@ -892,6 +892,37 @@ code {
                         </tr>
                     </table>
                 </div>
+                <div class="tablewrap cr cl" style="margin: 0 auto;">
+                    <div class="heading"><h3>Process Profiling:</h3></div>
+                    <table style="border: 2px solid black;">
+                        <tr>
+                            <th>Address</th>
+                            <th>Description</th>
+                            <th>Appropriate Values</th>
+                        </tr>
+                        <tr>
+                            <td>/profile/on</td>
+                            <td>start recording per-stage timings of each audio block</td>
+                            <td>none</td>
+                        </tr>
+                        <tr>
+                            <td>/profile/off</td>
+                            <td>stop recording timings</td>
+                            <td>none</td>
+                        </tr>
+                        <tr>
+                            <td>/profile</td>
+                            <td>request the mean timings of the last N blocks</td>
+                            <td>optional N (1 - 1024), default 64</td>
+                        </tr>
+                        <tr>
+                            <td class="center" colspan="3">Replies with one /profile/&ltstage&gt message per stage
+                                (for instance /profile/scene_a_osc_1 or /profile/fx_4), in microseconds,
+                                then /profile/fx_&ltn&gt/asleep for each FX slot, the fraction of those blocks
+                                it was empty, disabled or asleep.</td>
+                        </tr>
+                    </table>
+                </div>
 
                 <div style="margin:10pt; padding: 5pt 12pt; background: #fafbff;">
                     <div style="font-size: 12pt; font-family: Lato;">
@@ -2322,6 +2322,39 @@ int32_t SurgeGUIEditor::controlModifierClicked(Surge::GUI::IComponentTagValue *c
 
                         break;
                     }
+                    case ct_vocoder_bandcount:
+                    {
+                        contextMenu.addSeparator();
+
+                        Surge::Widgets::MenuCenteredBoldLabel::addToMenuAsSectionHeader(contextMenu,
+                                                                                        "ENGINE");
+
+                        std::vector<std::string> vocoderEngines = {"Filter Bank (4 to 20 Bands)",
+                                                                   "FFT (64 to 256 Bands)"};
+
+                        for (int i = 0; i < vocoderEngines.size(); ++i)
+                        {
+                            bool isChecked = p->deform_type == i;
+
+                            contextMenu.addItem(Surge::GUI::toOSCase(vocoderEngines[i]), true,
+                                                isChecked, [this, isChecked, p, i]() {
+                                                    if (p->deform_type != i)
+                                                        undoManager()->pushParameterChange(p->id, p,
+                                                                                           p->val);
+
+                                                    p->deform_type = i;
+                                                    if (!isChecked)
+                                                    {
+                                                        synth->storage.getPatch().isDirty = true;
+                                                        synth->refresh_editor = true;
+                                                    }
+                                                });
+                        }
+
+                        contextMenu.addSeparator();
+
+                        break;
+                    }
                     case ct_percent_with_string_deform_hook:
                     case ct_percent_bipolar_with_string_filter_hook:
                     {
@@ -179,8 +179,19 @@ void VuMeter::paint(juce::Graphics &g)
             std::string text = std::to_string((int)(std::min(cpuLevel, 1.f) * 100.f));
             auto bounds = getLocalBounds().withTrimmedRight(3);
 
-            g.setFont(skin->fontManager->getLatoAtSize(9));
-            g.drawText(text, bounds, juce::Justification::right);
+            auto font = skin->fontManager->getLatoAtSize(9);
+            g.setFont(font);
+
+            // the CPU level gets a fixed slot wide enough for "100", so the stage name beside
+            // it neither overlaps it nor shifts as the level changes
+            auto cpuArea = bounds.removeFromRight(font.getStringWidth("100"));
+            g.drawText(text, cpuArea, juce::Justification::right);
+
+            if (!hottestStage.empty())
+            {
+                g.drawText(hottestStage, bounds.withTrimmedRight(4), juce::Justification::right,
+                           true);
+            }
         }
     }
 }
@@ -51,6 +51,11 @@ struct VuMeter : public juce::Component,
     void setCpuLevel(float f) { cpuLevel = f; }
     float getCpuLevel() const { return cpuLevel; }
 
+    // the most expensive stage of process() lately, drawn beside the CPU level
+    std::string hottestStage;
+    void setHottestStage(const std::string &s) { hottestStage = s; }
+    const std::string &getHottestStage() const { return hottestStage; }
+
     SurgeStorage *storage{nullptr};
     void setStorage(SurgeStorage *s) { storage = s; }
 
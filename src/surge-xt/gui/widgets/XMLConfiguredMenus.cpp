@@ -823,6 +823,16 @@ void FxMenu::populateForContext(bool isCalledInEffectChooser)
         menu.addItem(Surge::GUI::toOSCase("Save FX Preset As..."), [this]() { this->saveFX(); });
     }
 
+    if (sge && fx->type.val.i == fxt_convolution)
+    {
+        menu.addSeparator();
+
+        menu.addItem(Surge::GUI::toOSCase("Load Impulse Response..."),
+                     [this]() { this->loadImpulseResponse(); });
+        menu.addItem(Surge::GUI::toOSCase("Clear Impulse Response"), !fx->file_path.empty(),
+                     false, [sge]() { sge->synth->setFxFilePath(sge->current_fx, ""); });
+    }
+
     menu.addSeparator();
 
     menu.addItem(Surge::GUI::toOSCase("Copy FX Preset"), [this]() { this->copyFX(); });
@@ -907,6 +917,33 @@ void FxMenu::saveFX()
     }
 }
 
+void FxMenu::loadImpulseResponse()
+{
+    auto *sge = firstListenerOfType<SurgeGUIEditor>();
+    if (!sge)
+        return;
+
+    auto dir = storage->userDataPath;
+    if (!fx->file_path.empty())
+        dir = string_to_path(fx->file_path).parent_path();
+
+    sge->fileChooser = std::make_unique<juce::FileChooser>(
+        "Select Impulse Response to Load", juce::File(path_to_string(dir)), "*.wav");
+    sge->fileChooser->launchAsync(
+        juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+        [sge](const juce::FileChooser &c) {
+            auto ress = c.getResults();
+
+            if (ress.size() != 1)
+            {
+                return;
+            }
+
+            sge->synth->setFxFilePath(sge->current_fx,
+                                      c.getResult().getFullPathName().toStdString());
+        });
+}
+
 void FxMenu::loadUserPreset(const Surge::Storage::FxUserPreset::Preset &p)
 {
     auto sge = firstListenerOfType<SurgeGUIEditor>();
@@ -238,6 +238,7 @@ struct FxMenu : public juce::Component, public XMLMenuPopulator, public WidgetBa
     void copyFX();
     void pasteFX();
     void saveFX();
+    void loadImpulseResponse();
 
     void loadByIndex(const std::string &name, int index) override;
     void loadUserPreset(const Surge::Storage::FxUserPreset::Preset &p);
@@ -23,6 +23,7 @@
 #include "OpenSoundControl.h"
 #include "Parameter.h"
 #include "SurgeSynthProcessor.h"
+#include <algorithm>
 #include <sstream>
 #include <vector>
 #include <string>
@@ -40,6 +41,9 @@ OpenSoundControl::~OpenSoundControl()
 {
     if (listening)
         stopListening();
+
+    if (profiling && synth)
+        synth->storage.processProfiler.removeClient();
 }
 
 void OpenSoundControl::initOSC(SurgeSynthProcessor *ssp,
@@ -558,6 +562,50 @@ void OpenSoundControl::oscMessageReceived(const juce::OSCMessage &message)
     {
         OpenSoundControl::sendAllParams();
     }
+
+    // Per-stage process() timings
+    else if (address1 == "profile")
+    {
+        auto &profiler = synth->storage.processProfiler;
+
+        if (address2 == "on")
+        {
+            if (!profiling)
+                profiler.addClient();
+            profiling = true;
+        }
+        else if (address2 == "off")
+        {
+            if (profiling)
+                profiler.removeClient();
+            profiling = false;
+        }
+        else if (address2.empty())
+        {
+            int nBlocks = 64;
+            if (message.size() > 0)
+            {
+                if (!message[0].isFloat32())
+                {
+                    sendNotFloatError("profile", "block count");
+                    return;
+                }
+                nBlocks = std::clamp((int)message[0].getFloat32(), 1,
+                                     (int)Surge::Profiling::ProcessProfiler::ringSize);
+            }
+
+            if (!profiling)
+            {
+                sendError("OSC /profile: send /profile/on first to start recording timings.");
+                return;
+            }
+            sendProcessProfile(nBlocks);
+        }
+        else
+        {
+            sendError("Unknown OSC /profile command: " + address2);
+        }
+    }
 }
 
 void OpenSoundControl::oscBundleReceived(const juce::OSCBundle &bundle)
@@ -670,6 +718,34 @@ void OpenSoundControl::sendDataCountError(std::string addr, std::string count)
                                 count + ".");
 }
 
+// Average the last nBlocks of the profiler's history and send one message per stage
+void OpenSoundControl::sendProcessProfile(int nBlocks)
+{
+    if (!sendingOSC)
+        return;
+
+    auto prof = synth->storage.processProfiler.average(nBlocks);
+    if (prof.block == 0)
+    {
+        sendError("OSC /profile: no blocks have been profiled yet.");
+        return;
+    }
+
+    for (int s = 0; s < Surge::Profiling::n_process_stages; ++s)
+    {
+        send(std::string("/profile/") + Surge::Profiling::processStageName(s),
+             std::to_string(prof.usec[s]));
+    }
+
+    // the fraction of those blocks each fx slot spent not running, empty or asleep
+    for (int f = 0; f < n_fx_slots; ++f)
+    {
+        send(std::string("/profile/") +
+                 Surge::Profiling::processStageName(Surge::Profiling::fxStage(f)) + "/asleep",
+             std::to_string(prof.fxAsleep[f]));
+    }
+}
+
 // Loop through all params, send them to OSC Out
 void OpenSoundControl::sendAllParams()
 {